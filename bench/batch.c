@@ -0,0 +1,57 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "urc/urc.h"
+
+#include "bench.h"
+#include "parallel.h"
+
+#define BUFLEN 4096
+#define BATCH_SIZE 1024
+
+typedef struct {
+    urc_batch_item items[BATCH_SIZE];
+    crypto_account accounts[BATCH_SIZE];
+    size_t threads;
+} batch_ctx;
+
+static void batch_deserialize(void *ctx)
+{
+    batch_ctx *batch = ctx;
+    if (urc_batch_deserialize(batch->items, BATCH_SIZE, batch->threads) != URC_OK) {
+        abort();
+    }
+    for (size_t idx = 0; idx < BATCH_SIZE; idx++) {
+        if (batch->items[idx].result != URC_OK) {
+            abort();
+        }
+    }
+}
+
+void bench_batch(void)
+{
+    static uint8_t buffer[BUFLEN];
+    static batch_ctx batch;
+
+    size_t len = bench_build_account(buffer, BUFLEN, 6);
+    for (size_t idx = 0; idx < BATCH_SIZE; idx++) {
+        batch.items[idx].type = urc_batch_type_crypto_account;
+        batch.items[idx].cbor_buffer = buffer;
+        batch.items[idx].cbor_len = len;
+        batch.items[idx].out = &batch.accounts[idx];
+    }
+
+    // throughput from 1 to N cores, speedup relative to a single thread
+    const size_t cpus = urc_parallel_default_threads();
+    double single_thread_ns = 0;
+    for (size_t threads = 1; threads <= cpus; threads = threads * 2 > cpus && threads < cpus ? cpus : threads * 2) {
+        char name[64];
+        snprintf(name, sizeof(name), "batch_deserialize/account/threads:%zu", threads);
+        batch.threads = threads;
+        double ns_per_op = bench_run(name, batch_deserialize, &batch, BATCH_SIZE);
+        if (threads == 1) {
+            single_thread_ns = ns_per_op;
+        }
+        printf("%-48s %12.0f items/s %9.2fx\n", "", BATCH_SIZE * 1e9 / ns_per_op, single_thread_ns / ns_per_op);
+    }
+}
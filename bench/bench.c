@@ -0,0 +1,107 @@
+#include <stdatomic.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "urc/allocator.h"
+
+#include "bench.h"
+
+static FILE *json;
+static size_t json_entries;
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// forwards to the allocator it replaces, counting what goes through it
+// urc_parallel_for workers inherit the caller's allocator, the counters are shared by every thread
+typedef struct {
+    const urc_allocator *inner;
+    _Atomic uint64_t allocs;
+    _Atomic uint64_t bytes;
+} counting_ctx;
+
+static void *counting_malloc(void *ctx, size_t size)
+{
+    counting_ctx *counting = ctx;
+    atomic_fetch_add_explicit(&counting->allocs, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&counting->bytes, size, memory_order_relaxed);
+    return counting->inner->malloc(counting->inner->ctx, size);
+}
+
+static void counting_free(void *ctx, void *ptr)
+{
+    counting_ctx *counting = ctx;
+    counting->inner->free(counting->inner->ctx, ptr);
+}
+
+int bench_json_open(const char *path)
+{
+    json = fopen(path, "w");
+    if (!json) {
+        return -1;
+    }
+    json_entries = 0;
+    fprintf(json, "{\n  \"version\": \"%s\",\n  \"benchmarks\": [", URC_BENCH_VERSION);
+    return 0;
+}
+
+int bench_json_close(void)
+{
+    if (!json) {
+        return 0;
+    }
+    fprintf(json, "\n  ]\n}\n");
+    int result = fclose(json);
+    json = NULL;
+    return result == 0 ? 0 : -1;
+}
+
+double bench_run(const char *name, bench_fn fn, void *ctx, size_t units)
+{
+    // warm up caches and branch predictors
+    fn(ctx);
+
+    // a single call, so that counting doesn't weigh on the timings
+    counting_ctx counting = {.inner = urc_get_thread_allocator()};
+    const urc_allocator allocator = {.malloc = counting_malloc, .free = counting_free, .ctx = &counting};
+    const urc_allocator *previous = urc_set_thread_allocator(&allocator);
+    fn(ctx);
+    urc_set_thread_allocator(previous);
+    // the workers are joined by now
+    const uint64_t allocs = atomic_load_explicit(&counting.allocs, memory_order_relaxed);
+    const uint64_t bytes = atomic_load_explicit(&counting.bytes, memory_order_relaxed);
+
+    uint64_t iterations = 0;
+    uint64_t batch = 1;
+    uint64_t start = now_ns();
+    uint64_t elapsed = 0;
+    while (elapsed < BENCH_MIN_TIME_NS) {
+        for (uint64_t idx = 0; idx < batch; idx++) {
+            fn(ctx);
+        }
+        iterations += batch;
+        batch *= 2;
+        elapsed = now_ns() - start;
+    }
+    double ns_per_op = (double)elapsed / (double)iterations;
+    printf("%-48s %12.1f ns/op %6llu allocs/op %9llu B/op", name, ns_per_op, (unsigned long long)allocs,
+           (unsigned long long)bytes);
+    if (units > 1) {
+        printf(" %12.1f ns/item", ns_per_op / (double)units);
+    }
+    printf("\n");
+
+    if (json) {
+        fprintf(json,
+                "%s\n    {\"name\": \"%s\", \"ns_per_op\": %.1f, \"allocs_per_op\": %llu, \"bytes_per_op\": %llu, "
+                "\"units\": %zu, \"ns_per_unit\": %.3f, \"iterations\": %llu}",
+                json_entries++ ? "," : "", name, ns_per_op, (unsigned long long)allocs,
+                (unsigned long long)bytes, units ? units : 1, ns_per_op / (double)(units ? units : 1),
+                (unsigned long long)iterations);
+    }
+    return ns_per_op;
+}
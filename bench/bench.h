@@ -0,0 +1,34 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// minimum amount of time spent on each benchmark
+#define BENCH_MIN_TIME_NS 500000000ULL
+
+typedef void (*bench_fn)(void *ctx);
+
+// runs ``fn`` until BENCH_MIN_TIME_NS elapsed and reports the average cost of a single call, which is returned in ns
+// ``units`` is the number of items one call processes (e.g. the keys of an account), the cost is reported per item
+// allocations and bytes per call are those made through urc_malloc on the calling thread, counted on a separate call
+double bench_run(const char *name, bench_fn fn, void *ctx, size_t units);
+
+// every bench_run between the two is recorded to ``path`` as well, in JSON, 0 on success
+int bench_json_open(const char *path);
+int bench_json_close(void);
+
+// writes a crypto-account carrying ``count`` (< 256) descriptors to ``buffer``, returns its length
+size_t bench_build_account(uint8_t *buffer, size_t buffer_len, size_t count);
+
+// every file registers its own benchmarks here
+void bench_hdkey(void);
+void bench_batch(void);
+void bench_validation(void);
+void bench_format(void);
+void bench_checksum(void);
+void bench_derive(void);
+void bench_script_index(void);
+void bench_ur(void);
+void bench_crc32(void);
+void bench_codec(void);
+void bench_psbt(void);
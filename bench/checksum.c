@@ -0,0 +1,76 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "urc/urc.h"
+
+#include "bench.h"
+#include "helpers.h"
+
+#define BUFLEN 1024
+
+typedef struct {
+    crypto_output output;
+    urc_crypto_output_format_mode mode;
+    char descriptor[BUFLEN];
+    size_t descriptor_len;
+} checksum_ctx;
+
+static void output_format(void *ctx)
+{
+    checksum_ctx *checksum = ctx;
+    char *out;
+    if (urc_crypto_output_format(&checksum->output, checksum->mode, &out) != URC_OK) {
+        abort();
+    }
+    urc_string_free(out);
+}
+
+static void output_format_to_buffer(void *ctx)
+{
+    checksum_ctx *checksum = ctx;
+    if (urc_crypto_output_format_to_buffer(&checksum->output, checksum->mode, checksum->descriptor, BUFLEN,
+                                           &checksum->descriptor_len) != URC_OK) {
+        abort();
+    }
+}
+
+static void checksum_verify(void *ctx)
+{
+    const checksum_ctx *checksum = ctx;
+    if (urc_descriptor_checksum_verify(checksum->descriptor, checksum->descriptor_len) != URC_OK) {
+        abort();
+    }
+}
+
+void bench_checksum(void)
+{
+    static checksum_ctx checksum;
+
+    // https://github.com/BlockchainCommons/Research/blob/master/papers/bcr-2020-010-output-desc.md#exampletest-vector-4
+    uint8_t raw[BUFLEN];
+    size_t len = h2b("d90193d9012fa503582102d2b36900396c9282fa14628566582f206a5dd0bcc8d5e892611806cafb0301f0045820637807030d55"
+                     "d01f9a0cb3a7839515d796bd07706386a6eddf06cc29a65a0e2906d90130a30186182cf500f500f5021ad34db33f030407d90130"
+                     "a1018401f480f4081a78412e3a",
+                     BUFLEN, raw);
+    if (urc_crypto_output_deserialize(raw, len, &checksum.output) != URC_OK) {
+        abort();
+    }
+
+    // the difference between the two is the cost of the checksum
+    checksum.mode = urc_crypto_output_format_mode_default;
+    bench_run("output_format/hdkey", output_format, &checksum, 1);
+    checksum.mode = urc_crypto_output_format_mode_checksum;
+    bench_run("output_format/hdkey/checksum", output_format, &checksum, 1);
+    // same work without the allocation
+    bench_run("output_format/hdkey/checksum/to_buffer", output_format_to_buffer, &checksum, 1);
+
+    char *out;
+    if (urc_crypto_output_format(&checksum.output, urc_crypto_output_format_mode_checksum, &out) != URC_OK) {
+        abort();
+    }
+    checksum.descriptor_len = strlen(out);
+    memcpy(checksum.descriptor, out, checksum.descriptor_len + 1);
+    urc_string_free(out);
+    // reported per character
+    bench_run("descriptor_checksum_verify", checksum_verify, &checksum, checksum.descriptor_len);
+}
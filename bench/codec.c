@@ -0,0 +1,225 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "urc/urc.h"
+
+#include "bench.h"
+#include "helpers.h"
+
+#define BUFLEN 4096
+
+// the test vectors of the unit tests, one benchmark per deserializer, formatter and serializer not covered elsewhere
+typedef struct {
+    uint8_t buffer[BUFLEN];
+    size_t len;
+    // the decoded value, for the formatters
+    union {
+        crypto_eckey eckey;
+        crypto_hdkey hdkey;
+        crypto_output output;
+        crypto_account account;
+        jade_bip8539_request request;
+    } value;
+} codec_ctx;
+
+static void seed_deserialize(void *ctx)
+{
+    const codec_ctx *codec = ctx;
+    crypto_seed seed;
+    if (urc_crypto_seed_deserialize(codec->buffer, codec->len, &seed) != URC_OK) {
+        abort();
+    }
+}
+
+static void eckey_deserialize(void *ctx)
+{
+    const codec_ctx *codec = ctx;
+    crypto_eckey eckey;
+    if (urc_crypto_eckey_deserialize(codec->buffer, codec->len, &eckey) != URC_OK) {
+        abort();
+    }
+}
+
+static void eckey_format(void *ctx)
+{
+    const codec_ctx *codec = ctx;
+    char *out;
+    if (urc_crypto_eckey_format(&codec->value.eckey, &out) != URC_OK) {
+        abort();
+    }
+    urc_string_free(out);
+}
+
+static void hdkey_format(void *ctx)
+{
+    const codec_ctx *codec = ctx;
+    char *out;
+    if (urc_crypto_hdkey_format(&codec->value.hdkey, &out) != URC_OK) {
+        abort();
+    }
+    urc_string_free(out);
+}
+
+static void output_deserialize(void *ctx)
+{
+    const codec_ctx *codec = ctx;
+    crypto_output output;
+    if (urc_crypto_output_deserialize(codec->buffer, codec->len, &output) != URC_OK) {
+        abort();
+    }
+}
+
+static void account_format(void *ctx)
+{
+    const codec_ctx *codec = ctx;
+    char **descs;
+    if (urc_crypto_account_format(&codec->value.account, urc_crypto_output_format_mode_default, &descs) != URC_OK) {
+        abort();
+    }
+    urc_string_array_free(descs);
+}
+
+static void jade_account_deserialize(void *ctx)
+{
+    const codec_ctx *codec = ctx;
+    crypto_account account;
+    if (urc_jade_account_deserialize(codec->buffer, codec->len, &account) != URC_OK) {
+        abort();
+    }
+}
+
+static void jade_rpc_deserialize(void *ctx)
+{
+    const codec_ctx *codec = ctx;
+    char *out;
+    if (urc_jade_rpc_deserialize(codec->buffer, codec->len, &out) != URC_OK) {
+        abort();
+    }
+    urc_string_free(out);
+}
+
+static void bip8539_response_deserialize(void *ctx)
+{
+    const codec_ctx *codec = ctx;
+    jade_bip8539_response response;
+    if (urc_jade_bip8539_response_deserialize(codec->buffer, codec->len, &response) != URC_OK) {
+        abort();
+    }
+    urc_jade_bip8539_response_free(&response);
+}
+
+static void bip8539_response_deserialize_borrowed(void *ctx)
+{
+    const codec_ctx *codec = ctx;
+    jade_bip8539_response_view response;
+    if (urc_jade_bip8539_response_deserialize_borrowed(codec->buffer, codec->len, &response) != URC_OK) {
+        abort();
+    }
+}
+
+static void bip8539_request_serialize(void *ctx)
+{
+    const codec_ctx *codec = ctx;
+    uint8_t *out;
+    size_t len;
+    if (urc_jade_bip8539_request_serialize(&codec->value.request, &out, &len) != URC_OK) {
+        abort();
+    }
+    urc_free(out);
+}
+
+static void ur_deserialize(void *ctx)
+{
+    const codec_ctx *codec = ctx;
+    uint8_t buffer[BUFLEN];
+    urc_ur_object object;
+    if (urc_ur_deserialize((const char *)codec->buffer, codec->len, buffer, BUFLEN, &object) != URC_OK) {
+        abort();
+    }
+}
+
+static void load(codec_ctx *codec, const char *hex)
+{
+    codec->len = h2b(hex, BUFLEN, codec->buffer);
+    if (codec->len == 0) {
+        abort();
+    }
+}
+
+void bench_codec(void)
+{
+    static codec_ctx codec;
+
+    // https://github.com/BlockchainCommons/Research/blob/master/papers/bcr-2020-006-urtypes.md#exampletest-vector-1
+    load(&codec, "a20150c7098580125e2ab0981253468b2dbc5202d8641947da");
+    bench_run("seed_deserialize", seed_deserialize, &codec, 1);
+
+    load(&codec, "a202f50358208c05c4b4f3e88840a4f4b5f155cfd69473ea169f3d0431b7a6787a23777f08aa");
+    bench_run("eckey_deserialize/private", eckey_deserialize, &codec, 1);
+    load(&codec, "a103582103bec5163df25d8703150c3a1804eac7d615bb212b7cc9d7ff937aa8bd1c494b7f");
+    bench_run("eckey_deserialize/public", eckey_deserialize, &codec, 1);
+    if (urc_crypto_eckey_deserialize(codec.buffer, codec.len, &codec.value.eckey) != URC_OK) {
+        abort();
+    }
+    bench_run("eckey_format/public", eckey_format, &codec, 1);
+
+    // https://github.com/BlockchainCommons/Research/blob/master/papers/bcr-2020-007-hdkey.md#exampletest-vector-1
+    load(&codec, "a301f503582100e8f32e723decf4051aefac8e2c93c9c5b214313817cdb01a1494b917c8436b35045820873dff81c02f525623fd1f"
+                 "e5167eac3a55a049de3d314bb42ee227ffed37d508");
+    if (urc_crypto_hdkey_deserialize(codec.buffer, codec.len, &codec.value.hdkey) != URC_OK) {
+        abort();
+    }
+    bench_run("hdkey_format/master", hdkey_format, &codec, 1);
+    // https://github.com/BlockchainCommons/Research/blob/master/papers/bcr-2020-007-hdkey.md#exampletest-vector-2
+    // an origin of CRYPTO_KEYPATH_MAX_COMPONENTS components, the longest path a key holds
+    load(&codec, "a5035821026fe2355745bb2db3630bbc80ef5d58951c963c841f54170ba6e5c12be7fc12a6045820ced155c72456255881793514ed"
+                 "c5bd9447e7f74abb88c6d6b6480fd016ee8c8505d90131a1020106d90130a1018a182cf501f501f500f401f4081ae9181cf3");
+    if (urc_crypto_hdkey_deserialize(codec.buffer, codec.len, &codec.value.hdkey) != URC_OK) {
+        abort();
+    }
+    bench_run("hdkey_format/derived/max_path", hdkey_format, &codec, 1);
+
+    // https://github.com/BlockchainCommons/Research/blob/master/papers/bcr-2020-010-output-desc.md#exampletest-vector-4
+    load(&codec, "d90193d9012fa503582102d2b36900396c9282fa14628566582f206a5dd0bcc8d5e892611806cafb0301f0045820637807030d55"
+                 "d01f9a0cb3a7839515d796bd07706386a6eddf06cc29a65a0e2906d90130a30186182cf500f500f5021ad34db33f030407d90130"
+                 "a1018401f480f4081a78412e3a");
+    bench_run("output_deserialize/hdkey", output_deserialize, &codec, 1);
+
+    codec.len = bench_build_account(codec.buffer, BUFLEN, DESCRIPTORS_MAX_SIZE);
+    if (urc_crypto_account_deserialize(codec.buffer, codec.len, &codec.value.account) != URC_OK) {
+        abort();
+    }
+    bench_run("account_format/max_descriptors", account_format, &codec, DESCRIPTORS_MAX_SIZE);
+
+    load(&codec, "a2011ae3ebcc790281d90194d9012fa40358210354de5de4043b72d3e7529d57fc4e798bbf371478ada068eb20c84d3e45e14dea"
+                 "0458200977e5bab6742423edc8a588c061ce96a1bdf6dc15016db3f3b7bb62c180c6f706d90130a301861854f500f501f5021ae3"
+                 "ebcc790303081a810d05a0");
+    bench_run("jade_account_deserialize", jade_account_deserialize, &codec, 1);
+
+    load(&codec, "a36269646130666d6574686f646370696e66706172616d73a164646174617880377948355850466434675050425472596d5a757566"
+                 "59513961436770716355656c432b796437495845354d456239695171616b78744e7a7a6265382f51385669566f4e657053714c33"
+                 "55494565416a655734483052334d7032594d4c416b3942664b3961326a64495a4f2f774b464f3576704d6b464949724552452f57"
+                 "51382b");
+    bench_run("jade_rpc_deserialize/pin", jade_rpc_deserialize, &codec, 1);
+
+    load(&codec, "a2667075626b65795821037aa2120135ae201c0586ad9f450ad3f4641ddabcd9bd3e692944d9d8fd8ed8d269656e637279707465"
+                 "6444deadbeef");
+    bench_run("bip8539_response_deserialize", bip8539_response_deserialize, &codec, 1);
+    bench_run("bip8539_response_deserialize/borrowed", bip8539_response_deserialize_borrowed, &codec, 1);
+
+    codec.value.request.num_words = 24;
+    codec.value.request.index = 1024;
+    if (h2b("037aa2120135ae201c0586ad9f450ad3f4641ddabcd9bd3e692944d9d8fd8ed8d2", CRYPTO_ECKEY_PUBLIC_COMPRESSED_SIZE,
+            codec.value.request.pubkey) != CRYPTO_ECKEY_PUBLIC_COMPRESSED_SIZE) {
+        abort();
+    }
+    bench_run("bip8539_request_serialize", bip8539_request_serialize, &codec, 1);
+
+    const char *output_ur =
+        "ur:crypto-output/taadmutaaddlonaxhdclaotdqdinaeesjzmolfzsbbidlpiyhddlcximhltirfsptlvsmohscsamsgzoaxadwtaahdcxiaksat"
+        "axbtgotictnybnqdoslsmdbztsmtryatjoialnolweuramsfdtolhtbadtamtaaddyotadlncsdwykaeykaeykaocytegtqdfhaxaaattaaddyoyadl"
+        "radwklawkaycyksfpdmftkiiozsfd";
+    codec.len = strlen(output_ur);
+    memcpy(codec.buffer, output_ur, codec.len);
+    bench_run("ur_deserialize/output", ur_deserialize, &codec, 1);
+}
@@ -0,0 +1,47 @@
+#include <stdlib.h>
+
+#include "urc/urc.h"
+
+#include "bench.h"
+#include "crc32.h"
+
+// the cbor of a multi-megabyte psbt, reported per byte
+#define DATA_LEN (4 * 1024 * 1024)
+
+typedef struct {
+    crc32_kernel kernel;
+    uint8_t *data;
+} crc32_ctx;
+
+static void crc32_run(void *ctx)
+{
+    const crc32_ctx *crc = ctx;
+    // keeps the call from being optimized out
+    if (crc->kernel(0, crc->data, DATA_LEN) == 0) {
+        abort();
+    }
+}
+
+void bench_crc32(void)
+{
+    crc32_ctx ctx = {.data = malloc(DATA_LEN)};
+    if (!ctx.data) {
+        abort();
+    }
+    srand(1);
+    for (size_t idx = 0; idx < DATA_LEN; idx++) {
+        ctx.data[idx] = (uint8_t)rand();
+    }
+
+    ctx.kernel = crc32_update_bytewise;
+    bench_run("crc32_bytewise", crc32_run, &ctx, DATA_LEN);
+    ctx.kernel = crc32_update_slice8;
+    bench_run("crc32_slice8", crc32_run, &ctx, DATA_LEN);
+    ctx.kernel = crc32_hardware_kernel();
+    if (ctx.kernel) {
+        bench_run("crc32_hardware", crc32_run, &ctx, DATA_LEN);
+    }
+    ctx.kernel = urc_crc32_update;
+    bench_run("crc32_update", crc32_run, &ctx, DATA_LEN);
+    free(ctx.data);
+}
@@ -0,0 +1,52 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "urc/urc.h"
+
+#include "bench.h"
+#include "parallel.h"
+
+#define BUFLEN 4096
+// a gap limit scan over both chains of a busy wallet
+#define SCAN_SIZE 2000
+
+typedef struct {
+    urc_script_deriver deriver;
+    urc_scriptpubkey scripts[SCAN_SIZE];
+    size_t threads;
+} derive_ctx;
+
+static void derive_range(void *ctx)
+{
+    derive_ctx *derive = ctx;
+    if (urc_script_deriver_derive(&derive->deriver, 0, 0, SCAN_SIZE, derive->threads, derive->scripts) != URC_OK) {
+        abort();
+    }
+}
+
+void bench_derive(void)
+{
+    static uint8_t buffer[BUFLEN];
+    static derive_ctx derive;
+
+    // the third descriptor of the account test vector is wpkh
+    size_t len = bench_build_account(buffer, BUFLEN, 3);
+    crypto_account account;
+    if (urc_crypto_account_deserialize(buffer, len, &account) != URC_OK ||
+        urc_script_deriver_init(&derive.deriver, &account.descriptors[2]) != URC_OK) {
+        abort();
+    }
+
+    const size_t cpus = urc_parallel_default_threads();
+    double single_thread_ns = 0;
+    for (size_t threads = 1; threads <= cpus; threads = threads * 2 > cpus && threads < cpus ? cpus : threads * 2) {
+        char name[64];
+        snprintf(name, sizeof(name), "script_derive/p2wpkh:%d/threads:%zu", SCAN_SIZE, threads);
+        derive.threads = threads;
+        double ns_per_op = bench_run(name, derive_range, &derive, SCAN_SIZE);
+        if (threads == 1) {
+            single_thread_ns = ns_per_op;
+        }
+        printf("%-48s %12.0f scripts/s %9.2fx\n", "", SCAN_SIZE * 1e9 / ns_per_op, single_thread_ns / ns_per_op);
+    }
+}
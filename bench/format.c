@@ -0,0 +1,66 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "urc/urc.h"
+
+#include "bench.h"
+#include "parallel.h"
+
+#define BUFLEN 16384
+#define ACCOUNT_DESCRIPTORS 48
+
+typedef struct {
+    crypto_account_unbounded account;
+    size_t threads;
+} format_ctx;
+
+static void account_format(void *ctx)
+{
+    format_ctx *format = ctx;
+    char **descs;
+    int result = format->threads == 1 ? urc_crypto_account_unbounded_format(
+                                            &format->account, urc_crypto_output_format_mode_default, &descs)
+                                      : urc_crypto_account_unbounded_format_parallel(
+                                            &format->account, urc_crypto_output_format_mode_default, format->threads, &descs);
+    if (result != URC_OK) {
+        abort();
+    }
+    urc_string_array_free(descs);
+}
+
+void bench_format(void)
+{
+    static uint8_t buffer[BUFLEN];
+    static format_ctx format;
+
+    size_t len = bench_build_account(buffer, BUFLEN, ACCOUNT_DESCRIPTORS);
+    if (urc_crypto_account_unbounded_deserialize(buffer, len, &format.account) != URC_OK) {
+        abort();
+    }
+
+    // threads:1 is the sequential formatter, speedup relative to it
+    const size_t cpus = urc_parallel_default_threads();
+    double sequential_ns = 0;
+    for (size_t threads = 1; threads <= cpus; threads = threads * 2 > cpus && threads < cpus ? cpus : threads * 2) {
+        char name[64];
+        snprintf(name, sizeof(name), "account_format/descriptors:%d/threads:%zu", ACCOUNT_DESCRIPTORS, threads);
+        format.threads = threads;
+        double ns_per_op = bench_run(name, account_format, &format, ACCOUNT_DESCRIPTORS);
+        if (threads == 1) {
+            sequential_ns = ns_per_op;
+        }
+        printf("%-48s %12.0f descriptors/s %9.2fx\n", "", ACCOUNT_DESCRIPTORS * 1e9 / ns_per_op, sequential_ns / ns_per_op);
+    }
+
+    // every key is found in the cache after the first call
+    if (urc_hdkey_cache_enable(ACCOUNT_DESCRIPTORS) != URC_OK) {
+        abort();
+    }
+    format.threads = 1;
+    char name[64];
+    snprintf(name, sizeof(name), "account_format/descriptors:%d/cached", ACCOUNT_DESCRIPTORS);
+    bench_run(name, account_format, &format, ACCOUNT_DESCRIPTORS);
+    urc_hdkey_cache_disable();
+
+    urc_crypto_account_unbounded_free(&format.account);
+}
@@ -0,0 +1,90 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "urc/urc.h"
+
+#include "bench.h"
+#include "helpers.h"
+
+#define BUFLEN 4096
+
+// non taproot descriptors taken from the crypto-account test vector
+// https://github.com/BlockchainCommons/Research/blob/master/papers/bcr-2020-015-account.md#exampletest-vector
+static const char *descriptors_hex[] = {
+    "d90134d90193d9012fa403582103eb3e2863911826374de86c231a4b76f0b89dfa174afb78d7f478199884d9dd320458206456a5df2db0f6d9af"
+    "72b2a1af4b25f45200ed6fcc29c3440b311d4796b70b5b06d90130a20186182cf500f500f5021a37b5eed4081a99f9cdf7",
+    "d90134d90190d90194d9012fa403582102c7e4823730f6ee2cf864e2c352060a88e60b51a84e89e4c8c75ec22590ad6b690458209d2f86043276"
+    "f9251a4a4f577166a5abeb16b6ec61e226b5b8fa11038bfda42d06d90130a201861831f500f500f5021a37b5eed4081aa80f7cdb",
+    "d90134d90194d9012fa403582103fd433450b6924b4f7efdd5d1ed017d364be95ab2b592dc8bddb3b00c1c24f63f04582072ede7334d5acf91c6"
+    "fda622c205199c595a31f9218ed30792d301d5ee9e3a8806d90130a201861854f500f500f5021a37b5eed4081a0d5de1d7",
+    "d90134d90190d9019ad9012fa4035821035ccd58b63a2cdc23d0812710603592e7457573211880cb59b1ef012e168e059a04582088d3299b448f"
+    "87215d96b0c226235afc027f9e7dc700284f3e912a34daeb1a2306d90130a20182182df5021a37b5eed4081a37b5eed4",
+    "d90134d90190d90191d9019ad9012fa4035821032c78ebfcabdac6d735a0820ef8732f2821b4fb84cd5d6b26526938f90c0507110458207953ef"
+    "e16a73e5d3f9f2d4c6e49bd88e22093bbd85be5a7e862a4b98a16e0ab606d90130a201881830f500f500f501f5021a37b5eed4081a59b69b2a",
+    "d90134d90191d9019ad9012fa40358210260563ee80c26844621b06b74070baf0e23fb76ce439d0237e87502ebbd3ca3460458202fa0e41c9dc4"
+    "3dc4518659bfcef935ba8101b57dbc0812805dd983bc1d34b81306d90130a201881830f500f500f502f5021a37b5eed4081a59b69b2a",
+};
+#define DESCRIPTORS_HEX_COUNT (sizeof(descriptors_hex) / sizeof(descriptors_hex[0]))
+
+typedef struct {
+    uint8_t buffer[BUFLEN];
+    size_t len;
+} payload;
+
+static void hdkey_deserialize(void *ctx)
+{
+    const payload *p = ctx;
+    crypto_hdkey hdkey;
+    if (urc_crypto_hdkey_deserialize(p->buffer, p->len, &hdkey) != URC_OK) {
+        abort();
+    }
+}
+
+static void account_deserialize(void *ctx)
+{
+    const payload *p = ctx;
+    crypto_account account;
+    if (urc_crypto_account_deserialize(p->buffer, p->len, &account) != URC_OK) {
+        abort();
+    }
+}
+
+size_t bench_build_account(uint8_t *buffer, size_t buffer_len, size_t count)
+{
+    // map(2) { 1: 0x37b5eed4, 2: array(count) }
+    const uint8_t header[] = {0xa2, 0x01, 0x1a, 0x37, 0xb5, 0xee, 0xd4, 0x02};
+    memcpy(buffer, header, sizeof(header));
+    size_t len = sizeof(header);
+    if (count < 24) {
+        buffer[len++] = 0x80 | (uint8_t)count;
+    } else {
+        buffer[len++] = 0x98;
+        buffer[len++] = (uint8_t)count;
+    }
+    for (size_t idx = 0; idx < count; idx++) {
+        const char *hex = descriptors_hex[idx % DESCRIPTORS_HEX_COUNT];
+        len += h2b(hex, buffer_len - len, &buffer[len]);
+    }
+    return len;
+}
+
+void bench_hdkey(void)
+{
+    static payload p;
+
+    // https://github.com/BlockchainCommons/Research/blob/master/papers/bcr-2020-007-hdkey.md#exampletest-vector-1
+    p.len = h2b("a301f503582100e8f32e723decf4051aefac8e2c93c9c5b214313817cdb01a1494b917c8436b35045820873dff81c02f525623fd1f"
+                "e5167eac3a55a049de3d314bb42ee227ffed37d508",
+                BUFLEN, p.buffer);
+    bench_run("hdkey_deserialize/master", hdkey_deserialize, &p, 1);
+
+    // https://github.com/BlockchainCommons/Research/blob/master/papers/bcr-2020-007-hdkey.md#exampletest-vector-2
+    p.len = h2b("a5035821026fe2355745bb2db3630bbc80ef5d58951c963c841f54170ba6e5c12be7fc12a6045820ced155c72456255881793514ed"
+                "c5bd9447e7f74abb88c6d6b6480fd016ee8c8505d90131a1020106d90130a1018a182cf501f501f500f401f4081ae9181cf3",
+                BUFLEN, p.buffer);
+    bench_run("hdkey_deserialize/derived", hdkey_deserialize, &p, 1);
+
+    // with DESCRIPTORS_MAX_SIZE entries every descriptor is kept, the cost per item is the cost per key
+    p.len = bench_build_account(p.buffer, BUFLEN, DESCRIPTORS_MAX_SIZE);
+    bench_run("account_deserialize/max_descriptors", account_deserialize, &p, DESCRIPTORS_MAX_SIZE);
+}
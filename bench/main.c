@@ -0,0 +1,31 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "bench.h"
+
+// urc_bench [--json <path>]
+int main(int argc, char **argv)
+{
+    if (argc == 3 && strcmp(argv[1], "--json") == 0) {
+        if (bench_json_open(argv[2]) != 0) {
+            fprintf(stderr, "can't open %s\n", argv[2]);
+            return 1;
+        }
+    } else if (argc != 1) {
+        fprintf(stderr, "usage: %s [--json <path>]\n", argv[0]);
+        return 1;
+    }
+
+    bench_hdkey();
+    bench_batch();
+    bench_validation();
+    bench_format();
+    bench_checksum();
+    bench_derive();
+    bench_script_index();
+    bench_ur();
+    bench_crc32();
+    bench_codec();
+    bench_psbt();
+    return bench_json_close() == 0 ? 0 : 1;
+}
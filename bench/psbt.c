@@ -0,0 +1,77 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "urc/urc.h"
+
+#include "bench.h"
+
+// from a single input spend to a coinjoin sized transaction, reported per byte
+static const size_t psbt_sizes[] = {1024, 64 * 1024, 4 * 1024 * 1024};
+#define PSBT_SIZES_COUNT (sizeof(psbt_sizes) / sizeof(psbt_sizes[0]))
+
+typedef struct {
+    crypto_psbt psbt;
+    uint8_t *cbor;
+    size_t cbor_len;
+} psbt_ctx;
+
+static void psbt_deserialize(void *ctx)
+{
+    const psbt_ctx *p = ctx;
+    crypto_psbt psbt;
+    if (urc_crypto_psbt_deserialize(p->cbor, p->cbor_len, &psbt) != URC_OK) {
+        abort();
+    }
+    urc_crypto_psbt_free(&psbt);
+}
+
+static void psbt_deserialize_borrowed(void *ctx)
+{
+    const psbt_ctx *p = ctx;
+    crypto_psbt_view psbt;
+    if (urc_crypto_psbt_deserialize_borrowed(p->cbor, p->cbor_len, &psbt) != URC_OK) {
+        abort();
+    }
+}
+
+static void psbt_serialize(void *ctx)
+{
+    const psbt_ctx *p = ctx;
+    uint8_t *cbor;
+    size_t cbor_len;
+    if (urc_crypto_psbt_serialize(&p->psbt, &cbor, &cbor_len) != URC_OK) {
+        abort();
+    }
+    urc_free(cbor);
+}
+
+void bench_psbt(void)
+{
+    srand(1);
+    for (size_t size = 0; size < PSBT_SIZES_COUNT; size++) {
+        const size_t len = psbt_sizes[size];
+        psbt_ctx p = {.psbt = {.psbt = malloc(len), .psbt_len = len}};
+        if (!p.psbt.psbt) {
+            abort();
+        }
+        // the psbt itself is not parsed, random bytes past the magic
+        const uint8_t magic[] = {0x70, 0x73, 0x62, 0x74, 0xff};
+        for (size_t idx = 0; idx < len; idx++) {
+            p.psbt.psbt[idx] = idx < sizeof(magic) ? magic[idx] : (uint8_t)rand();
+        }
+        if (urc_crypto_psbt_serialize(&p.psbt, &p.cbor, &p.cbor_len) != URC_OK) {
+            abort();
+        }
+
+        char name[64];
+        snprintf(name, sizeof(name), "psbt_deserialize/bytes:%zu", len);
+        bench_run(name, psbt_deserialize, &p, len);
+        snprintf(name, sizeof(name), "psbt_deserialize/borrowed/bytes:%zu", len);
+        bench_run(name, psbt_deserialize_borrowed, &p, len);
+        snprintf(name, sizeof(name), "psbt_serialize/bytes:%zu", len);
+        bench_run(name, psbt_serialize, &p, len);
+
+        urc_free(p.cbor);
+        free(p.psbt.psbt);
+    }
+}
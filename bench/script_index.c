@@ -0,0 +1,63 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "urc/urc.h"
+
+#include "bench.h"
+
+#define BUFLEN 4096
+#define GAP_LIMIT 1000
+#define PROBES 4096
+// p2wpkh
+#define SCRIPT_LEN 22
+
+typedef struct {
+    urc_script_index index;
+    // a few hits among random scripts, as in a block
+    uint8_t scripts[PROBES][SCRIPT_LEN];
+} script_index_ctx;
+
+static void script_index_lookup(void *ctx)
+{
+    const script_index_ctx *index = ctx;
+    size_t hits = 0;
+    for (size_t idx = 0; idx < PROBES; idx++) {
+        hits += urc_script_index_lookup(&index->index, index->scripts[idx], sizeof(index->scripts[idx]), NULL);
+    }
+    if (hits == 0) {
+        abort();
+    }
+}
+
+void bench_script_index(void)
+{
+    static uint8_t buffer[BUFLEN];
+    static script_index_ctx ctx;
+
+    // every single key descriptor of the account test vector, both chains
+    size_t len = bench_build_account(buffer, BUFLEN, 6);
+    crypto_account account;
+    if (urc_crypto_account_deserialize(buffer, len, &account) != URC_OK ||
+        urc_script_index_init(&ctx.index, &account, GAP_LIMIT, 0) != URC_OK) {
+        abort();
+    }
+
+    srand(1);
+    for (size_t idx = 0; idx < PROBES; idx++) {
+        if (idx % 64 == 0) {
+            const urc_scriptpubkey *script;
+            do {
+                script = &ctx.index.scripts[(size_t)rand() % ctx.index.entries_count];
+            } while (script->script_len != SCRIPT_LEN);
+            memcpy(ctx.scripts[idx], script->script, sizeof(ctx.scripts[idx]));
+            continue;
+        }
+        ctx.scripts[idx][0] = 0x00;
+        ctx.scripts[idx][1] = 0x14;
+        for (size_t byte = 2; byte < sizeof(ctx.scripts[idx]); byte++) {
+            ctx.scripts[idx][byte] = (uint8_t)rand();
+        }
+    }
+    bench_run("script_index_lookup", script_index_lookup, &ctx, PROBES);
+    urc_script_index_free(&ctx.index);
+}
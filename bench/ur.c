@@ -0,0 +1,85 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "urc/urc.h"
+
+#include "bench.h"
+
+// a psbt of a few inputs, in the ~200 bytes fragments of a dense animated QR code
+#define PSBT_LEN 10000
+#define MAX_FRAGMENT_LEN 200
+#define FRAMES 64
+
+typedef struct {
+    urc_ur_encoder encoder;
+    // the first FRAMES parts of the encoder
+    char *parts[FRAMES];
+    size_t parts_len[FRAMES];
+} ur_ctx;
+
+static void ur_encoder_next_part(void *ctx)
+{
+    ur_ctx *ur = ctx;
+    for (size_t idx = 0; idx < FRAMES; idx++) {
+        const char *part;
+        size_t part_len;
+        if (urc_ur_encoder_next_part(&ur->encoder, &part, &part_len) != URC_OK) {
+            abort();
+        }
+    }
+}
+
+static void ur_decoder_receive(void *ctx)
+{
+    const ur_ctx *ur = ctx;
+    urc_ur_decoder decoder;
+    urc_ur_decoder_init(&decoder, 0);
+    for (size_t idx = 0; idx < FRAMES && !urc_ur_decoder_is_complete(&decoder); idx++) {
+        if (urc_ur_decoder_receive(&decoder, ur->parts[idx], ur->parts_len[idx]) != URC_OK) {
+            abort();
+        }
+    }
+    if (!urc_ur_decoder_is_complete(&decoder)) {
+        abort();
+    }
+    urc_ur_decoder_free(&decoder);
+}
+
+void bench_ur(void)
+{
+    static uint8_t raw[PSBT_LEN];
+    static ur_ctx ctx;
+
+    srand(1);
+    for (size_t idx = 0; idx < PSBT_LEN; idx++) {
+        raw[idx] = (uint8_t)rand();
+    }
+    crypto_psbt psbt = {.psbt = raw, .psbt_len = PSBT_LEN};
+    if (urc_ur_encoder_init_psbt(&ctx.encoder, &psbt, MAX_FRAGMENT_LEN) != URC_OK ||
+        urc_ur_encoder_seq_len(&ctx.encoder) >= FRAMES) {
+        abort();
+    }
+    // every fragment but one, then mixed parts
+    for (size_t idx = 0, frame = 0; frame < FRAMES; idx++) {
+        const char *part;
+        size_t part_len;
+        if (urc_ur_encoder_next_part(&ctx.encoder, &part, &part_len) != URC_OK) {
+            abort();
+        }
+        if (idx == 0) {
+            continue;
+        }
+        ctx.parts[frame] = malloc(part_len);
+        if (!ctx.parts[frame]) {
+            abort();
+        }
+        memcpy(ctx.parts[frame], part, part_len);
+        ctx.parts_len[frame++] = part_len;
+    }
+    bench_run("ur_encoder_next_part", ur_encoder_next_part, &ctx, FRAMES);
+    bench_run("ur_decoder_receive", ur_decoder_receive, &ctx, 1);
+    for (size_t idx = 0; idx < FRAMES; idx++) {
+        free(ctx.parts[idx]);
+    }
+    urc_ur_encoder_free(&ctx.encoder);
+}
@@ -0,0 +1,33 @@
+#include <stdlib.h>
+
+#include "urc/urc.h"
+
+#include "bench.h"
+
+#define BUFLEN 4096
+
+typedef struct {
+    uint8_t buffer[BUFLEN];
+    size_t len;
+} payload;
+
+static void account_deserialize(void *ctx)
+{
+    const payload *p = ctx;
+    crypto_account account;
+    if (urc_crypto_account_deserialize(p->buffer, p->len, &account) != URC_OK) {
+        abort();
+    }
+}
+
+void bench_validation(void)
+{
+    static payload p;
+    p.len = bench_build_account(p.buffer, BUFLEN, DESCRIPTORS_MAX_SIZE);
+
+    urc_validation_profile previous = urc_set_thread_validation_profile(urc_validation_profile_trusted);
+    bench_run("account_deserialize/trusted", account_deserialize, &p, DESCRIPTORS_MAX_SIZE);
+    urc_set_thread_validation_profile(urc_validation_profile_strict);
+    bench_run("account_deserialize/strict", account_deserialize, &p, DESCRIPTORS_MAX_SIZE);
+    urc_set_thread_validation_profile(previous);
+}
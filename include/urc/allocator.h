@@ -0,0 +1,47 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct {
+    // must return memory suitably aligned for any type, NULL on failure
+    void *(*malloc)(void *ctx, size_t size);
+    // ``ptr`` is never NULL
+    void (*free)(void *ctx, void *ptr);
+    void *ctx;
+} urc_allocator;
+
+// install ``allocator`` for every allocation the library makes on the calling thread,
+// urc_free and the other urc_*free functions release memory through it as well
+// NULL restores the default allocator (wally_malloc/wally_free)
+// the previously installed allocator is returned, restoring it after a call scopes ``allocator`` to that call
+// this is the only way to choose an allocator, entry points take no allocator parameter
+// ``allocator`` must outlive its installation and memory must be freed while the allocator it came from is installed:
+// strings, serialized buffers, psbts, jade responses, unbounded and compact accounts, UR encoders and decoders, while the
+// deserialized seeds, keys, outputs and bounded accounts own no memory
+const urc_allocator *urc_set_thread_allocator(const urc_allocator *allocator);
+const urc_allocator *urc_get_thread_allocator(void);
+
+// bump allocator over a caller provided buffer: allocating is a pointer increment, freeing is a no-op
+// with the exception of the most recent allocation, whose space is given back (as grow-and-retry loops do)
+// everything is released at once with urc_arena_reset
+// an arena is not thread safe
+typedef struct {
+    uint8_t *buffer;
+    size_t size;
+    size_t used;
+    size_t last;
+} urc_arena;
+
+void urc_arena_init(urc_arena *arena, void *buffer, size_t size);
+void urc_arena_reset(urc_arena *arena);
+// ``arena`` must outlive the returned allocator
+urc_allocator urc_arena_allocator(urc_arena *arena);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,49 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "urc/core.h"
+#include "urc/error.h"
+
+typedef enum {
+    urc_batch_type_crypto_seed,            // out: crypto_seed *
+    urc_batch_type_crypto_psbt,            // out: crypto_psbt *
+    urc_batch_type_crypto_eckey,           // out: crypto_eckey *
+    urc_batch_type_crypto_hdkey,           // out: crypto_hdkey *
+    urc_batch_type_crypto_output,          // out: crypto_output *
+    urc_batch_type_crypto_account,         // out: crypto_account *
+    urc_batch_type_jade_account,           // out: crypto_account *
+    urc_batch_type_jade_bip8539_response,  // out: jade_bip8539_response *
+    urc_batch_type_jade_rpc,               // out: char **
+} urc_batch_type;
+
+typedef struct {
+    urc_batch_type type;
+    const uint8_t *cbor_buffer;
+    size_t cbor_len;
+    void *out;
+    // set to the error code the matching urc_*_deserialize function returned
+    int result;
+} urc_batch_item;
+
+// deserializes every item, spread over ``threads`` threads (the calling one included), 0 means one per online cpu
+// items are split evenly between threads, a thread done with its share steals from the others
+// the calling thread's validation profile and allocator are installed on every worker, so that the results can be freed
+// by the caller as usual: the allocator is used concurrently and must be thread safe (arenas are not)
+// returns URC_OK once every item has been processed, whatever their results, URC_EINVALIDARG on bad arguments
+// the batch completes even if worker threads can't be started, with less parallelism
+int urc_batch_deserialize(urc_batch_item *items, size_t items_count, size_t threads);
+
+// the urc_*_deserialize function matching ``type`` under ``profile``, whatever the calling thread's validation profile
+// e.g. to mix trusted and untrusted inputs on one thread, ``out`` as in urc_batch_item
+int urc_deserialize_with_profile(urc_batch_type type, const uint8_t *cbor_buffer, size_t cbor_len, void *out,
+                                 urc_validation_profile profile);
+
+#ifdef __cplusplus
+}
+#endif
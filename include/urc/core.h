@@ -4,6 +4,46 @@
 extern "C" {
 #endif
 
+#include <stddef.h>
+#include <stdint.h>
+
+// read-only views on a portion of the caller's input buffer
+// they are valid as long as that buffer lives and must not be freed
+typedef struct {
+    const uint8_t *data;
+    size_t len;
+} urc_bytes_view;
+
+typedef struct {
+    const char *text; // not NUL terminated
+    size_t len;
+} urc_text_view;
+
+typedef enum {
+    // input from a trusted source, e.g. produced and checked by our own backend: no validation pass before decoding,
+    // decoders still check everything they read
+    urc_validation_profile_trusted,
+    // untrusted input, e.g. scanned from a camera: the whole payload is validated before decoding, canonical map
+    // ordering, unique map keys, valid utf8, no undefined values and no trailing data are required
+    urc_validation_profile_strict,
+} urc_validation_profile;
+
+// select the validation profile of every urc_*_deserialize call made on the calling thread, trusted by default
+// the previous profile is returned, restoring it after a call scopes ``profile`` to that call
+// urc_deserialize_with_profile, urc_ur_deserialize_with_profile and urc_ur_decoder_set_validation_profile take one
+// explicitly instead
+urc_validation_profile urc_set_thread_validation_profile(urc_validation_profile profile);
+urc_validation_profile urc_get_thread_validation_profile(void);
+
+// caller supplied executor, e.g. an existing thread pool
+// ``run`` calls ``fn(fn_ctx, idx)`` once for every idx in [0, count), in any order and on any threads, and returns when
+// every call has completed
+typedef void (*urc_task_fn)(void *fn_ctx, size_t idx);
+typedef struct {
+    void (*run)(void *ctx, size_t count, urc_task_fn fn, void *fn_ctx);
+    void *ctx;
+} urc_executor;
+
 void urc_free(void *ptr);
 void urc_string_free(char *str);
 void urc_string_array_free(char *str_array[]);
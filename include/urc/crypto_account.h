@@ -8,6 +8,7 @@ extern "C" {
 #include <stddef.h>
 #include <stdint.h>
 
+#include "urc/core.h"
 #include "urc/crypto_output.h"
 #include "urc/error.h"
 
@@ -26,10 +27,70 @@ typedef struct {
 int urc_crypto_account_deserialize(const uint8_t *cbor_buffer, size_t cbor_len, crypto_account *out);
 // parse an account in jade format, descriptors are not introduced by tag 308
 int urc_jade_account_deserialize(const uint8_t *cbor_buffer, size_t len, crypto_account *out);
+// exact size serializers, see urc_crypto_seed_serialize, ``cbor_out`` must be freed by caller using urc_free
+// crypto-account format, descriptors are introduced by tag 308
+int urc_crypto_account_serialize(const crypto_account *account, uint8_t **cbor_out, size_t *cbor_len);
+int urc_crypto_account_serialize_to_buffer(const crypto_account *account, uint8_t *out, size_t out_len, size_t *cbor_len);
 
 // *out[] must be freed using urc_string_array_free()
 // last element of *out[] is NULL
 int urc_crypto_account_format(const crypto_account *account, urc_crypto_output_format_mode mode, char **out[]);
+// same as urc_crypto_account_format, descriptors are formatted concurrently and returned in order
+// ``threads`` threads are used, the calling one included, 0 means one per online cpu
+// the calling thread's allocator is used from every thread and must be thread safe (arenas are not)
+int urc_crypto_account_format_parallel(const crypto_account *account, urc_crypto_output_format_mode mode, size_t threads,
+                                       char **out[]);
+int urc_crypto_account_format_with_executor(const crypto_account *account, urc_crypto_output_format_mode mode,
+                                            const urc_executor *executor, char **out[]);
+// descriptor ``idx`` as urc_crypto_output_format_to_buffer, URC_EINVALIDARG when ``idx`` is out of range
+int urc_crypto_account_format_to_buffer(const crypto_account *account, size_t idx, urc_crypto_output_format_mode mode,
+                                        char *out, size_t out_len, size_t *descriptor_len);
+
+// same as crypto_account, without the DESCRIPTORS_MAX_SIZE limit: every descriptor is kept, in a single block of
+// exactly ``descriptors_count`` entries owned by the account
+// taproot descriptors are skipped as in crypto_account
+typedef struct {
+    crypto_output *descriptors;
+    size_t descriptors_count;
+    uint32_t master_fingerprint;
+} crypto_account_unbounded;
+
+// ``out`` must be freed by caller using urc_crypto_account_unbounded_free, also when URC_ETAPROOTNOTSUPPORTED is returned
+int urc_crypto_account_unbounded_deserialize(const uint8_t *cbor_buffer, size_t cbor_len, crypto_account_unbounded *out);
+int urc_jade_account_unbounded_deserialize(const uint8_t *cbor_buffer, size_t cbor_len, crypto_account_unbounded *out);
+int urc_crypto_account_unbounded_serialize(const crypto_account_unbounded *account, uint8_t **cbor_out, size_t *cbor_len);
+int urc_crypto_account_unbounded_serialize_to_buffer(const crypto_account_unbounded *account, uint8_t *out, size_t out_len,
+                                                     size_t *cbor_len);
+size_t urc_crypto_account_unbounded_count(const crypto_account_unbounded *account);
+// NULL if ``idx`` is out of range
+const crypto_output *urc_crypto_account_unbounded_descriptor(const crypto_account_unbounded *account, size_t idx);
+// *out[] must be freed using urc_string_array_free(), last element of *out[] is NULL
+int urc_crypto_account_unbounded_format(const crypto_account_unbounded *account, urc_crypto_output_format_mode mode,
+                                        char **out[]);
+int urc_crypto_account_unbounded_format_parallel(const crypto_account_unbounded *account, urc_crypto_output_format_mode mode,
+                                                 size_t threads, char **out[]);
+int urc_crypto_account_unbounded_format_with_executor(const crypto_account_unbounded *account,
+                                                      urc_crypto_output_format_mode mode, const urc_executor *executor,
+                                                      char **out[]);
+int urc_crypto_account_unbounded_format_to_buffer(const crypto_account_unbounded *account, size_t idx,
+                                                  urc_crypto_output_format_mode mode, char *out, size_t out_len,
+                                                  size_t *descriptor_len);
+void urc_crypto_account_unbounded_free(crypto_account_unbounded *account);
+
+// same as crypto_account_unbounded, with compact descriptors, see crypto_output_compact
+typedef struct {
+    crypto_output_compact *descriptors;
+    size_t descriptors_count;
+    uint32_t master_fingerprint;
+} crypto_account_compact;
+
+// ``out`` must be freed by caller using urc_crypto_account_compact_free, also when URC_ETAPROOTNOTSUPPORTED is returned
+int urc_crypto_account_deserialize_compact(const uint8_t *cbor_buffer, size_t cbor_len, crypto_account_compact *out);
+int urc_jade_account_deserialize_compact(const uint8_t *cbor_buffer, size_t cbor_len, crypto_account_compact *out);
+size_t urc_crypto_account_compact_count(const crypto_account_compact *account);
+// descriptor ``idx`` expanded as urc_crypto_output_compact_expand, URC_EINVALIDARG when ``idx`` is out of range
+int urc_crypto_account_compact_descriptor(const crypto_account_compact *account, size_t idx, crypto_output *out);
+void urc_crypto_account_compact_free(crypto_account_compact *account);
 
 #ifdef __cplusplus
 }
@@ -28,9 +28,14 @@ typedef struct {
 } crypto_eckey;
 
 int urc_crypto_eckey_deserialize(const uint8_t *cbor_buffer, size_t cbor_len, crypto_eckey *out);
+// exact size serializers, see urc_crypto_seed_serialize, ``cbor_out`` must be freed by caller using urc_free
+int urc_crypto_eckey_serialize(const crypto_eckey *eckey, uint8_t **cbor_out, size_t *cbor_len);
+int urc_crypto_eckey_serialize_to_buffer(const crypto_eckey *eckey, uint8_t *out, size_t out_len, size_t *cbor_len);
 
 // ``out`` must be freed by caller using urc_string_free function
 int urc_crypto_eckey_format(const crypto_eckey *eckey, char **out);
+// as urc_crypto_output_format_to_buffer, ``key_len`` is the number of hex digits
+int urc_crypto_eckey_format_to_buffer(const crypto_eckey *eckey, char *out, size_t out_len, size_t *key_len);
 
 #ifdef __cplusplus
 }
@@ -7,6 +7,7 @@ extern "C" {
 #include <stdbool.h>
 #include <stdint.h>
 
+#include "urc/core.h"
 #include "urc/error.h"
 
 #define COININFO_COIN_TYPE_BTC 0
@@ -94,6 +95,10 @@ typedef struct {
 
     char name[NAME_BUFFER_SIZE];
     char note[NOTE_BUFFER_SIZE];
+    // untruncated name and note, pointing into the buffer given to the deserializer
+    // chunked strings are not contiguous in that buffer and have no view
+    urc_text_view name_view;
+    urc_text_view note_view;
 } hd_derived_key;
 
 typedef struct {
@@ -109,9 +114,33 @@ typedef struct {
 } crypto_hdkey;
 
 int urc_crypto_hdkey_deserialize(const uint8_t *cbor_buffer, size_t cbor_len, crypto_hdkey *out);
+// exact size serializers, see urc_crypto_seed_serialize, ``cbor_out`` must be freed by caller using urc_free
+// optional fields holding the value their absence stands for are left out, name and note are taken from the copies
+// inside the key
+int urc_crypto_hdkey_serialize(const crypto_hdkey *hdkey, uint8_t **cbor_out, size_t *cbor_len);
+int urc_crypto_hdkey_serialize_to_buffer(const crypto_hdkey *hdkey, uint8_t *out, size_t out_len, size_t *cbor_len);
 
 // ``out`` must be freed by caller using urc_string_free function
 int urc_crypto_hdkey_format(const crypto_hdkey *hdkey, char **out);
+// as urc_crypto_output_format_to_buffer, ``base58_len`` is the length of the extended key
+int urc_crypto_hdkey_format_to_buffer(const crypto_hdkey *hdkey, char *out, size_t out_len, size_t *base58_len);
+
+// process wide LRU cache of base58 encoded public extended keys (xpub/tpub), disabled by default
+// formatting a key found in the cache skips the wally key setup, the double sha256 and the base58 encoding
+// private keys are never cached
+// the cache is shared by every thread, ``capacity`` keys are kept, enabling it again drops its content
+int urc_hdkey_cache_enable(size_t capacity);
+void urc_hdkey_cache_disable(void);
+
+typedef struct {
+    uint64_t hits;
+    uint64_t misses;
+    size_t entries;
+    size_t capacity;
+} urc_hdkey_cache_stats;
+
+void urc_hdkey_cache_get_stats(urc_hdkey_cache_stats *out);
+void urc_hdkey_cache_reset_stats(void);
 
 #ifdef __cplusplus
 }
@@ -49,15 +49,63 @@ typedef struct {
 } crypto_output;
 
 int urc_crypto_output_deserialize(const uint8_t *cbor_buffer, size_t cbor_len, crypto_output *out);
+// exact size serializers, see urc_crypto_seed_serialize, ``cbor_out`` must be freed by caller using urc_free
+int urc_crypto_output_serialize(const crypto_output *output, uint8_t **cbor_out, size_t *cbor_len);
+int urc_crypto_output_serialize_to_buffer(const crypto_output *output, uint8_t *out, size_t out_len, size_t *cbor_len);
 
 typedef enum {
     // output descriptor represented as is
-    urc_crypto_output_format_mode_default,
+    urc_crypto_output_format_mode_default = 0,
     // if derivation path is empty, and key origin counts to 2, an extra ``/0/*`` is added as derivation path
-    urc_crypto_output_format_mode_BIP44_compatible,
+    urc_crypto_output_format_mode_BIP44_compatible = 1,
+    // BIP-380 ``#checksum`` suffix, computed while the descriptor is written
+    urc_crypto_output_format_mode_checksum = 2,
+    // modes are bit flags, their combinations have enumerators of their own
+    urc_crypto_output_format_mode_BIP44_compatible_checksum =
+        urc_crypto_output_format_mode_BIP44_compatible | urc_crypto_output_format_mode_checksum,
 } urc_crypto_output_format_mode;
 // ``out`` must be freed by caller using urc_string_free function
 int urc_crypto_output_format(const crypto_output *output, urc_crypto_output_format_mode mode, char **out);
+// writes into ``out``, snprintf style: ``descriptor_len`` is set to the length of the descriptor, NUL excluded, and
+// URC_EBUFFERTOOSMALL is returned when ``out`` can't hold it and its NUL, a NULL ``out`` of 0 bytes measures
+// nothing is allocated, and no truncated descriptor is left in ``out`` on failure
+int urc_crypto_output_format_to_buffer(const crypto_output *output, urc_crypto_output_format_mode mode, char *out,
+                                       size_t out_len, size_t *descriptor_len);
+
+// opt-in compact form of a crypto_output, for descriptors kept resident in large numbers
+// a crypto_output takes 552 bytes on 64-bit platforms whatever it holds: 240 of them are the two inline key paths of
+// CRYPTO_KEYPATH_MAX_COMPONENTS components, 160 the name and note copies
+// the compact form keeps the key material inline in 96 bytes and moves the key paths, name and note of a derived hdkey
+// to one exactly sized block, allocated only when the key has any of them
+// it is expanded back into a crypto_output to be formatted, serialized or derived from
+typedef struct {
+    // internal representation, use the functions below
+    uint8_t key[CRYPTO_HDKEY_KEYDATA_SIZE + CRYPTO_HDKEY_CHAINCODE_SIZE];
+    uint8_t output_type;
+    uint8_t keyexp_type;
+    uint8_t keytype;
+    uint8_t key_type;
+    uint8_t flags;
+    crypto_coininfo useinfo;
+    uint32_t parent_fingerprint;
+    void *extra;
+} crypto_output_compact;
+
+// name and note are kept untruncated, chunked ones (which have no view) as their truncated copies
+// ``out`` must be freed by caller using urc_crypto_output_compact_free, on failure nothing is left to free
+int urc_crypto_output_deserialize_compact(const uint8_t *cbor_buffer, size_t cbor_len, crypto_output_compact *out);
+// name and note views of ``out`` point into ``compact``, which must outlive them
+int urc_crypto_output_compact_expand(const crypto_output_compact *compact, crypto_output *out);
+void urc_crypto_output_compact_free(crypto_output_compact *compact);
+
+#define URC_DESCRIPTOR_CHECKSUM_LEN 8
+// BIP-380 checksum of the ``len`` characters of ``descriptor``, which must not carry one already
+// ``out`` is NUL terminated, URC_EINVALIDARG is returned for characters outside of the descriptor charset
+int urc_descriptor_checksum(const char *descriptor, size_t len, char out[URC_DESCRIPTOR_CHECKSUM_LEN + 1]);
+// checks a ``descriptor#checksum`` string of ``len`` characters
+// URC_EINVALIDARG is returned when there is no checksum or a character is outside of the charset,
+// URC_EINVALIDCHECKSUM when the checksum doesn't match
+int urc_descriptor_checksum_verify(const char *descriptor, size_t len);
 
 #ifdef __cplusplus
 }
@@ -4,6 +4,7 @@
 extern "C" {
 #endif
 
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 
@@ -15,11 +16,69 @@ typedef struct {
 
 } crypto_psbt;
 
+typedef struct {
+    const uint8_t *psbt;
+    size_t psbt_len;
+} crypto_psbt_view;
+
 // ``out`` must be freed by caller using urc_crypto_psbt_free
 int urc_crypto_psbt_deserialize(const uint8_t *cbor_buffer, size_t cbor_len, crypto_psbt *out);
+// zero-copy variant: ``out->psbt`` points into ``cbor_buffer`` and is valid as long as ``cbor_buffer`` lives
+// indefinite length (chunked) byte strings are not contiguous in ``cbor_buffer`` and are rejected with URC_EUNHANDLEDCASE
+int urc_crypto_psbt_deserialize_borrowed(const uint8_t *cbor_buffer, size_t cbor_len, crypto_psbt_view *out);
+// a crypto-psbt is the psbt behind a byte string header of 1 to 9 bytes, serializers size it exactly
+// ``cbor_out`` must be freed by caller using urc_free
 int urc_crypto_psbt_serialize(const crypto_psbt *psbt, uint8_t **cbor_out, size_t *cbor_len);
+// as urc_crypto_seed_serialize_to_buffer
+int urc_crypto_psbt_serialize_to_buffer(const crypto_psbt *psbt, uint8_t *out, size_t out_len, size_t *cbor_len);
+// the header alone, into ``header`` of at least URC_CRYPTO_PSBT_HEADER_MAX_LEN bytes: sending it followed by the psbt
+// (e.g. with writev) produces the crypto-psbt without copying the psbt anywhere
+#define URC_CRYPTO_PSBT_HEADER_MAX_LEN 9
+int urc_crypto_psbt_serialize_header(size_t psbt_len, uint8_t *header, size_t *header_len);
 void urc_crypto_psbt_free(crypto_psbt *psbt);
 
+// streaming decoder, for a crypto-psbt received in pieces
+// the cbor byte string header is parsed incrementally and the psbt bytes are handed over as soon as they arrive, either
+// to a caller provided sink or into a caller provided buffer
+// both definite and indefinite length (chunked) byte strings are supported
+// the sink returns URC_OK to continue, any other value aborts the decoding and is returned by push
+typedef int (*urc_crypto_psbt_sink)(void *ctx, const uint8_t *psbt, size_t psbt_len);
+
+typedef struct {
+    // internal state, use the functions below
+    urc_crypto_psbt_sink sink;
+    void *sink_ctx;
+    uint8_t *buffer;
+    size_t buffer_capacity;
+    size_t psbt_len; // bytes delivered so far
+    uint64_t expected_len;
+    uint64_t remaining; // header argument being read, then bytes left in the current chunk
+    uint8_t argument_bytes;
+    enum {
+        psbt_decoder_state_header,
+        psbt_decoder_state_chunk_header,
+        psbt_decoder_state_argument,
+        psbt_decoder_state_data,
+        psbt_decoder_state_done,
+    } state;
+    bool indefinite;
+    bool reading_chunk;
+    int error;
+} urc_crypto_psbt_decoder;
+
+void urc_crypto_psbt_decoder_init(urc_crypto_psbt_decoder *decoder, urc_crypto_psbt_sink sink, void *sink_ctx);
+// psbt bytes are written into ``buffer``, URC_EBUFFERTOOSMALL is returned as soon as they are known not to fit
+void urc_crypto_psbt_decoder_init_buffer(urc_crypto_psbt_decoder *decoder, uint8_t *buffer, size_t buffer_len);
+// ``chunk`` can have any size, including a single byte, and is not retained
+// bytes following the end of the crypto-psbt are rejected with URC_EINVALIDARG
+// errors are sticky: once push fails every following call returns the same error
+int urc_crypto_psbt_decoder_push(urc_crypto_psbt_decoder *decoder, const uint8_t *chunk, size_t chunk_len);
+// psbt length, as soon as a definite length header has been parsed
+// URC_EUNHANDLEDCASE if the length is not known in advance, (yet, or because the byte string is chunked)
+int urc_crypto_psbt_decoder_expected_len(const urc_crypto_psbt_decoder *decoder, size_t *psbt_len);
+// checks the crypto-psbt is complete and returns the number of psbt bytes delivered
+int urc_crypto_psbt_decoder_finish(const urc_crypto_psbt_decoder *decoder, size_t *psbt_len);
+
 #ifdef __cplusplus
 }
 #endif
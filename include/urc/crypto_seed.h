@@ -17,6 +17,12 @@ typedef struct {
 } crypto_seed;
 
 int urc_crypto_seed_deserialize(const uint8_t *cbor_buffer, size_t cbor_len, crypto_seed *out);
+// serializers compute the exact encoded size before writing anything, there is no grow and retry
+// ``cbor_out`` is allocated to that size and must be freed by caller using urc_free
+int urc_crypto_seed_serialize(const crypto_seed *seed, uint8_t **cbor_out, size_t *cbor_len);
+// writes into ``out``, URC_EBUFFERTOOSMALL when it is shorter than the encoding
+// ``cbor_len`` is set to the encoded size in both cases: a NULL ``out`` of 0 bytes measures without writing
+int urc_crypto_seed_serialize_to_buffer(const crypto_seed *seed, uint8_t *out, size_t out_len, size_t *cbor_len);
 
 #ifdef __cplusplus
 }
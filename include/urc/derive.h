@@ -0,0 +1,61 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "urc/crypto_output.h"
+
+// scriptPubKey derivation for ranged single key descriptors: pk, pkh, wpkh and sh(wpkh) over an hdkey whose
+// children path ends with a non hardened wildcard, e.g. ``/1/*`` or ``/<0;1>/*``
+// an empty children path is read as ``/<0;1>/*``, as the BIP44 compatible formatter does
+
+// p2pk, the longest of them
+#define URC_SCRIPTPUBKEY_MAX_LEN 35
+
+typedef enum {
+    urc_script_type_p2pk,
+    urc_script_type_p2pkh,
+    urc_script_type_p2wpkh,
+    urc_script_type_p2sh_p2wpkh,
+} urc_script_type;
+
+typedef struct {
+    uint8_t script[URC_SCRIPTPUBKEY_MAX_LEN];
+    uint8_t script_len;
+} urc_scriptpubkey;
+
+// public key the wildcard is applied to
+typedef struct {
+    uint32_t version;
+    uint32_t child_num;
+    uint8_t depth;
+    uint8_t chaincode[CRYPTO_HDKEY_CHAINCODE_SIZE];
+    uint8_t pubkey[CRYPTO_HDKEY_KEYDATA_SIZE];
+} urc_script_deriver_parent;
+
+#define URC_SCRIPT_DERIVER_MAX_CHAINS 2
+typedef struct {
+    urc_script_type script_type;
+    // 2 when the children path holds a ``<external;internal>`` pair, 1 otherwise
+    size_t chains_count;
+    // derived once at init, for every chain
+    urc_script_deriver_parent parents[URC_SCRIPT_DERIVER_MAX_CHAINS];
+} urc_script_deriver;
+
+// URC_EUNHANDLEDCASE is returned for outputs or paths the deriver doesn't support
+// hardened components before the wildcard require a private key
+int urc_script_deriver_init(urc_script_deriver *deriver, const crypto_output *output);
+
+// writes the scriptPubKeys of indexes [first, first + count) of ``chain`` (0 external, 1 internal) to ``out``
+// indexes must be non hardened, the range is split among ``threads`` threads, the calling one included,
+// 0 means one per online cpu
+int urc_script_deriver_derive(const urc_script_deriver *deriver, uint32_t chain, uint32_t first, size_t count,
+                              size_t threads, urc_scriptpubkey *out);
+
+#ifdef __cplusplus
+}
+#endif
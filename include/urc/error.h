@@ -15,3 +15,4 @@
 #define URC_EWALLYINTERNALERROR 12
 #define URC_ENOMEM 13
 #define URC_EINTERNALERROR 14
+#define URC_EINVALIDCHECKSUM 15
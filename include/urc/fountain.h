@@ -0,0 +1,145 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "urc/core.h"
+#include "urc/crypto_psbt.h"
+#include "urc/ur.h"
+
+// https://github.com/BlockchainCommons/Research/blob/master/papers/bcr-2024-001-multipart-ur.md
+// multipart URs (``ur:<type>/<seqNum>-<seqLen>/<bytewords>``), as shown by animated QR codes
+// the message is split into seqLen fragments, parts seqNum <= seqLen carry one of them and the following ones the xor
+// of a pseudo random selection of fragments, the fountain code of the reference implementation (bc-ur)
+
+typedef struct {
+    // internal state: alias tables of the fragment count distribution, shuffle scratch
+    double *probs;
+    uint32_t *aliases;
+    uint32_t *remaining;
+    uint32_t seq_len;
+} urc_fountain_sampler;
+
+// reassembles a multipart UR from parts received in any order, duplicates included
+// mixed parts are reduced by the fragments already known as they arrive, the ones still mixing several unknown fragments
+// are kept until enough of those show up, the decoder completes as soon as every fragment is known
+// mixed parts are stored as sorted lists of their unknown fragments, in a store twice the size of the fragments: once
+// full, the part mixing the most fragments makes room for one mixing fewer, other parts are dropped and later ones in
+// the stream make up for them
+// memory is allocated by the first part: the fragments (seqLen * fragment length), the store and a few words per
+// fragment, about 3.5 times the message for fragments of 100 bytes and 12 times for the shortest ones
+// messages longer than ``max_message_len`` are rejected with URC_EBUFFERTOOSMALL, messages split in fragments shorter
+// than URC_UR_DECODER_MIN_FRAGMENT_LEN, which encoders don't produce, with URC_EUNKNOWNFORMAT
+// single part URs are accepted as well and complete the decoder at once
+#define URC_UR_DECODER_TYPE_MAX_LEN 32
+#define URC_UR_DECODER_MIN_FRAGMENT_LEN 5
+
+typedef struct {
+    // internal state, use the functions below
+    size_t max_message_len;
+    urc_validation_profile validation_profile;
+    char type[URC_UR_DECODER_TYPE_MAX_LEN];
+    size_t type_len;
+    uint32_t seq_len;
+    uint32_t checksum;
+    size_t message_len;
+    size_t fragment_len;
+
+    // seq_len fragments, the message followed by zero padding once complete
+    uint8_t *fragments;
+    uint64_t *received;
+    size_t bitset_words;
+    uint32_t received_count;
+
+    // stored mixed parts: xor of the fragments in their index list, none of which is known yet
+    // part data fills the store from its start, index lists from its end, down to the word at ``mixed_low``
+    // the slots of removed parts, with a zero degree, are reclaimed once the store is full
+    uint8_t *mixed_store;
+    size_t mixed_store_words;
+    size_t mixed_low;
+    size_t *mixed_offsets;
+    uint32_t *mixed_degrees;
+    size_t mixed_capacity;
+    size_t mixed_slots;
+    size_t mixed_count;
+    // the part at hand, reduced by the fragments known
+    uint8_t *scratch;
+
+    // fragments known but not removed from the mixed parts yet
+    uint32_t *pending;
+    uint32_t *chosen;
+    urc_fountain_sampler sampler;
+
+    // decoded bytewords of the part at hand
+    uint8_t *part;
+    size_t part_capacity;
+    int error;
+} urc_ur_decoder;
+
+// 0 for ``max_message_len`` means no limit
+// parts and the message are validated under the calling thread's validation profile at init, unless another one is set
+void urc_ur_decoder_init(urc_ur_decoder *decoder, size_t max_message_len);
+// the profile the decoder validates its parts and message under, kept by urc_ur_decoder_free for the next message
+void urc_ur_decoder_set_validation_profile(urc_ur_decoder *decoder, urc_validation_profile profile);
+// parts of a completed message are ignored, parts of another message are rejected with URC_EINVALIDARG
+// a message whose CRC32 doesn't match fails with URC_EINVALIDCHECKSUM, that error is sticky
+int urc_ur_decoder_receive(urc_ur_decoder *decoder, const char *part, size_t part_len);
+bool urc_ur_decoder_is_complete(const urc_ur_decoder *decoder);
+// fraction of the fragments known, 0 before the first part and 1 once complete
+double urc_ur_decoder_progress(const urc_ur_decoder *decoder);
+// URC_EUNHANDLEDCASE until complete, ``type`` (lower case) and ``message`` point into the decoder
+int urc_ur_decoder_result(const urc_ur_decoder *decoder, urc_text_view *type, const uint8_t **message, size_t *message_len);
+// deserializes the message with the deserializer of its type, in place: ``decoder`` must outlive ``out``
+int urc_ur_decoder_deserialize(const urc_ur_decoder *decoder, urc_ur_object *out);
+void urc_ur_decoder_free(urc_ur_decoder *decoder);
+
+// endless stream of parts for a message, e.g. the frames of an animated QR code
+// the message is split once at init, the buffers the parts are written to are allocated once as well: pulling a part
+// never allocates, and costs the xor of its fragments plus the bytewords encoding
+// a message that fits in a single fragment is streamed as the same single part UR over and over, as bc-ur does
+// fragments are at most ``max_fragment_len`` (>= URC_UR_ENCODER_MIN_FRAGMENT_LEN) bytes, of nearly equal length
+#define URC_UR_ENCODER_MIN_FRAGMENT_LEN 10
+
+typedef struct {
+    // internal state, use the functions below
+    char type[URC_UR_DECODER_TYPE_MAX_LEN];
+    size_t type_len;
+    uint32_t seq_len;
+    uint32_t seq_num;
+    uint32_t checksum;
+    size_t message_len;
+    size_t fragment_len;
+
+    // the message, zero padded to seq_len fragments
+    uint8_t *fragments;
+    uint32_t *chosen;
+    urc_fountain_sampler sampler;
+
+    // xor of the fragments of the part at hand, its cbor and its text
+    uint8_t *mixed;
+    uint8_t *part;
+    size_t part_capacity;
+    char *text;
+    size_t text_capacity;
+} urc_ur_encoder;
+
+// ``cbor`` is copied, ``type`` as in ``ur:<type>/``
+int urc_ur_encoder_init(urc_ur_encoder *encoder, const char *type, const uint8_t *cbor, size_t cbor_len,
+                        size_t max_fragment_len);
+// the psbt is copied once, straight into the fragments, behind its crypto-psbt header
+int urc_ur_encoder_init_psbt(urc_ur_encoder *encoder, const crypto_psbt *psbt, size_t max_fragment_len);
+// the part that follows the previous one, starting from seqNum 1
+// ``part`` points into the encoder and is overwritten by the next call, it is null terminated
+int urc_ur_encoder_next_part(urc_ur_encoder *encoder, const char **part, size_t *part_len);
+// fragments the message was split into, 1 for single part URs
+uint32_t urc_ur_encoder_seq_len(const urc_ur_encoder *encoder);
+void urc_ur_encoder_free(urc_ur_encoder *encoder);
+
+#ifdef __cplusplus
+}
+#endif
@@ -29,8 +29,19 @@ typedef struct {
     uint8_t *encrypted_data;
 } jade_bip8539_response;
 
+typedef struct {
+    // public key of the ephemeral key used to encrypt the response
+    uint8_t pubkey[CRYPTO_ECKEY_PUBLIC_COMPRESSED_SIZE];
+    // length of the encrypted data
+    size_t encrypted_len;
+    const uint8_t *encrypted_data;
+} jade_bip8539_response_view;
+
 // ``response`` must be freed by caller using urc_jade_bip8539_response_free
 int urc_jade_bip8539_response_deserialize(const uint8_t *cbor_buffer, size_t cbor_len, jade_bip8539_response *response);
+// zero-copy variant: ``response->encrypted_data`` points into ``cbor_buffer`` and is valid as long as ``cbor_buffer`` lives
+int urc_jade_bip8539_response_deserialize_borrowed(const uint8_t *cbor_buffer, size_t cbor_len,
+                                                   jade_bip8539_response_view *response);
 int urc_jade_bip8539_request_serialize(const jade_bip8539_request *request, uint8_t **cbor_out, size_t *cbor_len);
 void urc_jade_bip8539_response_free(jade_bip8539_response *response);
 
@@ -0,0 +1,68 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "urc/crypto_account.h"
+#include "urc/derive.h"
+
+// watch-only set of the scriptPubKeys an account can produce, for block and mempool scanning
+// every descriptor the script deriver handles contributes the first ``gap_limit`` indexes of each of its chains,
+// the others (e.g. multisig) are left out
+// marking an index as used extends its chain so that ``gap_limit`` unused indexes always follow the highest used one
+// lookups never allocate, a single index may be looked up from several threads as long as it is not being extended
+
+typedef struct {
+    // position of the descriptor in the account
+    size_t descriptor;
+    uint32_t chain;
+    uint32_t index;
+} urc_script_index_hit;
+
+typedef struct {
+    urc_script_deriver deriver;
+    size_t descriptor;
+    // scripts of indexes [0, derived) are in the set, for every chain
+    uint32_t derived[URC_SCRIPT_DERIVER_MAX_CHAINS];
+} urc_script_index_source;
+
+typedef struct {
+    urc_script_index_source *sources;
+    size_t sources_count;
+    uint32_t gap_limit;
+    // threads used to derive new scripts, as in urc_script_deriver_derive
+    size_t threads;
+
+    // entries, in derivation order
+    urc_scriptpubkey *scripts;
+    urc_script_index_hit *hits;
+    size_t entries_count;
+    size_t entries_capacity;
+
+    // open addressing, linear probing: script hash << 32 | (entry + 1), 0 when empty
+    uint64_t *slots;
+    size_t slots_mask;
+} urc_script_index;
+
+// URC_EUNHANDLEDCASE is returned when no descriptor of the account can be derived
+// ``index`` must be released with urc_script_index_free
+int urc_script_index_init(urc_script_index *index, const crypto_account *account, uint32_t gap_limit, size_t threads);
+int urc_script_index_init_unbounded(urc_script_index *index, const crypto_account_unbounded *account, uint32_t gap_limit,
+                                    size_t threads);
+
+bool urc_script_index_lookup(const urc_script_index *index, const uint8_t *script, size_t script_len,
+                             urc_script_index_hit *hit);
+
+// ``used`` is usually a hit returned by urc_script_index_lookup
+int urc_script_index_mark_used(urc_script_index *index, const urc_script_index_hit *used);
+
+void urc_script_index_free(urc_script_index *index);
+
+#ifdef __cplusplus
+}
+#endif
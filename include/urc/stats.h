@@ -0,0 +1,90 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// allocation counters of the calling thread, to measure what a single call costs:
+//     urc_stats_reset();
+//     urc_crypto_account_format(...);
+//     urc_stats_get(&stats);
+// work a call spreads over several threads (parallel formatting, batches) is counted on the calling thread
+// only available when the library is configured with -DURC_ENABLE_STATS=ON, every counter stays 0 otherwise
+// counting stores the size of every allocation in front of it, the allocator sees requests that much larger
+typedef struct {
+    uint64_t allocs;
+    uint64_t frees;
+    uint64_t bytes_allocated;
+    // bytes allocated and not freed yet, and the highest value it reached, both counted from the last reset
+    // releasing memory allocated before the reset doesn't take them below 0
+    uint64_t live_bytes;
+    uint64_t peak_live_bytes;
+    // extra rounds of the grow-and-retry loops, each one a buffer that turned out too small and was freed
+    uint64_t retries;
+} urc_stats;
+
+bool urc_stats_enabled(void);
+void urc_stats_get(urc_stats *out);
+void urc_stats_reset(void);
+
+// where decoding and formatting time goes, per type and per phase
+// only available when the library is configured with -DURC_ENABLE_TRACING=ON, snapshots are all 0 otherwise
+// every thread records into histograms of its own, without locks, a snapshot sums those of every thread
+// counters only grow: the difference of two snapshots covers the time between them
+// where <sys/sdt.h> is available every span also fires the USDT probe urc:span(type, phase, ns), to attach to with
+// perf or bpftrace, e.g. bpftrace -e 'usdt:/path/to/binary:urc:span { @[arg0, arg1] = hist(arg2); }'
+typedef enum {
+    // outside of any decoder or formatter, e.g. script derivation
+    urc_trace_type_other,
+    urc_trace_type_crypto_seed,
+    urc_trace_type_crypto_psbt,
+    urc_trace_type_crypto_eckey,
+    urc_trace_type_crypto_hdkey,
+    urc_trace_type_crypto_output,
+    urc_trace_type_crypto_account,
+    urc_trace_type_jade_account,
+    urc_trace_type_jade_bip8539_response,
+    urc_trace_type_jade_rpc,
+    urc_trace_types_count,
+} urc_trace_type;
+
+// phases nest: a decode span includes the validation and key copies it made, what remains is walking the maps
+typedef enum {
+    // a whole urc_*_deserialize call
+    urc_trace_phase_decode,
+    // tinycbor's validation of the payload, under the strict validation profile
+    urc_trace_phase_validate,
+    // fixed size byte strings (keys, chain codes, scripts) copied out of the payload
+    urc_trace_phase_key_copy,
+    // wally's BIP32 key setup
+    urc_trace_phase_bip32_init,
+    // base58check encoding of an extended key
+    urc_trace_phase_base58,
+    // a whole urc_*_format call
+    urc_trace_phase_format,
+    urc_trace_phases_count,
+} urc_trace_phase;
+
+// buckets[b] counts the spans that took [2^b, 2^(b+1)) ns, the first one includes 0 and the last one everything longer
+#define URC_TRACE_BUCKETS 32
+
+typedef struct {
+    uint64_t count;
+    uint64_t total_ns;
+    uint64_t max_ns;
+    uint64_t buckets[URC_TRACE_BUCKETS];
+} urc_trace_histogram;
+
+typedef struct {
+    urc_trace_histogram histograms[urc_trace_types_count][urc_trace_phases_count];
+} urc_trace_snapshot;
+
+bool urc_tracing_enabled(void);
+int urc_stats_snapshot(urc_trace_snapshot *out);
+
+#ifdef __cplusplus
+}
+#endif
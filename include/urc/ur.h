@@ -0,0 +1,57 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "urc/batch.h"
+#include "urc/core.h"
+#include "urc/crypto_account.h"
+#include "urc/crypto_eckey.h"
+#include "urc/crypto_hdkey.h"
+#include "urc/crypto_output.h"
+#include "urc/crypto_psbt.h"
+#include "urc/crypto_seed.h"
+
+// https://github.com/BlockchainCommons/Research/blob/master/papers/bcr-2020-005-ur.md
+// single part ``ur:<type>/<bytewords>`` strings, upper or lower case (as in QR codes)
+// bytewords may be minimal (``aeadao...``), standard (``able acid also ...``) or uri (``able-acid-also-...``)
+
+// an upper bound of the cbor message length carried by a ``ur_len`` characters UR
+size_t urc_ur_decoded_max_len(size_t ur_len);
+
+// ``type`` is set to the UR type, pointing into ``ur``, the cbor message is written to ``out``
+// returns URC_EUNKNOWNFORMAT for malformed strings, URC_EINVALIDCHECKSUM when the CRC32 doesn't match,
+// URC_EUNHANDLEDCASE for multipart URs (see urc_ur_decoder) and URC_EBUFFERTOOSMALL if the message doesn't fit in
+// ``out_capacity`` bytes
+int urc_ur_decode(const char *ur, size_t ur_len, urc_text_view *type, uint8_t *out, size_t out_capacity, size_t *out_len);
+
+// the deserializer matching a UR type, URC_EUNIMPLEMENTEDURTYPE for types the library doesn't handle
+int urc_ur_type_lookup(const char *type, size_t type_len, urc_batch_type *out);
+
+typedef struct {
+    urc_batch_type type;
+    union {
+        crypto_seed seed;
+        // borrowed, pointing into the decoding buffer
+        crypto_psbt_view psbt;
+        crypto_eckey eckey;
+        crypto_hdkey hdkey;
+        crypto_output output;
+        crypto_account account;
+    } value;
+} urc_ur_object;
+
+// decodes ``ur`` into ``buffer`` and deserializes the message in place with the deserializer of its type
+// ``buffer`` must outlive ``out``: psbts and text views point into it
+int urc_ur_deserialize(const char *ur, size_t ur_len, uint8_t *buffer, size_t buffer_len, urc_ur_object *out);
+// same as urc_ur_deserialize, under ``profile`` whatever the calling thread's validation profile
+int urc_ur_deserialize_with_profile(const char *ur, size_t ur_len, uint8_t *buffer, size_t buffer_len,
+                                    urc_validation_profile profile, urc_ur_object *out);
+
+#ifdef __cplusplus
+}
+#endif
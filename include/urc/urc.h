@@ -1,5 +1,7 @@
 #pragma once
 
+#include "urc/allocator.h"
+#include "urc/batch.h"
 #include "urc/core.h"
 #include "urc/crypto_account.h"
 #include "urc/crypto_eckey.h"
@@ -7,7 +9,12 @@
 #include "urc/crypto_output.h"
 #include "urc/crypto_psbt.h"
 #include "urc/crypto_seed.h"
+#include "urc/derive.h"
 #include "urc/error.h"
+#include "urc/fountain.h"
 #include "urc/jade_bip8539.h"
 #include "urc/jade_rpc.h"
+#include "urc/script_index.h"
+#include "urc/stats.h"
 #include "urc/tags.h"
+#include "urc/ur.h"
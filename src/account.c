@@ -1,123 +1,524 @@
 
+#include <string.h>
+
 #include "wally_core.h"
 
+#include "urc/allocator.h"
 #include "urc/core.h"
 #include "urc/crypto_account.h"
 #include "urc/tags.h"
 
 #include "internals.h"
 #include "macros.h"
+#include "parallel.h"
+#include "schema.h"
+#include "stats.h"
+#include "trace.h"
 #include "utils.h"
 
 int urc_crypto_account_deserialize_impl(CborValue *iter, crypto_account *out);
 
 int urc_crypto_account_deserialize(const uint8_t *buffer, size_t len, crypto_account *out)
 {
+    return urc_crypto_account_deserialize_with_profile(buffer, len, out, urc_get_thread_validation_profile());
+}
+
+int urc_crypto_account_deserialize_with_profile(const uint8_t *buffer, size_t len, crypto_account *out,
+                                                urc_validation_profile profile)
+{
+    trace_span span = trace_begin(urc_trace_type_crypto_account, urc_trace_phase_decode);
     CborParser parser;
     CborValue iter;
+    int result = init_cbor_parser(buffer, len, profile, &parser, &iter);
+    if (result == URC_OK) {
+        result = urc_crypto_account_deserialize_impl(&iter, out);
+    }
+    trace_end(&span);
+    return result;
+}
+
+// smallest descriptor the parser accepts: a raw script, its tag and a 32 bytes byte string
+// taproot descriptors are skipped without being parsed, a valid one holds a key that is larger still
+#define DESCRIPTOR_MIN_ENCODED_LEN (3 + 2 + URC_RAWSCRIPT_LEN)
+// tag 308 introducing each descriptor in crypto-account
+#define DESCRIPTOR_TAG_ENCODED_LEN 3
+
+typedef struct {
+    // descriptors are introduced by tag 308 in crypto-account, not in jade's format
+    bool tagged;
+    bool taproot_found;
+    // bounds what an array header can claim, see DESCRIPTOR_MIN_ENCODED_LEN
+    size_t max_count;
+} descriptors_ctx;
+
+// parses ``limit`` elements of the array ``array_item`` is in, taproot descriptors are skipped
+static int parse_descriptors(CborValue *array_item, size_t limit, crypto_output *descriptors, size_t *count,
+                             descriptors_ctx *ctx)
+{
+    int result = URC_OK;
     CborError err;
-    err = cbor_parser_init(buffer, len, cbor_flags, &parser, &iter);
-    if (err != CborNoError) {
-        return URC_ECBORINTERNALERROR;
+    size_t item_idx = 0;
+    for (size_t parser_idx = 0; parser_idx < limit; parser_idx++) {
+        if (ctx->tagged) {
+            result = check_tag(array_item, urc_urtypes_tags_crypto_output);
+            if (result != URC_OK) {
+                goto exit;
+            }
+            ADVANCE(array_item, result, exit);
+        }
+        result = urc_crypto_output_deserialize_impl(array_item, &descriptors[item_idx++]);
+        // // WARNING: taproot not yet supported, skipping it
+        if (result == URC_ETAPROOTNOTSUPPORTED) {
+            ctx->taproot_found = true;
+            item_idx--;
+            result = URC_OK;
+            while (cbor_value_at_end(array_item) == false) {
+                if (cbor_value_is_tag(array_item)) {
+                    CborTag tmp_tag;
+                    err = cbor_value_get_tag(array_item, &tmp_tag);
+                    CHECK_CBOR_ERROR(err, result, exit);
+                    if (tmp_tag == urc_urtypes_tags_crypto_output) {
+                        break;
+                    }
+                }
+                ADVANCE(array_item, result, exit);
+            }
+        } else if (result != URC_OK) {
+            goto exit;
+        }
     }
-    return urc_crypto_account_deserialize_impl(&iter, out);
+
+exit:
+    *count = item_idx;
+    return result;
 }
 
-int urc_crypto_account_deserialize_impl(CborValue *iter, crypto_account *out)
+static int descriptors_parse(CborValue *value, void *out, void *ctx)
 {
+    crypto_account *account = out;
     int result = URC_OK;
-    out->descriptors_count = 0;
-    bool taproot_found = false;
 
-    CHECK_IS_TYPE(iter, map, result, exit);
-    CborValue map_item;
-    CborError err = cbor_value_enter_container(iter, &map_item);
+    CHECK_IS_TYPE(value, array, result, exit);
+    size_t len;
+    CborError err = cbor_value_get_array_length(value, &len);
     CHECK_CBOR_ERROR(err, result, exit);
-
-    result = check_map_key(&map_item, 1);
-    if (result != URC_OK) {
-        goto exit;
-    }
-    ADVANCE(&map_item, result, exit);
-    CHECK_IS_TYPE(&map_item, unsigned_integer, result, exit);
-    err = cbor_value_get_int(&map_item, (int *)&out->master_fingerprint);
+    CborValue array_item;
+    err = cbor_value_enter_container(value, &array_item);
     CHECK_CBOR_ERROR(err, result, exit);
-    ADVANCE(&map_item, result, exit);
 
-    result = check_map_key(&map_item, 2);
+    size_t limit = DESCRIPTORS_MAX_SIZE > len ? len : DESCRIPTORS_MAX_SIZE;
+    result = parse_descriptors(&array_item, limit, account->descriptors, &account->descriptors_count, ctx);
     if (result != URC_OK) {
         goto exit;
     }
-    ADVANCE(&map_item, result, exit);
-    CHECK_IS_TYPE(&map_item, array, result, exit);
+    LEAVE_CONTAINER_SAFELY(value, &array_item, result, exit);
+
+exit:
+    return result;
+}
+
+static int unbounded_descriptors_parse(CborValue *value, void *out, void *ctx)
+{
+    crypto_account_unbounded *account = out;
+    descriptors_ctx *descriptors = ctx;
+    int result = URC_OK;
+
+    CHECK_IS_TYPE(value, array, result, exit);
     size_t len;
-    err = cbor_value_get_array_length(&map_item, &len);
+    CborError err = cbor_value_get_array_length(value, &len);
     CHECK_CBOR_ERROR(err, result, exit);
+    if (len > descriptors->max_count || len > SIZE_MAX / sizeof(crypto_output)) {
+        result = URC_EUNKNOWNFORMAT;
+        goto exit;
+    }
     CborValue array_item;
-    err = cbor_value_enter_container(&map_item, &array_item);
+    err = cbor_value_enter_container(value, &array_item);
     CHECK_CBOR_ERROR(err, result, exit);
 
-    int limit = DESCRIPTORS_MAX_SIZE > len ? len : DESCRIPTORS_MAX_SIZE;
-    int item_idx = 0;
-    for (int parser_idx = 0; parser_idx < limit; parser_idx++) {
-        result = check_tag(&array_item, urc_urtypes_tags_crypto_output);
-        if (result != URC_OK) {
+    if (len > 0) {
+        account->descriptors = urc_malloc(len * sizeof(crypto_output));
+        if (!account->descriptors) {
+            result = URC_ENOMEM;
             goto exit;
         }
-        ADVANCE(&array_item, result, exit);
-        result = urc_crypto_output_deserialize_impl(&array_item, &out->descriptors[item_idx++]);
-        // // WARNING: taproot not yet supported, skipping it
-        if (result == URC_ETAPROOTNOTSUPPORTED) {
-            taproot_found = true;
-            item_idx--;
-            result = URC_OK;
-            while (cbor_value_at_end(&array_item) == false) {
-                if (cbor_value_is_tag(&array_item)) {
-                    CborTag tmp_tag;
-                    err = cbor_value_get_tag(&array_item, &tmp_tag);
-                    CHECK_CBOR_ERROR(err, result, exit);
-                    if (tmp_tag == urc_urtypes_tags_crypto_output) {
-                        break;
-                    }
-                }
-                ADVANCE(&array_item, result, exit);
-            }
-        } else if (result != URC_OK) {
+    }
+    result = parse_descriptors(&array_item, len, account->descriptors, &account->descriptors_count, ctx);
+    if (result != URC_OK) {
+        goto exit;
+    }
+    LEAVE_CONTAINER_SAFELY(value, &array_item, result, exit);
+
+    // skipped taproot descriptors leave unused entries behind
+    if (account->descriptors_count < len) {
+        crypto_output *descriptors = NULL;
+        if (account->descriptors_count > SIZE_MAX / sizeof(crypto_output)) {
+            result = URC_EUNKNOWNFORMAT;
             goto exit;
         }
+        if (account->descriptors_count > 0) {
+            descriptors = urc_malloc(account->descriptors_count * sizeof(crypto_output));
+            if (!descriptors) {
+                result = URC_ENOMEM;
+                goto exit;
+            }
+            memcpy(descriptors, account->descriptors, account->descriptors_count * sizeof(crypto_output));
+        }
+        wally_bzero(account->descriptors, len * sizeof(crypto_output));
+        urc_free(account->descriptors);
+        account->descriptors = descriptors;
     }
-    out->descriptors_count = item_idx;
-    LEAVE_CONTAINER_SAFELY(&map_item, &array_item, result, exit);
-
-    LEAVE_CONTAINER_SAFELY(iter, &map_item, result, exit);
 
 exit:
-    if (result == URC_OK && taproot_found) {
+    return result;
+}
+
+static const schema_field account_fields[] = {
+    {.key = 1, .kind = schema_kind_uint32, .offset = offsetof(crypto_account, master_fingerprint)},
+    {.key = 2, .kind = schema_kind_custom, .parse = descriptors_parse},
+};
+static const schema account_schema = SCHEMA(account_fields);
+
+static const schema_field unbounded_account_fields[] = {
+    {.key = 1, .kind = schema_kind_uint32, .offset = offsetof(crypto_account_unbounded, master_fingerprint)},
+    {.key = 2, .kind = schema_kind_custom, .parse = unbounded_descriptors_parse},
+};
+static const schema unbounded_account_schema = SCHEMA(unbounded_account_fields);
+
+int urc_account_deserialize_impl(CborValue *iter, crypto_account *out, bool tagged_descriptors)
+{
+    out->descriptors_count = 0;
+    descriptors_ctx ctx = {.tagged = tagged_descriptors, .taproot_found = false, .max_count = SIZE_MAX};
+    int result = schema_decode_map(&account_schema, iter, out, &ctx);
+    if (result == URC_OK && ctx.taproot_found) {
         result = URC_ETAPROOTNOTSUPPORTED;
     }
     return result;
 }
 
-int urc_crypto_account_format(const crypto_account *account, urc_crypto_output_format_mode mode, char **out[])
+int urc_account_unbounded_deserialize_impl(CborValue *iter, size_t cbor_len, crypto_account_unbounded *out,
+                                           bool tagged_descriptors)
 {
-    if (!account || !out) {
+    out->descriptors = NULL;
+    out->descriptors_count = 0;
+    size_t min_len = DESCRIPTOR_MIN_ENCODED_LEN + (tagged_descriptors ? DESCRIPTOR_TAG_ENCODED_LEN : 0);
+    descriptors_ctx ctx = {.tagged = tagged_descriptors, .taproot_found = false, .max_count = cbor_len / min_len};
+    int result = schema_decode_map(&unbounded_account_schema, iter, out, &ctx);
+    if (result != URC_OK) {
+        urc_crypto_account_unbounded_free(out);
+        return result;
+    }
+    if (ctx.taproot_found) {
+        result = URC_ETAPROOTNOTSUPPORTED;
+    }
+    return result;
+}
+
+int urc_crypto_account_deserialize_impl(CborValue *iter, crypto_account *out)
+{
+    return urc_account_deserialize_impl(iter, out, true);
+}
+
+int urc_crypto_account_unbounded_deserialize(const uint8_t *buffer, size_t len, crypto_account_unbounded *out)
+{
+    if (!out) {
         return URC_EINVALIDARG;
     }
+    out->descriptors = NULL;
+    out->descriptors_count = 0;
+
+    trace_span span = trace_begin(urc_trace_type_crypto_account, urc_trace_phase_decode);
+    CborParser parser;
+    CborValue iter;
+    int result = init_cbor_parser(buffer, len, urc_get_thread_validation_profile(), &parser, &iter);
+    if (result == URC_OK) {
+        result = urc_account_unbounded_deserialize_impl(&iter, len, out, true);
+    }
+    trace_end(&span);
+    return result;
+}
+
+// crypto-account, descriptors introduced by tag 308
+static int account_serialize(CborEncoder *encoder, uint32_t master_fingerprint, const crypto_output *descriptors,
+                             size_t count)
+{
+    int result = URC_OK;
+    CborEncoder map;
+    CborError err = cbor_encoder_create_map(encoder, &map, 2);
+    CHECK_CBOR_ENCODE_ERROR(err, result, exit);
+    err = cbor_encode_uint(&map, 1);
+    CHECK_CBOR_ENCODE_ERROR(err, result, exit);
+    err = cbor_encode_uint(&map, master_fingerprint);
+    CHECK_CBOR_ENCODE_ERROR(err, result, exit);
+    err = cbor_encode_uint(&map, 2);
+    CHECK_CBOR_ENCODE_ERROR(err, result, exit);
+    CborEncoder array;
+    err = cbor_encoder_create_array(&map, &array, count);
+    CHECK_CBOR_ENCODE_ERROR(err, result, exit);
+    for (size_t idx = 0; idx < count; idx++) {
+        err = cbor_encode_tag(&array, urc_urtypes_tags_crypto_output);
+        CHECK_CBOR_ENCODE_ERROR(err, result, exit);
+        result = urc_crypto_output_serialize_impl(&array, &descriptors[idx]);
+        if (result != URC_OK) {
+            goto exit;
+        }
+    }
+    err = cbor_encoder_close_container(&map, &array);
+    CHECK_CBOR_ENCODE_ERROR(err, result, exit);
+    err = cbor_encoder_close_container(encoder, &map);
+    CHECK_CBOR_ENCODE_ERROR(err, result, exit);
 
-    size_t array_size = sizeof(char *) * (account->descriptors_count + 1);
-    *out = wally_malloc(array_size);
+exit:
+    return result;
+}
+
+static int bounded_account_serialize(CborEncoder *encoder, const void *in)
+{
+    const crypto_account *account = in;
+    if (account->descriptors_count > DESCRIPTORS_MAX_SIZE) {
+        return URC_EINVALIDARG;
+    }
+    return account_serialize(encoder, account->master_fingerprint, account->descriptors, account->descriptors_count);
+}
+
+static int unbounded_account_serialize(CborEncoder *encoder, const void *in)
+{
+    const crypto_account_unbounded *account = in;
+    if (account->descriptors_count && !account->descriptors) {
+        return URC_EINVALIDARG;
+    }
+    return account_serialize(encoder, account->master_fingerprint, account->descriptors, account->descriptors_count);
+}
+
+int urc_crypto_account_serialize(const crypto_account *account, uint8_t **cbor_out, size_t *cbor_len)
+{
+    if (!account || !cbor_out || !cbor_len) {
+        return URC_EINVALIDARG;
+    }
+    return serialize_alloc(bounded_account_serialize, account, cbor_out, cbor_len);
+}
+
+int urc_crypto_account_serialize_to_buffer(const crypto_account *account, uint8_t *out, size_t out_len, size_t *cbor_len)
+{
+    if (!account || (!out && out_len) || !cbor_len) {
+        return URC_EINVALIDARG;
+    }
+    return serialize_to_buffer(bounded_account_serialize, account, out, out_len, cbor_len);
+}
+
+int urc_crypto_account_unbounded_serialize(const crypto_account_unbounded *account, uint8_t **cbor_out, size_t *cbor_len)
+{
+    if (!account || !cbor_out || !cbor_len) {
+        return URC_EINVALIDARG;
+    }
+    return serialize_alloc(unbounded_account_serialize, account, cbor_out, cbor_len);
+}
+
+int urc_crypto_account_unbounded_serialize_to_buffer(const crypto_account_unbounded *account, uint8_t *out, size_t out_len,
+                                                     size_t *cbor_len)
+{
+    if (!account || (!out && out_len) || !cbor_len) {
+        return URC_EINVALIDARG;
+    }
+    return serialize_to_buffer(unbounded_account_serialize, account, out, out_len, cbor_len);
+}
+
+size_t urc_crypto_account_unbounded_count(const crypto_account_unbounded *account)
+{
+    return account ? account->descriptors_count : 0;
+}
+
+const crypto_output *urc_crypto_account_unbounded_descriptor(const crypto_account_unbounded *account, size_t idx)
+{
+    if (!account || idx >= account->descriptors_count) {
+        return NULL;
+    }
+    return &account->descriptors[idx];
+}
+
+void urc_crypto_account_unbounded_free(crypto_account_unbounded *account)
+{
+    if (account) {
+        if (account->descriptors) {
+            wally_bzero(account->descriptors, account->descriptors_count * sizeof(crypto_output));
+        }
+        urc_free(account->descriptors);
+        account->descriptors = NULL;
+        account->descriptors_count = 0;
+    }
+}
+
+static int format_descriptors(const crypto_output *descriptors, size_t count, urc_crypto_output_format_mode mode,
+                              char **out[])
+{
+    trace_span span = trace_begin(urc_trace_type_crypto_account, urc_trace_phase_format);
+    int result = URC_OK;
+    size_t array_size = sizeof(char *) * (count + 1);
+    *out = urc_malloc(array_size);
     if (!*out) {
-        return URC_ENOMEM;
+        result = URC_ENOMEM;
+        goto exit;
     }
-    (*out)[account->descriptors_count] = NULL;
+    (*out)[count] = NULL;
 
-    for (size_t idx = 0; idx < account->descriptors_count; idx++) {
-        int result = urc_crypto_output_format(&account->descriptors[idx], mode, &(*out)[idx]);
+    for (size_t idx = 0; idx < count; idx++) {
+        // the array is freed up to the first NULL entry
+        (*out)[idx] = NULL;
+        result = urc_crypto_output_format(&descriptors[idx], mode, &(*out)[idx]);
         if (result != URC_OK) {
+            (*out)[idx] = NULL;
             urc_string_array_free(*out);
             *out = NULL;
-            return result;
+            goto exit;
+        }
+    }
+
+exit:
+    trace_end(&span);
+    return result;
+}
+
+typedef struct {
+    const crypto_output *descriptors;
+    urc_crypto_output_format_mode mode;
+    const urc_allocator *allocator;
+    stats_counters *stats;
+    char **out;
+    int *results;
+} format_job;
+
+static void format_task(void *ctx, size_t idx)
+{
+    format_job *job = ctx;
+    // strings are released by the caller, they must come from its allocator whatever thread runs the task
+    const urc_allocator *previous = urc_set_thread_allocator(job->allocator);
+    stats_counters *previous_stats = stats_set_thread_counters(job->stats);
+    job->results[idx] = urc_crypto_output_format(&job->descriptors[idx], job->mode, &job->out[idx]);
+    stats_set_thread_counters(previous_stats);
+    urc_set_thread_allocator(previous);
+}
+
+// either ``executor`` or ``threads`` runs the job
+static int format_descriptors_concurrently(const crypto_output *descriptors, size_t count,
+                                           urc_crypto_output_format_mode mode, const urc_executor *executor,
+                                           size_t threads, char **out[])
+{
+    trace_span span = trace_begin(urc_trace_type_crypto_account, urc_trace_phase_format);
+    int result = URC_OK;
+    *out = urc_malloc(sizeof(char *) * (count + 1));
+    int *results = urc_malloc(sizeof(int) * (count + 1));
+    if (!*out || !results) {
+        urc_free(results);
+        urc_free(*out);
+        *out = NULL;
+        result = URC_ENOMEM;
+        goto exit;
+    }
+    for (size_t idx = 0; idx <= count; idx++) {
+        (*out)[idx] = NULL;
+        results[idx] = URC_OK;
+    }
+
+    format_job job = {
+        .descriptors = descriptors,
+        .mode = mode,
+        .allocator = urc_get_thread_allocator(),
+        .stats = stats_thread_counters(),
+        .out = *out,
+        .results = results,
+    };
+    if (executor) {
+        executor->run(executor->ctx, count, format_task, &job);
+    } else {
+        result = urc_parallel_for(count, threads, format_task, &job);
+    }
+    for (size_t idx = 0; idx < count && result == URC_OK; idx++) {
+        result = results[idx];
+    }
+    urc_free(results);
+
+    if (result != URC_OK) {
+        // any entry may be missing, free them one by one
+        for (size_t idx = 0; idx < count; idx++) {
+            urc_string_free((*out)[idx]);
         }
+        urc_free(*out);
+        *out = NULL;
+    }
+
+exit:
+    trace_end(&span);
+    return result;
+}
+
+int urc_crypto_account_format(const crypto_account *account, urc_crypto_output_format_mode mode, char **out[])
+{
+    if (!account || !out) {
+        return URC_EINVALIDARG;
+    }
+    return format_descriptors(account->descriptors, account->descriptors_count, mode, out);
+}
+
+int urc_crypto_account_format_to_buffer(const crypto_account *account, size_t idx, urc_crypto_output_format_mode mode,
+                                        char *out, size_t out_len, size_t *descriptor_len)
+{
+    if (!account || idx >= account->descriptors_count) {
+        return URC_EINVALIDARG;
+    }
+    return urc_crypto_output_format_to_buffer(&account->descriptors[idx], mode, out, out_len, descriptor_len);
+}
+
+int urc_crypto_account_unbounded_format_to_buffer(const crypto_account_unbounded *account, size_t idx,
+                                                  urc_crypto_output_format_mode mode, char *out, size_t out_len,
+                                                  size_t *descriptor_len)
+{
+    if (!account || idx >= account->descriptors_count) {
+        return URC_EINVALIDARG;
+    }
+    return urc_crypto_output_format_to_buffer(&account->descriptors[idx], mode, out, out_len, descriptor_len);
+}
+
+int urc_crypto_account_unbounded_format(const crypto_account_unbounded *account, urc_crypto_output_format_mode mode,
+                                        char **out[])
+{
+    if (!account || !out) {
+        return URC_EINVALIDARG;
+    }
+    return format_descriptors(account->descriptors, account->descriptors_count, mode, out);
+}
+
+int urc_crypto_account_format_parallel(const crypto_account *account, urc_crypto_output_format_mode mode, size_t threads,
+                                       char **out[])
+{
+    if (!account || !out) {
+        return URC_EINVALIDARG;
+    }
+    return format_descriptors_concurrently(account->descriptors, account->descriptors_count, mode, NULL, threads, out);
+}
+
+int urc_crypto_account_format_with_executor(const crypto_account *account, urc_crypto_output_format_mode mode,
+                                            const urc_executor *executor, char **out[])
+{
+    if (!account || !executor || !executor->run || !out) {
+        return URC_EINVALIDARG;
+    }
+    return format_descriptors_concurrently(account->descriptors, account->descriptors_count, mode, executor, 0, out);
+}
+
+int urc_crypto_account_unbounded_format_parallel(const crypto_account_unbounded *account, urc_crypto_output_format_mode mode,
+                                                 size_t threads, char **out[])
+{
+    if (!account || !out) {
+        return URC_EINVALIDARG;
+    }
+    return format_descriptors_concurrently(account->descriptors, account->descriptors_count, mode, NULL, threads, out);
+}
+
+int urc_crypto_account_unbounded_format_with_executor(const crypto_account_unbounded *account,
+                                                      urc_crypto_output_format_mode mode, const urc_executor *executor,
+                                                      char **out[])
+{
+    if (!account || !executor || !executor->run || !out) {
+        return URC_EINVALIDARG;
     }
-    return URC_OK;
+    return format_descriptors_concurrently(account->descriptors, account->descriptors_count, mode, executor, 0, out);
 }
@@ -0,0 +1,122 @@
+#include <stdalign.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "wally_core.h"
+
+#include "urc/allocator.h"
+
+#include "stats.h"
+#include "utils.h"
+
+static void *default_malloc(void *ctx, size_t size)
+{
+    (void)ctx;
+    return wally_malloc(size);
+}
+
+static void default_free(void *ctx, void *ptr)
+{
+    (void)ctx;
+    wally_free(ptr);
+}
+
+static const urc_allocator default_allocator = {
+    .malloc = default_malloc,
+    .free = default_free,
+    .ctx = NULL,
+};
+
+static _Thread_local const urc_allocator *thread_allocator = NULL;
+
+const urc_allocator *urc_set_thread_allocator(const urc_allocator *allocator)
+{
+    const urc_allocator *previous = urc_get_thread_allocator();
+    thread_allocator = allocator;
+    return previous;
+}
+
+const urc_allocator *urc_get_thread_allocator(void) { return thread_allocator ? thread_allocator : &default_allocator; }
+
+void *urc_malloc(size_t size)
+{
+    const urc_allocator *allocator = urc_get_thread_allocator();
+#if URC_ENABLE_STATS
+    if (size > SIZE_MAX - STATS_HEADER_LEN) {
+        return NULL;
+    }
+    uint8_t *block = allocator->malloc(allocator->ctx, STATS_HEADER_LEN + size);
+    if (!block) {
+        return NULL;
+    }
+    memcpy(block, &size, sizeof(size));
+    stats_record_malloc(size);
+    return block + STATS_HEADER_LEN;
+#else
+    return allocator->malloc(allocator->ctx, size);
+#endif
+}
+
+void urc_free(void *ptr)
+{
+    if (!ptr) {
+        return;
+    }
+    const urc_allocator *allocator = urc_get_thread_allocator();
+#if URC_ENABLE_STATS
+    uint8_t *block = (uint8_t *)ptr - STATS_HEADER_LEN;
+    size_t size;
+    memcpy(&size, block, sizeof(size));
+    stats_record_free(size);
+    ptr = block;
+#endif
+    allocator->free(allocator->ctx, ptr);
+}
+
+#define ARENA_ALIGNMENT alignof(max_align_t)
+
+static void *arena_malloc(void *ctx, size_t size)
+{
+    urc_arena *arena = ctx;
+    uintptr_t base = (uintptr_t)arena->buffer;
+    uintptr_t aligned = (base + arena->used + ARENA_ALIGNMENT - 1) & ~(uintptr_t)(ARENA_ALIGNMENT - 1);
+    size_t offset = aligned - base;
+    if (offset > arena->size || size > arena->size - offset) {
+        return NULL;
+    }
+    arena->last = offset;
+    arena->used = offset + size;
+    return arena->buffer + offset;
+}
+
+static void arena_free(void *ctx, void *ptr)
+{
+    urc_arena *arena = ctx;
+    if ((uint8_t *)ptr == arena->buffer + arena->last) {
+        arena->used = arena->last;
+    }
+}
+
+void urc_arena_init(urc_arena *arena, void *buffer, size_t size)
+{
+    arena->buffer = buffer;
+    arena->size = size;
+    urc_arena_reset(arena);
+}
+
+void urc_arena_reset(urc_arena *arena)
+{
+    arena->used = 0;
+    arena->last = 0;
+}
+
+urc_allocator urc_arena_allocator(urc_arena *arena)
+{
+    urc_allocator allocator = {
+        .malloc = arena_malloc,
+        .free = arena_free,
+        .ctx = arena,
+    };
+    return allocator;
+}
@@ -0,0 +1,63 @@
+#include "urc/batch.h"
+#include "urc/crypto_account.h"
+#include "urc/crypto_eckey.h"
+#include "urc/crypto_hdkey.h"
+#include "urc/crypto_output.h"
+#include "urc/crypto_psbt.h"
+#include "urc/crypto_seed.h"
+#include "urc/jade_bip8539.h"
+#include "urc/jade_rpc.h"
+
+#include "internals.h"
+#include "parallel.h"
+
+int urc_deserialize_with_profile(urc_batch_type type, const uint8_t *cbor_buffer, size_t cbor_len, void *out,
+                                 urc_validation_profile profile)
+{
+    if (!out) {
+        return URC_EINVALIDARG;
+    }
+    switch (type) {
+    case urc_batch_type_crypto_seed:
+        return urc_crypto_seed_deserialize_with_profile(cbor_buffer, cbor_len, out, profile);
+    case urc_batch_type_crypto_psbt:
+        return urc_crypto_psbt_deserialize_with_profile(cbor_buffer, cbor_len, out, profile);
+    case urc_batch_type_crypto_eckey:
+        return urc_crypto_eckey_deserialize_with_profile(cbor_buffer, cbor_len, out, profile);
+    case urc_batch_type_crypto_hdkey:
+        return urc_crypto_hdkey_deserialize_with_profile(cbor_buffer, cbor_len, out, profile);
+    case urc_batch_type_crypto_output:
+        return urc_crypto_output_deserialize_with_profile(cbor_buffer, cbor_len, out, profile);
+    case urc_batch_type_crypto_account:
+        return urc_crypto_account_deserialize_with_profile(cbor_buffer, cbor_len, out, profile);
+    case urc_batch_type_jade_account:
+        return urc_jade_account_deserialize_with_profile(cbor_buffer, cbor_len, out, profile);
+    case urc_batch_type_jade_bip8539_response:
+        return urc_jade_bip8539_response_deserialize_with_profile(cbor_buffer, cbor_len, out, profile);
+    case urc_batch_type_jade_rpc:
+        return urc_jade_rpc_deserialize_with_profile(cbor_buffer, cbor_len, out, profile);
+    default:
+        return URC_EINVALIDARG;
+    }
+}
+
+// workers run under the caller's validation profile, installed by urc_parallel_for
+static int batch_item_deserialize(const urc_batch_item *item)
+{
+    return urc_deserialize_with_profile(item->type, item->cbor_buffer, item->cbor_len, item->out,
+                                        urc_get_thread_validation_profile());
+}
+
+static void batch_run_item(void *ctx, size_t idx)
+{
+    urc_batch_item *items = ctx;
+    items[idx].result = batch_item_deserialize(&items[idx]);
+}
+
+int urc_batch_deserialize(urc_batch_item *items, size_t items_count, size_t threads)
+{
+    if (!items && items_count) {
+        return URC_EINVALIDARG;
+    }
+    return urc_parallel_for(items_count, threads, batch_run_item, items);
+}
@@ -5,7 +5,10 @@
 #include "urc/error.h"
 #include "urc/jade_bip8539.h"
 
+#include "internals.h"
 #include "macros.h"
+#include "stats.h"
+#include "trace.h"
 #include "utils.h"
 
 static int jade_bip8539_request_serialize_op(CborEncoder *encoder, const jade_bip8539_request *request)
@@ -36,10 +39,9 @@ static int jade_bip8539_request_serialize_op(CborEncoder *encoder, const jade_bi
     return URC_OK;
 }
 
-static int jade_bip8539_response_deserialize_op(CborValue *iter, jade_bip8539_response *out, uint8_t *buffer, size_t len)
+// copies the ephemeral public key in ``pubkey`` and points ``encrypted`` to the encrypted byte string
+static int jade_bip8539_response_lookup(CborValue *iter, uint8_t *pubkey, CborValue *encrypted)
 {
-    out->encrypted_data = NULL;
-    out->encrypted_len = 0;
     int result = URC_OK;
 
     CHECK_IS_TYPE(iter, map, result, exit)
@@ -53,16 +55,30 @@ static int jade_bip8539_response_deserialize_op(CborValue *iter, jade_bip8539_re
         goto exit;
     }
     CHECK_IS_TYPE(&element, byte_string, result, exit);
-    result = copy_fixed_size_byte_string(&element, (uint8_t *)&out->pubkey, CRYPTO_ECKEY_PUBLIC_COMPRESSED_SIZE);
+    result = copy_fixed_size_byte_string(&element, pubkey, CRYPTO_ECKEY_PUBLIC_COMPRESSED_SIZE);
     if (result != URC_OK) {
         goto exit;
     }
 
-    err = cbor_value_map_find_value(iter, "encrypted", &element);
+    err = cbor_value_map_find_value(iter, "encrypted", encrypted);
     CHECK_CBOR_ERROR(err, result, exit);
 
-    CHECK_IS_TYPE(&element, byte_string, result, exit);
-    err = cbor_value_copy_byte_string(&element, buffer, &len, NULL);
+    CHECK_IS_TYPE(encrypted, byte_string, result, exit);
+exit:
+    return result;
+}
+
+static int jade_bip8539_response_deserialize_op(CborValue *iter, jade_bip8539_response *out, uint8_t *buffer, size_t len)
+{
+    out->encrypted_data = NULL;
+    out->encrypted_len = 0;
+
+    CborValue element;
+    int result = jade_bip8539_response_lookup(iter, (uint8_t *)&out->pubkey, &element);
+    if (result != URC_OK) {
+        goto exit;
+    }
+    CborError err = cbor_value_copy_byte_string(&element, buffer, &len, NULL);
     CHECK_CBOR_ERROR(err, result, exit);
 
     out->encrypted_len = len;
@@ -85,15 +101,14 @@ static int urc_jade_bip8539_request_serialize_impl(const jade_bip8539_request *r
     return result;
 }
 
-static int urc_jade_bip8539_response_deserialize_impl(const uint8_t *cbor, size_t cbor_len, jade_bip8539_response *response,
-                                                      uint8_t *buffer, size_t buffer_len)
+static int urc_jade_bip8539_response_deserialize_impl(const uint8_t *cbor, size_t cbor_len, urc_validation_profile profile,
+                                                      jade_bip8539_response *response, uint8_t *buffer, size_t buffer_len)
 {
     CborParser parser;
     CborValue iter;
-    CborError err;
-    err = cbor_parser_init(cbor, cbor_len, cbor_flags, &parser, &iter);
-    if (err != CborNoError) {
-        return URC_ECBORINTERNALERROR;
+    int result = init_cbor_parser(cbor, cbor_len, profile, &parser, &iter);
+    if (result != URC_OK) {
+        return result;
     }
     return jade_bip8539_response_deserialize_op(&iter, response, buffer, buffer_len);
 }
@@ -107,17 +122,20 @@ int urc_jade_bip8539_request_serialize(const jade_bip8539_request *request, uint
     int result = URC_OK;
     *out = NULL;
     do {
-        wally_free(*out);
-        *out = wally_malloc(buffer_len);
+        urc_free(*out);
+        *out = urc_malloc(buffer_len);
         if (!*out) {
             return URC_ENOMEM;
         }
         *len = buffer_len;
         result = urc_jade_bip8539_request_serialize_impl(request, *out, len);
+        if (result == URC_EBUFFERTOOSMALL) {
+            stats_record_retry();
+        }
         buffer_len *= 2;
     } while (result == URC_EBUFFERTOOSMALL);
     if (result != URC_OK) {
-        wally_free(*out);
+        urc_free(*out);
         *out = NULL;
         *len = 0;
     }
@@ -125,25 +143,72 @@ int urc_jade_bip8539_request_serialize(const jade_bip8539_request *request, uint
 }
 
 int urc_jade_bip8539_response_deserialize(const uint8_t *cbor, size_t cbor_len, jade_bip8539_response *response)
+{
+    return urc_jade_bip8539_response_deserialize_with_profile(cbor, cbor_len, response, urc_get_thread_validation_profile());
+}
+
+int urc_jade_bip8539_response_deserialize_with_profile(const uint8_t *cbor, size_t cbor_len, jade_bip8539_response *response,
+                                                       urc_validation_profile profile)
 {
     response->encrypted_data = NULL;
     response->encrypted_len = 0;
+    trace_span span = trace_begin(urc_trace_type_jade_bip8539_response, urc_trace_phase_decode);
     int result = URC_OK;
     size_t buffer_len = cbor_len;
     uint8_t *buffer = NULL;
     do {
-        wally_free(buffer);
-        buffer = wally_malloc(buffer_len);
+        urc_free(buffer);
+        buffer = urc_malloc(buffer_len);
         if (!buffer) {
-            return URC_ENOMEM;
+            result = URC_ENOMEM;
+            goto exit;
+        }
+        result = urc_jade_bip8539_response_deserialize_impl(cbor, cbor_len, profile, response, buffer, buffer_len);
+        if (result == URC_EBUFFERTOOSMALL) {
+            stats_record_retry();
         }
-        result = urc_jade_bip8539_response_deserialize_impl(cbor, cbor_len, response, buffer, buffer_len);
         buffer_len *= 2;
     } while (result == URC_EBUFFERTOOSMALL);
     if (result != URC_OK) {
-        wally_free(buffer);
+        urc_free(buffer);
     }
+exit:
+    trace_end(&span);
+    return result;
+}
+
+int urc_jade_bip8539_response_deserialize_borrowed(const uint8_t *cbor, size_t cbor_len, jade_bip8539_response_view *response)
+{
+    if (!cbor || !response) {
+        return URC_EINVALIDARG;
+    }
+    response->encrypted_data = NULL;
+    response->encrypted_len = 0;
+
+    trace_span span = trace_begin(urc_trace_type_jade_bip8539_response, urc_trace_phase_decode);
+    CborParser parser;
+    CborValue iter;
+    int result = init_cbor_parser(cbor, cbor_len, urc_get_thread_validation_profile(), &parser, &iter);
+    if (result != URC_OK) {
+        goto exit;
+    }
+
+    CborValue element;
+    result = jade_bip8539_response_lookup(&iter, (uint8_t *)&response->pubkey, &element);
+    if (result != URC_OK) {
+        goto exit;
+    }
+    const uint8_t *encrypted;
+    size_t encrypted_len;
+    result = borrow_byte_string(&element, &encrypted, &encrypted_len);
+    if (result != URC_OK) {
+        goto exit;
+    }
+    response->encrypted_data = encrypted;
+    response->encrypted_len = encrypted_len;
+exit:
+    trace_end(&span);
     return result;
 }
 
-void urc_jade_bip8539_response_free(jade_bip8539_response *response) { wally_free(response->encrypted_data); }
+void urc_jade_bip8539_response_free(jade_bip8539_response *response) { urc_free(response->encrypted_data); }
@@ -0,0 +1,164 @@
+#include <stdbool.h>
+
+#include "urc/error.h"
+
+#include "bytewords.h"
+#include "crc32.h"
+
+#define CHECKSUM_LEN 4
+#define WORD_LEN 4
+
+// https://github.com/BlockchainCommons/Research/blob/master/papers/bcr-2020-012-bytewords.md
+static const char bytewords[256 * WORD_LEN + 1] =
+    "ableacidalsoapexaquaarchatomauntawayaxisbackbaldbarnbeltbetabias"
+    "bluebodybragbrewbulbbuzzcalmcashcatschefcityclawcodecolacookcost"
+    "cruxcurlcuspcyandarkdatadaysdelidicedietdoordowndrawdropdrumdull"
+    "dutyeacheasyechoedgeepicevenexamexiteyesfactfairfernfigsfilmfish"
+    "fizzflapflewfluxfoxyfreefrogfuelfundgalagamegeargemsgiftgirlglow"
+    "goodgraygrimgurugushgyrohalfhanghardhawkheathelphighhillholyhope"
+    "hornhutsicedideaidleinchinkyintoirisironitemjadejazzjoinjoltjowl"
+    "judojugsjumpjunkjurykeepkenokeptkeyskickkilnkingkitekiwiknoblamb"
+    "lavalazyleaflegsliarlimplionlistlogoloudloveluaulucklungmainmany"
+    "mathmazememomenumeowmildmintmissmonknailnavyneednewsnextnoonnote"
+    "numbobeyoboeomitonyxopenovalowlspaidpartpeckplaypluspoempoolpose"
+    "puffpumapurrquadquizraceramprealredorichroadrockroofrubyruinruns"
+    "rustsafesagascarsetssilkskewslotsoapsolosongstubsurfswantacotask"
+    "taxitenttiedtimetinytoiltombtoystriptunatwinuglyundouniturgeuser"
+    "vastveryvetovialvibeviewvisavoidvowswallwandwarmwaspwavewaxywebs"
+    "whatwhenwhizwolfworkyankyawnyellyogayurtzapszerozestzinczonezoom";
+
+// byte of the word starting with the first letter and ending with the second one, -1 for none
+static const int16_t minimal_bytewords[26 * 26] = {
+    /* a */ 4, -1, -1, 1, 0, -1, -1, 5, -1, -1, -1, -1, 6, -1, 2, -1, -1, -1, 9, 7, -1, -1, -1, 3, 8, -1,
+    /* b */ 14, 20, -1, 11, 16, -1, 18, -1, -1, -1, 10, -1, -1, 12, -1, -1, -1, -1, 15, 13, -1, -1, 19, -1, 17, 21,
+    /* c */ 29, -1, -1, -1, 28, 25, -1, 23, -1, -1, 30, 33, 22, 35, -1, 34, -1, -1, 24, 31, -1, -1, 27, 32, 26, -1,
+    /* d */ 37, -1, -1, -1, 40, -1, -1, -1, 39, -1, 36, 47, 46, 43, -1, 45, -1, 42, 38, 41, -1, -1, 44, -1, 48, -1,
+    /* e */ -1, -1, 53, -1, 52, -1, -1, 49, -1, -1, -1, -1, 55, 54, 51, -1, -1, -1, 57, 56, -1, -1, -1, -1, 50, -1,
+    /* f */ -1, -1, -1, 72, 69, -1, 70, 63, -1, -1, -1, 71, 62, 60, -1, 65, -1, 59, 61, 58, -1, -1, 66, 67, 68, 64,
+    /* g */ 73, -1, -1, 80, 74, -1, -1, 84, -1, -1, -1, 78, 82, -1, 85, -1, -1, 75, 76, 77, 83, -1, 79, -1, 81, -1,
+    /* h */ -1, -1, -1, 88, 95, 86, 87, 92, -1, -1, 89, 93, -1, 96, -1, 91, -1, -1, 97, 90, -1, -1, -1, -1, 94, -1,
+    /* i */ 99, -1, -1, 98, 100, -1, -1, 101, -1, -1, -1, -1, 106, 105, 103, -1, -1, -1, 104, -1, -1, -1, -1, -1, 102, -1,
+    /* j */ -1, -1, -1, -1, 107, -1, -1, -1, -1, -1, 115, 111, -1, 109, 112, 114, -1, -1, 113, 110, -1, -1, -1, -1, 116, 108,
+    /* k */ -1, 126, -1, -1, 124, -1, 123, -1, 125, -1, 121, -1, -1, 122, 118, 117, -1, -1, 120, 119, -1, -1, -1, -1, -1, -1,
+    /* l */ 128, 127, -1, 137, 138, 130, 141, -1, -1, -1, 140, -1, -1, 134, 136, 133, -1, 132, 131, 135, 139, -1, -1, -1, 129, -1,
+    /* m */ -1, -1, -1, 149, 145, -1, -1, 144, -1, -1, 152, -1, -1, 142, 146, -1, -1, -1, 151, 150, 147, -1, 148, -1, 143, -1,
+    /* n */ -1, 160, -1, 155, 159, -1, -1, -1, -1, -1, -1, 153, -1, 158, -1, -1, -1, -1, 156, 157, -1, -1, -1, -1, 154, -1,
+    /* o */ -1, -1, -1, -1, 162, -1, -1, -1, -1, -1, -1, 166, -1, 165, -1, -1, -1, -1, 167, 163, -1, -1, -1, 164, 161, -1,
+    /* p */ 177, -1, -1, 168, 175, 176, -1, -1, -1, -1, 170, 174, 173, -1, -1, -1, -1, 178, 172, 169, -1, -1, -1, -1, 171, -1,
+    /* q */ -1, -1, -1, 179, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 180,
+    /* r */ -1, -1, -1, 186, 181, 188, -1, 185, -1, -1, 187, 183, -1, 190, 184, 182, -1, -1, 191, 192, -1, -1, -1, -1, 189, -1,
+    /* s */ 194, 203, -1, -1, 193, 204, 202, -1, -1, -1, 197, -1, -1, 205, 201, 200, -1, 195, 196, 199, -1, -1, 198, -1, -1, -1,
+    /* t */ 217, 214, -1, 210, 211, -1, -1, -1, 208, -1, 207, 213, -1, 218, 206, 216, -1, -1, 215, 209, -1, -1, -1, -1, 212, -1,
+    /* u */ -1, -1, -1, -1, 222, -1, -1, -1, -1, -1, -1, -1, -1, -1, 220, -1, -1, 223, -1, 221, -1, -1, -1, -1, 219, -1,
+    /* v */ 230, -1, -1, 231, 228, -1, -1, -1, -1, -1, -1, 227, -1, -1, 226, -1, -1, -1, 232, 224, -1, -1, 229, -1, 225, -1,
+    /* w */ -1, -1, -1, 234, 237, 243, -1, -1, -1, -1, 244, 233, 235, 241, -1, 236, -1, -1, 239, 240, -1, -1, -1, -1, 238, 242,
+    /* x */ -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    /* y */ 248, -1, -1, -1, -1, -1, -1, -1, -1, -1, 245, 247, -1, 246, -1, -1, -1, -1, -1, 249, -1, -1, -1, -1, -1, -1,
+    /* z */ -1, -1, 253, -1, 254, -1, -1, -1, -1, -1, -1, -1, 255, -1, 251, -1, -1, -1, 250, 252, -1, -1, -1, -1, -1, -1,
+};
+
+// 0 to 25 for letters of either case, -1 otherwise
+static inline int letter_index(char ch)
+{
+    const unsigned lower = (unsigned char)ch | 0x20;
+    return lower >= 'a' && lower <= 'z' ? (int)(lower - 'a') : -1;
+}
+
+static inline int minimal_byte(char first, char last)
+{
+    const int first_idx = letter_index(first);
+    const int last_idx = letter_index(last);
+    if (first_idx < 0 || last_idx < 0) {
+        return -1;
+    }
+    return minimal_bytewords[first_idx * 26 + last_idx];
+}
+
+// first and last letters identify the word, the middle ones are checked against it
+static inline int standard_byte(const char *word)
+{
+    const int byte = minimal_byte(word[0], word[WORD_LEN - 1]);
+    if (byte < 0) {
+        return -1;
+    }
+    for (size_t idx = 1; idx < WORD_LEN - 1; idx++) {
+        if (((unsigned char)word[idx] | 0x20) != (unsigned char)bytewords[byte * WORD_LEN + idx]) {
+            return -1;
+        }
+    }
+    return byte;
+}
+
+int bytewords_decode(const char *words, size_t words_len, uint8_t *out, size_t out_capacity, size_t *out_len)
+{
+    // standard and uri bytewords separate words, minimal ones don't
+    const char separator = words_len > WORD_LEN ? words[WORD_LEN] : '\0';
+    const bool minimal = separator != ' ' && separator != '-';
+    size_t bytes_len;
+    if (minimal) {
+        if (words_len % 2 != 0) {
+            return URC_EUNKNOWNFORMAT;
+        }
+        bytes_len = words_len / 2;
+    } else {
+        if ((words_len + 1) % (WORD_LEN + 1) != 0) {
+            return URC_EUNKNOWNFORMAT;
+        }
+        bytes_len = (words_len + 1) / (WORD_LEN + 1);
+    }
+    if (bytes_len < CHECKSUM_LEN) {
+        return URC_EUNKNOWNFORMAT;
+    }
+    const size_t message_len = bytes_len - CHECKSUM_LEN;
+    if (message_len > out_capacity) {
+        return URC_EBUFFERTOOSMALL;
+    }
+
+    uint8_t checksum[CHECKSUM_LEN];
+    for (size_t idx = 0; idx < bytes_len; idx++) {
+        int byte;
+        if (minimal) {
+            byte = minimal_byte(words[idx * 2], words[idx * 2 + 1]);
+        } else {
+            const char *word = &words[idx * (WORD_LEN + 1)];
+            byte = standard_byte(word);
+            if (idx + 1 < bytes_len && word[WORD_LEN] != separator) {
+                return URC_EUNKNOWNFORMAT;
+            }
+        }
+        if (byte < 0) {
+            return URC_EUNKNOWNFORMAT;
+        }
+        if (idx < message_len) {
+            out[idx] = (uint8_t)byte;
+        } else {
+            checksum[idx - message_len] = (uint8_t)byte;
+        }
+    }
+
+    const uint32_t expected =
+        (uint32_t)checksum[0] << 24 | (uint32_t)checksum[1] << 16 | (uint32_t)checksum[2] << 8 | (uint32_t)checksum[3];
+    if (urc_crc32_update(0, out, message_len) != expected) {
+        return URC_EINVALIDCHECKSUM;
+    }
+    *out_len = message_len;
+    return URC_OK;
+}
+
+static inline void write_minimal(uint8_t byte, char *out)
+{
+    out[0] = bytewords[byte * WORD_LEN];
+    out[1] = bytewords[byte * WORD_LEN + WORD_LEN - 1];
+}
+
+size_t bytewords_encode_minimal(const uint8_t *data, size_t len, char *out)
+{
+    for (size_t idx = 0; idx < len; idx++) {
+        write_minimal(data[idx], &out[idx * 2]);
+    }
+    const uint32_t checksum = urc_crc32_update(0, data, len);
+    for (size_t idx = 0; idx < CHECKSUM_LEN; idx++) {
+        write_minimal((uint8_t)(checksum >> (8 * (CHECKSUM_LEN - 1 - idx))), &out[(len + idx) * 2]);
+    }
+    return BYTEWORDS_MINIMAL_LEN(len);
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// https://github.com/BlockchainCommons/Research/blob/master/papers/bcr-2020-012-bytewords.md
+// minimal (``aeadao``), standard (``able acid also``) or uri (``able-acid-also``) bytewords, in either case,
+// ending with the big endian CRC32 of the message, which is checked and left out of ``out``
+int bytewords_decode(const char *words, size_t words_len, uint8_t *out, size_t out_capacity, size_t *out_len);
+
+// two letters per byte, the CRC32 included
+#define BYTEWORDS_MINIMAL_LEN(len) (((len) + 4) * 2)
+
+// writes BYTEWORDS_MINIMAL_LEN(len) characters to ``out``, no terminator, and returns that count
+size_t bytewords_encode_minimal(const uint8_t *data, size_t len, char *out);
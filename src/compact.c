@@ -0,0 +1,323 @@
+#include <string.h>
+
+#include "wally_core.h"
+
+#include "urc/crypto_account.h"
+#include "urc/crypto_output.h"
+
+#include "utils.h"
+
+#define COMPACT_IS_PRIVATE 0x01
+#define COMPACT_VALID_CHAINCODE 0x02
+#define COMPACT_IS_MASTER 0x04
+
+// block of a derived hdkey: origin components, then children components, then NUL terminated name and note
+typedef struct {
+    size_t name_len;
+    size_t note_len;
+    uint32_t origin_fingerprint;
+    uint32_t children_fingerprint;
+    uint8_t origin_depth;
+    uint8_t children_depth;
+    uint8_t origin_count;
+    uint8_t children_count;
+    path_component components[];
+} compact_extra;
+
+static char *extra_name(const compact_extra *extra)
+{
+    return (char *)&extra->components[extra->origin_count + extra->children_count];
+}
+
+static char *extra_note(const compact_extra *extra)
+{
+    return extra_name(extra) + extra->name_len + 1;
+}
+
+static size_t extra_size(size_t components_count, size_t name_len, size_t note_len)
+{
+    return sizeof(compact_extra) + components_count * sizeof(path_component) + name_len + 1 + note_len + 1;
+}
+
+// the untruncated view, or the truncated copy for chunked strings
+static urc_text_view text_source(const urc_text_view *view, const char *copy)
+{
+    if (view->text) {
+        return *view;
+    }
+    urc_text_view text = {.text = copy, .len = strlen(copy)};
+    return text;
+}
+
+static int derived_compact(const hd_derived_key *key, crypto_output_compact *out)
+{
+    memcpy(out->key, key->keydata, CRYPTO_HDKEY_KEYDATA_SIZE);
+    memcpy(&out->key[CRYPTO_HDKEY_KEYDATA_SIZE], key->chaincode, CRYPTO_HDKEY_CHAINCODE_SIZE);
+    out->flags = (key->is_private ? COMPACT_IS_PRIVATE : 0) | (key->valid_chaincode ? COMPACT_VALID_CHAINCODE : 0);
+    out->useinfo = key->useinfo;
+    out->parent_fingerprint = key->parent_fingerprint;
+
+    urc_text_view name = text_source(&key->name_view, key->name);
+    urc_text_view note = text_source(&key->note_view, key->note);
+    const crypto_keypath *origin = &key->origin;
+    const crypto_keypath *children = &key->children;
+    if (!origin->components_count && !origin->source_fingerprint && !origin->depth && !children->components_count &&
+        !children->source_fingerprint && !children->depth && !name.len && !note.len) {
+        return URC_OK;
+    }
+
+    size_t components_count = origin->components_count + children->components_count;
+    compact_extra *extra = urc_malloc(extra_size(components_count, name.len, note.len));
+    if (!extra) {
+        return URC_ENOMEM;
+    }
+    extra->name_len = name.len;
+    extra->note_len = note.len;
+    extra->origin_fingerprint = origin->source_fingerprint;
+    extra->children_fingerprint = children->source_fingerprint;
+    extra->origin_depth = origin->depth;
+    extra->children_depth = children->depth;
+    extra->origin_count = (uint8_t)origin->components_count;
+    extra->children_count = (uint8_t)children->components_count;
+    memcpy(extra->components, origin->components, origin->components_count * sizeof(path_component));
+    memcpy(&extra->components[origin->components_count], children->components,
+           children->components_count * sizeof(path_component));
+    char *text = extra_name(extra);
+    memcpy(text, name.text, name.len);
+    text[name.len] = '\0';
+    text = extra_note(extra);
+    memcpy(text, note.text, note.len);
+    text[note.len] = '\0';
+    out->extra = extra;
+    return URC_OK;
+}
+
+// called while the buffer ``output`` was deserialized from is still there, name and note views point into it
+static int output_compact(const crypto_output *output, crypto_output_compact *out)
+{
+    memset(out, 0, sizeof(*out));
+    out->output_type = (uint8_t)output->type;
+    if (output->type == output_type_rawscript) {
+        memcpy(out->key, output->output.raw, URC_RAWSCRIPT_LEN);
+        return URC_OK;
+    }
+    if (output->type == output_type_na) {
+        return URC_OK;
+    }
+
+    const output_keyexp *keyexp = &output->output.key;
+    out->keyexp_type = (uint8_t)keyexp->type;
+    out->keytype = (uint8_t)keyexp->keytype;
+    if (keyexp->keytype == keyexp_keytype_eckey) {
+        out->key_type = (uint8_t)keyexp->key.eckey.type;
+        memcpy(out->key, &keyexp->key.eckey.key, sizeof(keyexp->key.eckey.key));
+        return URC_OK;
+    }
+    if (keyexp->keytype != keyexp_keytype_hdkey) {
+        return URC_OK;
+    }
+
+    const crypto_hdkey *hdkey = &keyexp->key.hdkey;
+    out->key_type = (uint8_t)hdkey->type;
+    if (hdkey->type == hdkey_type_master) {
+        memcpy(out->key, hdkey->key.master.keydata, CRYPTO_HDKEY_KEYDATA_SIZE);
+        memcpy(&out->key[CRYPTO_HDKEY_KEYDATA_SIZE], hdkey->key.master.chaincode, CRYPTO_HDKEY_CHAINCODE_SIZE);
+        out->flags = hdkey->key.master.is_master ? COMPACT_IS_MASTER : 0;
+        return URC_OK;
+    }
+    if (hdkey->type != hdkey_type_derived) {
+        return URC_OK;
+    }
+    return derived_compact(&hdkey->key.derived, out);
+}
+
+static void text_expand(const char *text, size_t len, char *buffer, size_t buffer_size, urc_text_view *view)
+{
+    memset(buffer, 0, buffer_size);
+    view->text = NULL;
+    view->len = 0;
+    if (!len) {
+        return;
+    }
+    memcpy(buffer, text, len < buffer_size - 1 ? len : buffer_size - 1);
+    view->text = text;
+    view->len = len;
+}
+
+static void keypath_expand(const path_component *components, uint8_t count, uint32_t fingerprint, uint8_t depth,
+                           crypto_keypath *out)
+{
+    memset(out, 0, sizeof(*out));
+    memcpy(out->components, components, count * sizeof(path_component));
+    out->components_count = count;
+    out->source_fingerprint = fingerprint;
+    out->depth = depth;
+}
+
+static void derived_expand(const crypto_output_compact *compact, hd_derived_key *key)
+{
+    memset(key, 0, sizeof(*key));
+    memcpy(key->keydata, compact->key, CRYPTO_HDKEY_KEYDATA_SIZE);
+    memcpy(key->chaincode, &compact->key[CRYPTO_HDKEY_KEYDATA_SIZE], CRYPTO_HDKEY_CHAINCODE_SIZE);
+    key->is_private = compact->flags & COMPACT_IS_PRIVATE;
+    key->valid_chaincode = compact->flags & COMPACT_VALID_CHAINCODE;
+    key->useinfo = compact->useinfo;
+    key->parent_fingerprint = compact->parent_fingerprint;
+
+    const compact_extra *extra = compact->extra;
+    if (!extra) {
+        return;
+    }
+    keypath_expand(extra->components, extra->origin_count, extra->origin_fingerprint, extra->origin_depth, &key->origin);
+    keypath_expand(&extra->components[extra->origin_count], extra->children_count, extra->children_fingerprint,
+                   extra->children_depth, &key->children);
+    text_expand(extra_name(extra), extra->name_len, key->name, NAME_BUFFER_SIZE, &key->name_view);
+    text_expand(extra_note(extra), extra->note_len, key->note, NOTE_BUFFER_SIZE, &key->note_view);
+}
+
+int urc_crypto_output_deserialize_compact(const uint8_t *cbor_buffer, size_t cbor_len, crypto_output_compact *out)
+{
+    if (!out) {
+        return URC_EINVALIDARG;
+    }
+    memset(out, 0, sizeof(*out));
+
+    crypto_output output;
+    int result = urc_crypto_output_deserialize(cbor_buffer, cbor_len, &output);
+    if (result == URC_OK) {
+        result = output_compact(&output, out);
+    }
+    wally_bzero(&output, sizeof(output));
+    return result;
+}
+
+int urc_crypto_output_compact_expand(const crypto_output_compact *compact, crypto_output *out)
+{
+    if (!compact || !out) {
+        return URC_EINVALIDARG;
+    }
+    memset(out, 0, sizeof(*out));
+    out->type = compact->output_type;
+    if (compact->output_type == output_type_rawscript) {
+        memcpy(out->output.raw, compact->key, URC_RAWSCRIPT_LEN);
+        return URC_OK;
+    }
+    if (compact->output_type == output_type_na) {
+        return URC_OK;
+    }
+
+    output_keyexp *keyexp = &out->output.key;
+    keyexp->type = compact->keyexp_type;
+    keyexp->keytype = compact->keytype;
+    if (compact->keytype == keyexp_keytype_eckey) {
+        keyexp->key.eckey.type = compact->key_type;
+        memcpy(&keyexp->key.eckey.key, compact->key, sizeof(keyexp->key.eckey.key));
+        return URC_OK;
+    }
+    if (compact->keytype != keyexp_keytype_hdkey) {
+        return URC_OK;
+    }
+
+    crypto_hdkey *hdkey = &keyexp->key.hdkey;
+    hdkey->type = compact->key_type;
+    if (compact->key_type == hdkey_type_master) {
+        memcpy(hdkey->key.master.keydata, compact->key, CRYPTO_HDKEY_KEYDATA_SIZE);
+        memcpy(hdkey->key.master.chaincode, &compact->key[CRYPTO_HDKEY_KEYDATA_SIZE], CRYPTO_HDKEY_CHAINCODE_SIZE);
+        hdkey->key.master.is_master = compact->flags & COMPACT_IS_MASTER;
+    } else if (compact->key_type == hdkey_type_derived) {
+        derived_expand(compact, &hdkey->key.derived);
+    }
+    return URC_OK;
+}
+
+void urc_crypto_output_compact_free(crypto_output_compact *compact)
+{
+    if (!compact) {
+        return;
+    }
+    compact_extra *extra = compact->extra;
+    if (extra) {
+        wally_bzero(extra, extra_size(extra->origin_count + extra->children_count, extra->name_len, extra->note_len));
+    }
+    urc_free(extra);
+    wally_bzero(compact, sizeof(*compact));
+}
+
+static int account_compact(const crypto_account_unbounded *account, crypto_account_compact *out)
+{
+    out->master_fingerprint = account->master_fingerprint;
+    if (!account->descriptors_count) {
+        return URC_OK;
+    }
+    // no larger than the descriptors block already allocated
+    out->descriptors = urc_malloc(account->descriptors_count * sizeof(crypto_output_compact));
+    if (!out->descriptors) {
+        return URC_ENOMEM;
+    }
+    for (size_t idx = 0; idx < account->descriptors_count; idx++) {
+        int result = output_compact(&account->descriptors[idx], &out->descriptors[idx]);
+        if (result != URC_OK) {
+            return result;
+        }
+        out->descriptors_count = idx + 1;
+    }
+    return URC_OK;
+}
+
+static int account_deserialize_compact(int (*deserialize)(const uint8_t *, size_t, crypto_account_unbounded *),
+                                       const uint8_t *cbor_buffer, size_t cbor_len, crypto_account_compact *out)
+{
+    if (!out) {
+        return URC_EINVALIDARG;
+    }
+    memset(out, 0, sizeof(*out));
+
+    crypto_account_unbounded account;
+    int result = deserialize(cbor_buffer, cbor_len, &account);
+    if (result != URC_OK && result != URC_ETAPROOTNOTSUPPORTED) {
+        return result;
+    }
+    int compact_result = account_compact(&account, out);
+    if (compact_result != URC_OK) {
+        urc_crypto_account_compact_free(out);
+        result = compact_result;
+    }
+    urc_crypto_account_unbounded_free(&account);
+    return result;
+}
+
+int urc_crypto_account_deserialize_compact(const uint8_t *cbor_buffer, size_t cbor_len, crypto_account_compact *out)
+{
+    return account_deserialize_compact(urc_crypto_account_unbounded_deserialize, cbor_buffer, cbor_len, out);
+}
+
+int urc_jade_account_deserialize_compact(const uint8_t *cbor_buffer, size_t cbor_len, crypto_account_compact *out)
+{
+    return account_deserialize_compact(urc_jade_account_unbounded_deserialize, cbor_buffer, cbor_len, out);
+}
+
+size_t urc_crypto_account_compact_count(const crypto_account_compact *account)
+{
+    return account ? account->descriptors_count : 0;
+}
+
+int urc_crypto_account_compact_descriptor(const crypto_account_compact *account, size_t idx, crypto_output *out)
+{
+    if (!account || idx >= account->descriptors_count) {
+        return URC_EINVALIDARG;
+    }
+    return urc_crypto_output_compact_expand(&account->descriptors[idx], out);
+}
+
+void urc_crypto_account_compact_free(crypto_account_compact *account)
+{
+    if (!account) {
+        return;
+    }
+    for (size_t idx = 0; idx < account->descriptors_count; idx++) {
+        urc_crypto_output_compact_free(&account->descriptors[idx]);
+    }
+    urc_free(account->descriptors);
+    account->descriptors = NULL;
+    account->descriptors_count = 0;
+}
@@ -1,12 +1,16 @@
+#include <string.h>
 
 #include "wally_core.h"
 
 #include "urc/core.h"
 
-void urc_free(void *ptr) { wally_free(ptr); }
-
-void urc_string_free(char *str) { wally_free_string(str); }
-
+void urc_string_free(char *str)
+{
+    if (str) {
+        wally_bzero(str, strlen(str));
+        urc_free(str);
+    }
+}
 
 void urc_string_array_free(char *str_array[]) {
     size_t idx = 0;
@@ -15,5 +19,5 @@ void urc_string_array_free(char *str_array[]) {
         str_array[idx] = NULL;
         idx++;
     }
-    wally_free(str_array);
+    urc_free(str_array);
 }
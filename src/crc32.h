@@ -0,0 +1,18 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// CRC-32/ISO-HDLC, as zlib's crc32: start from 0, feed the previous result to continue
+// runs the fastest kernel below the cpu supports, picked on first use
+uint32_t urc_crc32_update(uint32_t crc, const uint8_t *data, size_t len);
+
+// kernels, same contract as urc_crc32_update, exposed for tests and benchmarks
+typedef uint32_t (*crc32_kernel)(uint32_t crc, const uint8_t *data, size_t len);
+
+// one table lookup per byte, the baseline
+uint32_t crc32_update_bytewise(uint32_t crc, const uint8_t *data, size_t len);
+// slicing-by-8, portable
+uint32_t crc32_update_slice8(uint32_t crc, const uint8_t *data, size_t len);
+// PCLMULQDQ folding on x86, the CRC32 instructions on ARMv8, NULL when the cpu has neither
+crc32_kernel crc32_hardware_kernel(void);
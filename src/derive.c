@@ -0,0 +1,273 @@
+#include <stdatomic.h>
+#include <string.h>
+
+#include "wally_bip32.h"
+#include "wally_core.h"
+#include "wally_crypto.h"
+#include "wally_script.h"
+
+#include "urc/derive.h"
+#include "urc/error.h"
+
+#include "internals.h"
+#include "macros.h"
+#include "parallel.h"
+#include "trace.h"
+
+// indexes derived by a task, the parent key is rebuilt once per task
+#define DERIVE_BLOCK_SIZE 256
+
+static int script_type_of(const crypto_output *output, urc_script_type *out)
+{
+    if (output->type == output_type_rawscript || output->output.key.keytype != keyexp_keytype_hdkey) {
+        return URC_EUNHANDLEDCASE;
+    }
+    switch (output->type) {
+    case output_type__:
+        switch (output->output.key.type) {
+        case keyexp_type_pk:
+            *out = urc_script_type_p2pk;
+            return URC_OK;
+        case keyexp_type_pkh:
+            *out = urc_script_type_p2pkh;
+            return URC_OK;
+        case keyexp_type_wpkh:
+            *out = urc_script_type_p2wpkh;
+            return URC_OK;
+        default:
+            return URC_EUNHANDLEDCASE;
+        }
+    case output_type_sh:
+        if (output->output.key.type != keyexp_type_wpkh) {
+            return URC_EUNHANDLEDCASE;
+        }
+        *out = urc_script_type_p2sh_p2wpkh;
+        return URC_OK;
+    default:
+        return URC_EUNHANDLEDCASE;
+    }
+}
+
+// ``/<0;1>/*``
+static const path_component implicit_children[] = {
+    {.component.pair = {.external = {.index = 0}, .internal = {.index = 1}}, .type = path_component_type_pair},
+    {.type = path_component_type_wildcard},
+};
+
+// fixed components, at most one pair, then a non hardened wildcard
+static int check_children(const path_component *components, size_t count, size_t *chains_count)
+{
+    if (count == 0 || components[count - 1].type != path_component_type_wildcard ||
+        components[count - 1].component.wildcard.is_hardened) {
+        return URC_EUNHANDLEDCASE;
+    }
+    *chains_count = 1;
+    for (size_t idx = 0; idx + 1 < count; idx++) {
+        switch (components[idx].type) {
+        case path_component_type_index:
+            break;
+        case path_component_type_pair:
+            if (*chains_count == 2) {
+                return URC_EUNHANDLEDCASE;
+            }
+            *chains_count = 2;
+            break;
+        default:
+            return URC_EUNHANDLEDCASE;
+        }
+    }
+    return URC_OK;
+}
+
+static uint32_t child_number(const path_component *component, uint32_t chain)
+{
+    const child_index_component *index = &component->component.index;
+    if (component->type == path_component_type_pair) {
+        index = chain == 0 ? &component->component.pair.external : &component->component.pair.internal;
+    }
+    return index->is_hardened ? index->index | BIP32_INITIAL_HARDENED_CHILD : index->index;
+}
+
+int urc_script_deriver_init(urc_script_deriver *deriver, const crypto_output *output)
+{
+    if (!deriver || !output) {
+        return URC_EINVALIDARG;
+    }
+    int result = script_type_of(output, &deriver->script_type);
+    if (result != URC_OK) {
+        return result;
+    }
+
+    const crypto_hdkey *hdkey = &output->output.key.key.hdkey;
+    const path_component *components = implicit_children;
+    size_t components_count = sizeof(implicit_children) / sizeof(implicit_children[0]);
+    if (hdkey->type == hdkey_type_derived) {
+        if (!hdkey->key.derived.valid_chaincode) {
+            return URC_EINVALIDARG;
+        }
+        if (hdkey->key.derived.children.components_count > 0) {
+            components = hdkey->key.derived.children.components;
+            components_count = hdkey->key.derived.children.components_count;
+        }
+    }
+    result = check_children(components, components_count, &deriver->chains_count);
+    if (result != URC_OK) {
+        return result;
+    }
+
+    uint32_t serialization_flag;
+    struct ext_key root;
+    struct ext_key key;
+    result = urc_hdkey_to_ext_key(hdkey, &root, &serialization_flag);
+    if (result != URC_OK) {
+        goto exit;
+    }
+    const bool is_private = serialization_flag == BIP32_FLAG_KEY_PRIVATE;
+    const bool is_mainnet = root.version == BIP32_VER_MAIN_PRIVATE || root.version == BIP32_VER_MAIN_PUBLIC;
+
+    for (uint32_t chain = 0; chain < deriver->chains_count; chain++) {
+        key = root;
+        for (size_t idx = 0; idx + 1 < components_count; idx++) {
+            const uint32_t child_num = child_number(&components[idx], chain);
+            if (child_num >= BIP32_INITIAL_HARDENED_CHILD && !is_private) {
+                result = URC_EINVALIDARG;
+                goto exit;
+            }
+            struct ext_key child;
+            int wally_result = bip32_key_from_parent(
+                &key, child_num, (is_private ? BIP32_FLAG_KEY_PRIVATE : BIP32_FLAG_KEY_PUBLIC) | BIP32_FLAG_SKIP_HASH, &child);
+            key = child;
+            wally_bzero(&child, sizeof(child));
+            CHECK_WALLY_ERROR(wally_result, result, exit);
+        }
+        deriver->parents[chain].version = is_mainnet ? BIP32_VER_MAIN_PUBLIC : BIP32_VER_TEST_PUBLIC;
+        deriver->parents[chain].child_num = key.child_num;
+        deriver->parents[chain].depth = key.depth;
+        memcpy(deriver->parents[chain].chaincode, key.chain_code, CRYPTO_HDKEY_CHAINCODE_SIZE);
+        memcpy(deriver->parents[chain].pubkey, key.pub_key, CRYPTO_HDKEY_KEYDATA_SIZE);
+    }
+
+exit:
+    wally_bzero(&key, sizeof(key));
+    wally_bzero(&root, sizeof(root));
+    return result;
+}
+
+static int write_script(urc_script_type type, const uint8_t pubkey[CRYPTO_HDKEY_KEYDATA_SIZE], urc_scriptpubkey *out)
+{
+    uint8_t *script = out->script;
+    if (type == urc_script_type_p2pk) {
+        script[0] = CRYPTO_HDKEY_KEYDATA_SIZE;
+        memcpy(&script[1], pubkey, CRYPTO_HDKEY_KEYDATA_SIZE);
+        script[1 + CRYPTO_HDKEY_KEYDATA_SIZE] = OP_CHECKSIG;
+        out->script_len = CRYPTO_HDKEY_KEYDATA_SIZE + 2;
+        return URC_OK;
+    }
+
+    int result = URC_OK;
+    uint8_t hash[HASH160_LEN];
+    int wally_result = wally_hash160(pubkey, CRYPTO_HDKEY_KEYDATA_SIZE, hash, HASH160_LEN);
+    CHECK_WALLY_ERROR(wally_result, result, exit);
+    switch (type) {
+    case urc_script_type_p2pkh:
+        script[0] = OP_DUP;
+        script[1] = OP_HASH160;
+        script[2] = HASH160_LEN;
+        memcpy(&script[3], hash, HASH160_LEN);
+        script[3 + HASH160_LEN] = OP_EQUALVERIFY;
+        script[4 + HASH160_LEN] = OP_CHECKSIG;
+        out->script_len = WALLY_SCRIPTPUBKEY_P2PKH_LEN;
+        break;
+    case urc_script_type_p2wpkh:
+        script[0] = OP_0;
+        script[1] = HASH160_LEN;
+        memcpy(&script[2], hash, HASH160_LEN);
+        out->script_len = WALLY_SCRIPTPUBKEY_P2WPKH_LEN;
+        break;
+    case urc_script_type_p2sh_p2wpkh: {
+        // the redeem script is the p2wpkh witness program
+        uint8_t redeem_script[WALLY_SCRIPTPUBKEY_P2WPKH_LEN] = {OP_0, HASH160_LEN};
+        memcpy(&redeem_script[2], hash, HASH160_LEN);
+        script[0] = OP_HASH160;
+        script[1] = HASH160_LEN;
+        wally_result = wally_hash160(redeem_script, sizeof(redeem_script), &script[2], HASH160_LEN);
+        CHECK_WALLY_ERROR(wally_result, result, exit);
+        script[2 + HASH160_LEN] = OP_EQUAL;
+        out->script_len = WALLY_SCRIPTPUBKEY_P2SH_LEN;
+        break;
+    }
+    default:
+        result = URC_EINVALIDARG;
+    }
+
+exit:
+    return result;
+}
+
+typedef struct {
+    const urc_script_deriver *deriver;
+    uint32_t chain;
+    uint32_t first;
+    size_t count;
+    urc_scriptpubkey *out;
+    // first error met by any task
+    _Atomic int result;
+} derive_job;
+
+static void derive_block(void *ctx, size_t block)
+{
+    derive_job *job = ctx;
+    const size_t begin = block * DERIVE_BLOCK_SIZE;
+    const size_t end = begin + DERIVE_BLOCK_SIZE < job->count ? begin + DERIVE_BLOCK_SIZE : job->count;
+    int result = URC_OK;
+
+    const urc_script_deriver_parent *parent_data = &job->deriver->parents[job->chain];
+    struct ext_key parent;
+    trace_span span = trace_begin(TRACE_TYPE_CURRENT, urc_trace_phase_bip32_init);
+    int wally_result = bip32_key_init(parent_data->version, parent_data->depth, parent_data->child_num,
+                                      parent_data->chaincode, CRYPTO_HDKEY_CHAINCODE_SIZE, parent_data->pubkey,
+                                      CRYPTO_HDKEY_KEYDATA_SIZE, NULL, 0, NULL, 0, NULL, 0, &parent);
+    trace_end(&span);
+    CHECK_WALLY_ERROR(wally_result, result, exit);
+
+    for (size_t idx = begin; idx < end; idx++) {
+        // the child's own hash160 is only needed to serialize it, skip it
+        struct ext_key child;
+        wally_result =
+            bip32_key_from_parent(&parent, job->first + (uint32_t)idx, BIP32_FLAG_KEY_PUBLIC | BIP32_FLAG_SKIP_HASH, &child);
+        CHECK_WALLY_ERROR(wally_result, result, exit);
+        result = write_script(job->deriver->script_type, child.pub_key, &job->out[idx]);
+        if (result != URC_OK) {
+            goto exit;
+        }
+    }
+
+exit:
+    if (result != URC_OK) {
+        int expected = URC_OK;
+        atomic_compare_exchange_strong(&job->result, &expected, result);
+    }
+}
+
+int urc_script_deriver_derive(const urc_script_deriver *deriver, uint32_t chain, uint32_t first, size_t count,
+                              size_t threads, urc_scriptpubkey *out)
+{
+    if (!deriver || !out || chain >= deriver->chains_count || first >= BIP32_INITIAL_HARDENED_CHILD ||
+        count > BIP32_INITIAL_HARDENED_CHILD - first) {
+        return URC_EINVALIDARG;
+    }
+
+    derive_job job = {
+        .deriver = deriver,
+        .chain = chain,
+        .first = first,
+        .count = count,
+        .out = out,
+        .result = URC_OK,
+    };
+    int result = urc_parallel_for((count + DERIVE_BLOCK_SIZE - 1) / DERIVE_BLOCK_SIZE, threads, derive_block, &job);
+    if (result != URC_OK) {
+        return result;
+    }
+    return atomic_load(&job.result);
+}
@@ -0,0 +1,125 @@
+#include "urc/crypto_output.h"
+#include "urc/error.h"
+
+#include "descriptor_checksum.h"
+
+// https://github.com/bitcoin/bips/blob/master/bip-0380.mediawiki#checksum
+// every printable ascii character belongs to the input charset, this is its position in it
+#define CHARSET_FIRST 0x20
+#define CHARSET_LAST 0x7e
+static const uint8_t input_positions[CHARSET_LAST - CHARSET_FIRST + 1] = {
+    94, 59, 92, 91, 28, 29, 50, 15, 10, 11, 17, 51, 14, 52, 53, 16,
+    0,  1,  2,  3,  4,  5,  6,  7,  8,  9,  27, 54, 55, 56, 57, 58,
+    26, 82, 83, 84, 85, 86, 87, 88, 89, 32, 33, 34, 35, 36, 37, 38,
+    39, 40, 41, 42, 43, 44, 45, 46, 47, 48, 49, 12, 93, 13, 60, 61,
+    90, 18, 19, 20, 21, 22, 23, 24, 25, 64, 65, 66, 67, 68, 69, 70,
+    71, 72, 73, 74, 75, 76, 77, 78, 79, 80, 81, 30, 62, 31, 63,
+};
+
+static const char checksum_charset[] = "qpzry9x8gf2tvdw0s3jn54khce6mua7l";
+
+// xor of the generators selected by the 5 bits shifted out of the 40 bits state
+static const uint64_t generators[32] = {
+    0x0000000000ULL, 0xf5dee51989ULL, 0xa9fdca3312ULL, 0x5c232f2a9bULL,
+    0x1bab10e32dULL, 0xee75f5faa4ULL, 0xb256dad03fULL, 0x47883fc9b6ULL,
+    0x3706b1677aULL, 0xc2d8547ef3ULL, 0x9efb7b5468ULL, 0x6b259e4de1ULL,
+    0x2cada18457ULL, 0xd973449ddeULL, 0x85506bb745ULL, 0x708e8eaeccULL,
+    0x644d626ffdULL, 0x9193877674ULL, 0xcdb0a85cefULL, 0x386e4d4566ULL,
+    0x7fe6728cd0ULL, 0x8a38979559ULL, 0xd61bb8bfc2ULL, 0x23c55da64bULL,
+    0x534bd30887ULL, 0xa69536110eULL, 0xfab6193b95ULL, 0x0f68fc221cULL,
+    0x48e0c3ebaaULL, 0xbd3e26f223ULL, 0xe11d09d8b8ULL, 0x14c3ecc131ULL,
+};
+
+static inline uint64_t polymod(uint64_t c, uint32_t value)
+{
+    return (((c & 0x7ffffffffULL) << 5) ^ value) ^ generators[c >> 35];
+}
+
+void descriptor_checksum_init(descriptor_checksum *checksum)
+{
+    checksum->c = 1;
+    checksum->cls = 0;
+    checksum->clscount = 0;
+    checksum->invalid = false;
+}
+
+void descriptor_checksum_update(descriptor_checksum *checksum, const char *data, size_t len)
+{
+    uint64_t c = checksum->c;
+    uint32_t cls = checksum->cls;
+    uint32_t clscount = checksum->clscount;
+    for (size_t idx = 0; idx < len; idx++) {
+        const uint8_t ch = (uint8_t)data[idx];
+        if (ch < CHARSET_FIRST || ch > CHARSET_LAST) {
+            checksum->invalid = true;
+            continue;
+        }
+        const uint32_t position = input_positions[ch - CHARSET_FIRST];
+        // the low 5 bits go in right away, the high ones are packed three characters at a time
+        c = polymod(c, position & 31);
+        cls = cls * 3 + (position >> 5);
+        if (++clscount == 3) {
+            c = polymod(c, cls);
+            cls = 0;
+            clscount = 0;
+        }
+    }
+    checksum->c = c;
+    checksum->cls = cls;
+    checksum->clscount = clscount;
+}
+
+bool descriptor_checksum_final(const descriptor_checksum *checksum, char out[URC_DESCRIPTOR_CHECKSUM_LEN])
+{
+    if (checksum->invalid) {
+        return false;
+    }
+    uint64_t c = checksum->c;
+    if (checksum->clscount > 0) {
+        c = polymod(c, checksum->cls);
+    }
+    for (size_t idx = 0; idx < URC_DESCRIPTOR_CHECKSUM_LEN; idx++) {
+        c = polymod(c, 0);
+    }
+    c ^= 1;
+    for (size_t idx = 0; idx < URC_DESCRIPTOR_CHECKSUM_LEN; idx++) {
+        out[idx] = checksum_charset[(c >> (5 * (URC_DESCRIPTOR_CHECKSUM_LEN - 1 - idx))) & 31];
+    }
+    return true;
+}
+
+int urc_descriptor_checksum(const char *descriptor, size_t len, char out[URC_DESCRIPTOR_CHECKSUM_LEN + 1])
+{
+    if (!descriptor || !out) {
+        return URC_EINVALIDARG;
+    }
+    descriptor_checksum checksum;
+    descriptor_checksum_init(&checksum);
+    descriptor_checksum_update(&checksum, descriptor, len);
+    if (!descriptor_checksum_final(&checksum, out)) {
+        return URC_EINVALIDARG;
+    }
+    out[URC_DESCRIPTOR_CHECKSUM_LEN] = '\0';
+    return URC_OK;
+}
+
+int urc_descriptor_checksum_verify(const char *descriptor, size_t len)
+{
+    if (!descriptor || len < URC_DESCRIPTOR_CHECKSUM_LEN + 1 || descriptor[len - URC_DESCRIPTOR_CHECKSUM_LEN - 1] != '#') {
+        return URC_EINVALIDARG;
+    }
+    const size_t body_len = len - URC_DESCRIPTOR_CHECKSUM_LEN - 1;
+    descriptor_checksum checksum;
+    descriptor_checksum_init(&checksum);
+    descriptor_checksum_update(&checksum, descriptor, body_len);
+    char expected[URC_DESCRIPTOR_CHECKSUM_LEN];
+    if (!descriptor_checksum_final(&checksum, expected)) {
+        return URC_EINVALIDARG;
+    }
+    for (size_t idx = 0; idx < URC_DESCRIPTOR_CHECKSUM_LEN; idx++) {
+        if (descriptor[body_len + 1 + idx] != expected[idx]) {
+            return URC_EINVALIDCHECKSUM;
+        }
+    }
+    return URC_OK;
+}
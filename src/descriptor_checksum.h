@@ -0,0 +1,21 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "urc/crypto_output.h"
+
+// BIP-380 descriptor checksum, fed incrementally
+typedef struct {
+    uint64_t c;
+    uint32_t cls;
+    uint32_t clscount;
+    // a character outside of the descriptor charset was fed
+    bool invalid;
+} descriptor_checksum;
+
+void descriptor_checksum_init(descriptor_checksum *checksum);
+void descriptor_checksum_update(descriptor_checksum *checksum, const char *data, size_t len);
+// writes the checksum characters, not NUL terminated, false if an invalid character was fed
+bool descriptor_checksum_final(const descriptor_checksum *checksum, char out[URC_DESCRIPTOR_CHECKSUM_LEN]);
@@ -4,126 +4,249 @@
 
 #include "internals.h"
 #include "macros.h"
+#include "schema.h"
+#include "trace.h"
 #include "utils.h"
 #include <wally_core.h>
 
 int urc_crypto_eckey_deserialize(const uint8_t *buffer, size_t len, crypto_eckey *out)
 {
+    return urc_crypto_eckey_deserialize_with_profile(buffer, len, out, urc_get_thread_validation_profile());
+}
+
+int urc_crypto_eckey_deserialize_with_profile(const uint8_t *buffer, size_t len, crypto_eckey *out,
+                                              urc_validation_profile profile)
+{
+    trace_span span = trace_begin(urc_trace_type_crypto_eckey, urc_trace_phase_decode);
     CborParser parser;
     CborValue iter;
-    CborError err;
-    err = cbor_parser_init(buffer, len, cbor_flags, &parser, &iter);
-    if (err != CborNoError) {
-        return URC_ECBORINTERNALERROR;
+    int result = init_cbor_parser(buffer, len, profile, &parser, &iter);
+    if (result == URC_OK) {
+        result = urc_crypto_eckey_deserialize_impl(&iter, out);
     }
-    return urc_crypto_eckey_deserialize_impl(&iter, out);
+    trace_end(&span);
+    return result;
 }
 
-int urc_crypto_eckey_deserialize_impl(CborValue *iter, crypto_eckey *out)
+// curve field is optional, if present it must be 0 = secp256k1
+static int curve_parse(CborValue *value, void *out, void *ctx)
 {
-    out->type = eckey_type_na;
+    (void)out;
+    (void)ctx;
     int result = URC_OK;
 
-    CHECK_IS_TYPE(iter, map, result, exit);
-
-    CborValue map_item;
-    CborError err;
-    err = cbor_value_enter_container(iter, &map_item);
+    CHECK_IS_TYPE(value, integer, result, exit);
+    int curve_type;
+    CborError err = cbor_value_get_int_checked(value, &curve_type);
     CHECK_CBOR_ERROR(err, result, exit);
-
-    // curve field is optional,if present it must be 0 = secp256k1
-    if (is_map_key(&map_item, 1)) {
-        ADVANCE(&map_item, result, exit);
-        int curve_type;
-        CHECK_IS_TYPE(&map_item, integer, result, exit)
-        err = cbor_value_get_int(&map_item, &curve_type);
-        CHECK_CBOR_ERROR(err, result, exit);
-        if (curve_type != 0) {
-            result = URC_EUNHANDLEDCASE;
-        }
-        ADVANCE(&map_item, result, exit);
+    if (curve_type != 0) {
+        result = URC_EUNHANDLEDCASE;
+        goto exit;
     }
+    ADVANCE(value, result, exit);
 
-    // private field is optional, false by default
-    bool is_private = false;
-    if (is_map_key(&map_item, 2)) {
-        ADVANCE(&map_item, result, exit);
+exit:
+    return result;
+}
 
-        CHECK_IS_TYPE(&map_item, boolean, result, exit)
-        err = cbor_value_get_boolean(&map_item, &is_private);
-        CHECK_CBOR_ERROR(err, result, exit);
+// private field is optional, false by default
+static int private_parse(CborValue *value, void *out, void *ctx)
+{
+    (void)out;
+    int result = URC_OK;
 
-        ADVANCE(&map_item, result, exit);
-    }
+    CHECK_IS_TYPE(value, boolean, result, exit);
+    CborError err = cbor_value_get_boolean(value, (bool *)ctx);
+    CHECK_CBOR_ERROR(err, result, exit);
+    ADVANCE(value, result, exit);
 
-    result = check_map_key(&map_item, 3);
-    if (result != URC_OK) {
-        goto exit;
-    }
-    ADVANCE(&map_item, result, exit);
+exit:
+    return result;
+}
+
+static int data_parse(CborValue *value, void *out, void *ctx)
+{
+    crypto_eckey *eckey = out;
+    const bool is_private = *(bool *)ctx;
+    int result = URC_OK;
 
     if (is_private) {
-        result = copy_fixed_size_byte_string(&map_item, (uint8_t *)&out->key.prvate, CRYPTO_ECKEY_PRIVATE_SIZE);
+        result = copy_fixed_size_byte_string(value, (uint8_t *)&eckey->key.prvate, CRYPTO_ECKEY_PRIVATE_SIZE);
         if (result != URC_OK) {
             goto exit;
         }
-        out->type = eckey_type_private;
-        goto leave_and_exit;
+        eckey->type = eckey_type_private;
+        goto advance_and_exit;
     }
-    CHECK_IS_TYPE(&map_item, byte_string, result, exit);
+    CHECK_IS_TYPE(value, byte_string, result, exit);
     size_t len;
-    err = cbor_value_get_string_length(&map_item, &len);
+    CborError err = cbor_value_get_string_length(value, &len);
     CHECK_CBOR_ERROR(err, result, exit);
     if (len == CRYPTO_ECKEY_PUBLIC_COMPRESSED_SIZE) {
         result =
-            copy_fixed_size_byte_string(&map_item, (uint8_t *)&out->key.public_compressed, CRYPTO_ECKEY_PUBLIC_COMPRESSED_SIZE);
+            copy_fixed_size_byte_string(value, (uint8_t *)&eckey->key.public_compressed, CRYPTO_ECKEY_PUBLIC_COMPRESSED_SIZE);
         if (result != URC_OK) {
             goto exit;
         }
-        out->type = eckey_type_public_compressed;
-        goto leave_and_exit;
+        eckey->type = eckey_type_public_compressed;
+        goto advance_and_exit;
     }
     if (len == CRYPTO_ECKEY_PUBLIC_UNCOMPRESSED_SIZE) {
-        result = copy_fixed_size_byte_string(&map_item, (uint8_t *)&out->key.public_uncompressed,
+        result = copy_fixed_size_byte_string(value, (uint8_t *)&eckey->key.public_uncompressed,
                                              CRYPTO_ECKEY_PUBLIC_UNCOMPRESSED_SIZE);
         if (result != URC_OK) {
             goto exit;
         }
-        out->type = eckey_type_public_uncompressed;
-        goto leave_and_exit;
+        eckey->type = eckey_type_public_uncompressed;
+        goto advance_and_exit;
     }
     result = URC_EUNHANDLEDCASE;
+    goto exit;
 
-leave_and_exit:
-    ADVANCE(&map_item, result, exit);
-    LEAVE_CONTAINER_SAFELY(iter, &map_item, result, exit);
+advance_and_exit:
+    ADVANCE(value, result, exit);
 exit:
     return result;
 }
 
-int urc_crypto_eckey_format(const crypto_eckey *eckey, char **out)
+static const schema_field eckey_fields[] = {
+    {.key = 1, .kind = schema_kind_custom, .optional = true, .parse = curve_parse},
+    {.key = 2, .kind = schema_kind_custom, .optional = true, .parse = private_parse},
+    {.key = 3, .kind = schema_kind_custom, .parse = data_parse},
+};
+static const schema eckey_schema = SCHEMA(eckey_fields);
+
+int urc_crypto_eckey_deserialize_impl(CborValue *iter, crypto_eckey *out)
 {
-    if (!eckey || !out) {
-        return URC_EINVALIDARG;
+    out->type = eckey_type_na;
+    bool is_private = false;
+    int result = schema_decode_map(&eckey_schema, iter, out, &is_private);
+    if (result != URC_OK) {
+        out->type = eckey_type_na;
     }
+    return result;
+}
 
-    *out = NULL;
-    int wallyerr = WALLY_OK;
+int urc_eckey_getkey(const crypto_eckey *eckey, const uint8_t **key, size_t *key_len)
+{
     switch (eckey->type) {
     case eckey_type_private:
-         wallyerr = wally_hex_from_bytes(eckey->key.prvate, CRYPTO_ECKEY_PRIVATE_SIZE, out);
-        break;
+        *key = eckey->key.prvate;
+        *key_len = CRYPTO_ECKEY_PRIVATE_SIZE;
+        return URC_OK;
     case eckey_type_public_compressed:
-        wallyerr = wally_hex_from_bytes(eckey->key.public_compressed, CRYPTO_ECKEY_PUBLIC_COMPRESSED_SIZE, out);
-        break;
+        *key = eckey->key.public_compressed;
+        *key_len = CRYPTO_ECKEY_PUBLIC_COMPRESSED_SIZE;
+        return URC_OK;
     case eckey_type_public_uncompressed:
-        wallyerr = wally_hex_from_bytes(eckey->key.public_uncompressed, CRYPTO_ECKEY_PUBLIC_UNCOMPRESSED_SIZE, out);
-        break;
+        *key = eckey->key.public_uncompressed;
+        *key_len = CRYPTO_ECKEY_PUBLIC_UNCOMPRESSED_SIZE;
+        return URC_OK;
     default:
         return URC_EINVALIDARG;
     }
-    if (wallyerr != WALLY_OK) {
-        return URC_EWALLYINTERNALERROR;
+}
+
+int urc_crypto_eckey_serialize_impl(CborEncoder *encoder, const crypto_eckey *eckey)
+{
+    const uint8_t *key;
+    size_t key_len;
+    int result = urc_eckey_getkey(eckey, &key, &key_len);
+    if (result != URC_OK) {
+        return result;
     }
-    return URC_OK;
+    // curve is always secp256k1 and left out, as is private for public keys
+    const bool is_private = eckey->type == eckey_type_private;
+    CborEncoder map;
+    CborError err = cbor_encoder_create_map(encoder, &map, is_private ? 2 : 1);
+    CHECK_CBOR_ENCODE_ERROR(err, result, exit);
+    if (is_private) {
+        err = cbor_encode_uint(&map, 2);
+        CHECK_CBOR_ENCODE_ERROR(err, result, exit);
+        err = cbor_encode_boolean(&map, true);
+        CHECK_CBOR_ENCODE_ERROR(err, result, exit);
+    }
+    err = cbor_encode_uint(&map, 3);
+    CHECK_CBOR_ENCODE_ERROR(err, result, exit);
+    err = cbor_encode_byte_string(&map, key, key_len);
+    CHECK_CBOR_ENCODE_ERROR(err, result, exit);
+    err = cbor_encoder_close_container(encoder, &map);
+    CHECK_CBOR_ENCODE_ERROR(err, result, exit);
+
+exit:
+    return result;
+}
+
+static int eckey_serialize(CborEncoder *encoder, const void *in) { return urc_crypto_eckey_serialize_impl(encoder, in); }
+
+int urc_crypto_eckey_serialize(const crypto_eckey *eckey, uint8_t **cbor_out, size_t *cbor_len)
+{
+    if (!eckey || !cbor_out || !cbor_len) {
+        return URC_EINVALIDARG;
+    }
+    return serialize_alloc(eckey_serialize, eckey, cbor_out, cbor_len);
+}
+
+int urc_crypto_eckey_serialize_to_buffer(const crypto_eckey *eckey, uint8_t *out, size_t out_len, size_t *cbor_len)
+{
+    if (!eckey || (!out && out_len) || !cbor_len) {
+        return URC_EINVALIDARG;
+    }
+    return serialize_to_buffer(eckey_serialize, eckey, out, out_len, cbor_len);
+}
+
+int urc_crypto_eckey_format(const crypto_eckey *eckey, char **out)
+{
+    if (!eckey || !out) {
+        return URC_EINVALIDARG;
+    }
+
+    *out = NULL;
+    trace_span span = trace_begin(urc_trace_type_crypto_eckey, urc_trace_phase_format);
+    const uint8_t *key = NULL;
+    size_t key_len = 0;
+    int result = urc_eckey_getkey(eckey, &key, &key_len);
+    if (result != URC_OK) {
+        goto exit;
+    }
+
+    *out = urc_malloc(key_len * 2 + 1);
+    if (!*out) {
+        result = URC_ENOMEM;
+        goto exit;
+    }
+    urc_writer writer;
+    writer_init(&writer, *out, key_len * 2 + 1);
+    writer_append_hex(&writer, key, key_len);
+
+exit:
+    trace_end(&span);
+    return result;
+}
+
+int urc_crypto_eckey_format_to_buffer(const crypto_eckey *eckey, char *out, size_t out_len, size_t *key_len)
+{
+    if (!eckey || (!out && out_len) || !key_len) {
+        return URC_EINVALIDARG;
+    }
+
+    trace_span span = trace_begin(urc_trace_type_crypto_eckey, urc_trace_phase_format);
+    const uint8_t *key = NULL;
+    size_t len = 0;
+    int result = urc_eckey_getkey(eckey, &key, &len);
+    if (result != URC_OK) {
+        goto exit;
+    }
+    *key_len = len * 2;
+    if (out_len <= *key_len) {
+        result = URC_EBUFFERTOOSMALL;
+        goto exit;
+    }
+    urc_writer writer;
+    writer_init(&writer, out, out_len);
+    writer_append_hex(&writer, key, len);
+
+exit:
+    trace_end(&span);
+    return result;
 }
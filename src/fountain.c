@@ -0,0 +1,202 @@
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#include "wally_core.h"
+#include "wally_crypto.h"
+
+#include "urc/core.h"
+#include "urc/error.h"
+
+#include "fountain.h"
+#include "utils.h"
+
+int fountain_rng_init(fountain_rng *rng, const uint8_t *seed, size_t seed_len)
+{
+    uint8_t digest[SHA256_LEN];
+    if (wally_sha256(seed, seed_len, digest, sizeof(digest)) != WALLY_OK) {
+        return URC_EWALLYINTERNALERROR;
+    }
+    for (size_t word = 0; word < 4; word++) {
+        uint64_t value = 0;
+        for (size_t idx = 0; idx < 8; idx++) {
+            value = value << 8 | digest[word * 8 + idx];
+        }
+        rng->s[word] = value;
+    }
+    return URC_OK;
+}
+
+static inline uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+uint64_t fountain_rng_next(fountain_rng *rng)
+{
+    uint64_t *s = rng->s;
+    const uint64_t result = rotl(s[1] * 5, 7) * 9;
+    const uint64_t t = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl(s[3], 45);
+    return result;
+}
+
+// as bc-ur: the division by 2^64 rounds values close to UINT64_MAX up to 1, callers clamp
+double fountain_rng_next_double(fountain_rng *rng) { return (double)fountain_rng_next(rng) / 18446744073709551616.0; }
+
+// [0, count)
+static uint32_t next_index(fountain_rng *rng, uint32_t count)
+{
+    const uint64_t index = (uint64_t)(fountain_rng_next_double(rng) * (double)count);
+    return index < count ? (uint32_t)index : count - 1;
+}
+
+void fountain_sampler_free(urc_fountain_sampler *sampler)
+{
+    if (!sampler) {
+        return;
+    }
+    urc_free(sampler->probs);
+    urc_free(sampler->aliases);
+    urc_free(sampler->remaining);
+    memset(sampler, 0, sizeof(*sampler));
+}
+
+int fountain_sampler_init(urc_fountain_sampler *sampler, uint32_t seq_len)
+{
+    memset(sampler, 0, sizeof(*sampler));
+    if (seq_len == 0) {
+        return URC_EINVALIDARG;
+    }
+    const size_t count = seq_len;
+    sampler->probs = urc_malloc(sizeof(double) * count);
+    sampler->aliases = urc_malloc(sizeof(uint32_t) * count);
+    sampler->remaining = urc_malloc(sizeof(uint32_t) * count);
+    double *scaled = urc_malloc(sizeof(double) * count);
+    uint32_t *small = urc_malloc(sizeof(uint32_t) * count);
+    uint32_t *large = urc_malloc(sizeof(uint32_t) * count);
+    int result = URC_OK;
+    if (!sampler->probs || !sampler->aliases || !sampler->remaining || !scaled || !small || !large) {
+        result = URC_ENOMEM;
+        goto exit;
+    }
+    sampler->seq_len = seq_len;
+
+    // same operations in the same order as bc-ur's RandomSampler, floating point results must match
+    double sum = 0;
+    for (size_t idx = 0; idx < count; idx++) {
+        sum += 1.0 / (double)(idx + 1);
+    }
+    size_t small_count = 0;
+    size_t large_count = 0;
+    for (size_t idx = count; idx-- > 0;) {
+        scaled[idx] = (1.0 / (double)(idx + 1)) * (double)count / sum;
+        if (scaled[idx] < 1) {
+            small[small_count++] = (uint32_t)idx;
+        } else {
+            large[large_count++] = (uint32_t)idx;
+        }
+        sampler->probs[idx] = 0;
+        sampler->aliases[idx] = 0;
+    }
+    while (small_count && large_count) {
+        const uint32_t less = small[--small_count];
+        const uint32_t greater = large[--large_count];
+        sampler->probs[less] = scaled[less];
+        sampler->aliases[less] = greater;
+        scaled[greater] += scaled[less] - 1;
+        if (scaled[greater] < 1) {
+            small[small_count++] = greater;
+        } else {
+            large[large_count++] = greater;
+        }
+    }
+    while (large_count) {
+        sampler->probs[large[--large_count]] = 1;
+    }
+    // numerical instability only
+    while (small_count) {
+        sampler->probs[small[--small_count]] = 1;
+    }
+
+exit:
+    urc_free(scaled);
+    urc_free(small);
+    urc_free(large);
+    if (result != URC_OK) {
+        fountain_sampler_free(sampler);
+    }
+    return result;
+}
+
+int fountain_choose_fragments(urc_fountain_sampler *sampler, uint32_t seq_num, uint32_t checksum, uint32_t *indexes,
+                              uint32_t *degree)
+{
+    const uint32_t seq_len = sampler->seq_len;
+    if (seq_num <= seq_len) {
+        indexes[0] = seq_num - 1;
+        *degree = 1;
+        return URC_OK;
+    }
+
+    const uint8_t seed[8] = {
+        (uint8_t)(seq_num >> 24),  (uint8_t)(seq_num >> 16),  (uint8_t)(seq_num >> 8),  (uint8_t)seq_num,
+        (uint8_t)(checksum >> 24), (uint8_t)(checksum >> 16), (uint8_t)(checksum >> 8), (uint8_t)checksum,
+    };
+    fountain_rng rng;
+    int result = fountain_rng_init(&rng, seed, sizeof(seed));
+    if (result != URC_OK) {
+        return result;
+    }
+
+    const uint32_t sampled = next_index(&rng, seq_len);
+    const double threshold = fountain_rng_next_double(&rng);
+    const uint32_t count = (threshold < sampler->probs[sampled] ? sampled : sampler->aliases[sampled]) + 1;
+
+    // the first ``count`` picks of bc-ur's shuffle, which draws one index per pick out of the remaining ones
+    for (uint32_t idx = 0; idx < seq_len; idx++) {
+        sampler->remaining[idx] = idx;
+    }
+    uint32_t remaining_count = seq_len;
+    for (uint32_t pick = 0; pick < count; pick++) {
+        const uint32_t idx = next_index(&rng, remaining_count);
+        indexes[pick] = sampler->remaining[idx];
+        memmove(&sampler->remaining[idx], &sampler->remaining[idx + 1], sizeof(uint32_t) * (remaining_count - idx - 1));
+        remaining_count--;
+    }
+    *degree = count;
+    return URC_OK;
+}
+
+void fountain_xor(uint8_t *dst, const uint8_t *src, size_t len)
+{
+    size_t idx = 0;
+#if defined(__SSE2__)
+    for (; idx + 16 <= len; idx += 16) {
+        const __m128i value = _mm_loadu_si128((const __m128i *)&dst[idx]);
+        const __m128i other = _mm_loadu_si128((const __m128i *)&src[idx]);
+        _mm_storeu_si128((__m128i *)&dst[idx], _mm_xor_si128(value, other));
+    }
+#elif defined(__ARM_NEON)
+    for (; idx + 16 <= len; idx += 16) {
+        vst1q_u8(&dst[idx], veorq_u8(vld1q_u8(&dst[idx]), vld1q_u8(&src[idx])));
+    }
+#endif
+    for (; idx + 8 <= len; idx += 8) {
+        uint64_t value;
+        uint64_t other;
+        memcpy(&value, &dst[idx], sizeof(value));
+        memcpy(&other, &src[idx], sizeof(other));
+        value ^= other;
+        memcpy(&dst[idx], &value, sizeof(value));
+    }
+    for (; idx < len; idx++) {
+        dst[idx] ^= src[idx];
+    }
+}
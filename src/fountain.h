@@ -0,0 +1,30 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "urc/fountain.h"
+
+// fragment selection, bit for bit as in bc-ur: any difference in the random numbers or in the order they are drawn
+// changes the fragments mixed into a part
+
+// xoshiro256**, seeded with the sha256 of the seed read as four big endian words
+typedef struct {
+    uint64_t s[4];
+} fountain_rng;
+
+int fountain_rng_init(fountain_rng *rng, const uint8_t *seed, size_t seed_len);
+uint64_t fountain_rng_next(fountain_rng *rng);
+// [0, 1)
+double fountain_rng_next_double(fountain_rng *rng);
+
+// Vose's alias method over the number of fragments mixed into a part, P(degree) proportional to 1 / degree
+int fountain_sampler_init(urc_fountain_sampler *sampler, uint32_t seq_len);
+void fountain_sampler_free(urc_fountain_sampler *sampler);
+
+// ``indexes`` receives the fragments of part ``seq_num``, up to seq_len of them, in no particular order
+int fountain_choose_fragments(urc_fountain_sampler *sampler, uint32_t seq_num, uint32_t checksum, uint32_t *indexes,
+                              uint32_t *degree);
+
+// dst ^= src, 16 bytes at a time where SSE2 or NEON are available
+void fountain_xor(uint8_t *dst, const uint8_t *src, size_t len);
@@ -9,289 +9,229 @@
 
 #include "wally_bip32.h"
 #include "wally_core.h"
+#include "wally_crypto.h"
 
 #include "urc/crypto_hdkey.h"
 #include "urc/tags.h"
 
 #include "internals.h"
 #include "macros.h"
+#include "schema.h"
+#include "trace.h"
 #include "utils.h"
+#include "writer.h"
 
-int urc_crypto_hdkey_masterkey_parse(CborValue *iter, hd_master_key *out);
-int urc_crypto_hdkey_derivedkey_parse(CborValue *iter, hd_derived_key *out);
+int urc_crypto_hdkey_masterkey_parse(CborValue *map_item, hd_master_key *out);
+int urc_crypto_hdkey_derivedkey_parse(CborValue *map_item, hd_derived_key *out);
 int urc_crypto_hdkey_coininfo_parse(CborValue *iter, crypto_coininfo *out);
 int urc_crypto_hdkey_keypath_parse(CborValue *iter, crypto_keypath *out);
 int urc_crypto_hdkey_pathcomponent_parse(CborValue *iter, path_component *out);
 
 int urc_crypto_hdkey_deserialize(const uint8_t *buffer, size_t len, crypto_hdkey *out)
 {
-    CborParser parser;
-    CborValue iter;
-    CborError err;
-    err = cbor_parser_init(buffer, len, cbor_flags, &parser, &iter);
-    if (err != CborNoError) {
-        return URC_ECBORINTERNALERROR;
-    }
-    return urc_crypto_hdkey_deserialize_impl(&iter, out);
+    return urc_crypto_hdkey_deserialize_with_profile(buffer, len, out, urc_get_thread_validation_profile());
 }
 
-int urc_crypto_hdkey_deserialize_impl(CborValue *iter, crypto_hdkey *out)
+int urc_crypto_hdkey_deserialize_with_profile(const uint8_t *buffer, size_t len, crypto_hdkey *out,
+                                              urc_validation_profile profile)
 {
-    int result = URC_OK;
-    out->type = hdkey_type_na;
-
-    result = urc_crypto_hdkey_masterkey_parse(iter, &out->key.master);
-    // NOTE: invered than expected logic
+    trace_span span = trace_begin(urc_trace_type_crypto_hdkey, urc_trace_phase_decode);
+    CborParser parser;
+    CborValue iter;
+    int result = init_cbor_parser(buffer, len, profile, &parser, &iter);
     if (result == URC_OK) {
-        out->type = hdkey_type_master;
-        goto exit;
+        result = urc_crypto_hdkey_deserialize_impl(&iter, out);
     }
-
-    result = urc_crypto_hdkey_derivedkey_parse(iter, &out->key.derived);
-    if (result != URC_OK) {
-        goto exit;
-    }
-    out->type = hdkey_type_derived;
-
-exit:
+    trace_end(&span);
     return result;
 }
 
-int urc_crypto_hdkey_masterkey_parse(CborValue *iter, hd_master_key *out)
+int urc_crypto_hdkey_deserialize_impl(CborValue *iter, crypto_hdkey *out)
 {
     int result = URC_OK;
+    out->type = hdkey_type_na;
 
     CHECK_IS_TYPE(iter, map, result, exit);
     CborValue map_item;
     CborError err = cbor_value_enter_container(iter, &map_item);
-
-    result = check_map_key(&map_item, 1);
-    if (result != URC_OK) {
-        goto exit;
-    }
-    ADVANCE(&map_item, result, exit);
-    CHECK_IS_TYPE(&map_item, boolean, result, exit);
-    err = cbor_value_get_boolean(&map_item, &out->is_master);
     CHECK_CBOR_ERROR(err, result, exit);
-    ADVANCE(&map_item, result, exit);
-
-    result = check_map_key(&map_item, 3);
-    if (result != URC_OK) {
-        goto exit;
-    }
-    ADVANCE(&map_item, result, exit);
-    CHECK_IS_TYPE(&map_item, byte_string, result, exit);
-    result = copy_fixed_size_byte_string(&map_item, (uint8_t *)&out->keydata, CRYPTO_HDKEY_KEYDATA_SIZE);
-    if (result != URC_OK) {
-        goto exit;
-    }
-    ADVANCE(&map_item, result, exit);
 
-    result = check_map_key(&map_item, 4);
-    if (result != URC_OK) {
-        goto exit;
+    // is-master (key 1) only ever appears in a master key and, keys being sorted, it comes first:
+    // peeking at it picks the right parser without walking the map twice
+    int type;
+    if (is_map_key(&map_item, 1)) {
+        result = urc_crypto_hdkey_masterkey_parse(&map_item, &out->key.master);
+        type = hdkey_type_master;
+    } else {
+        result = urc_crypto_hdkey_derivedkey_parse(&map_item, &out->key.derived);
+        type = hdkey_type_derived;
     }
-    ADVANCE(&map_item, result, exit);
-    CHECK_IS_TYPE(&map_item, byte_string, result, exit);
-    result = copy_fixed_size_byte_string(&map_item, (uint8_t *)&out->chaincode, CRYPTO_HDKEY_CHAINCODE_SIZE);
     if (result != URC_OK) {
         goto exit;
     }
-    ADVANCE(&map_item, result, exit);
 
     LEAVE_CONTAINER_SAFELY(iter, &map_item, result, exit);
+    out->type = type;
 
 exit:
     return result;
 }
 
-int urc_crypto_hdkey_derivedkey_parse(CborValue *iter, hd_derived_key *out)
+static int text_parse(CborValue *value, char *buffer, size_t buffer_size, urc_text_view *view)
 {
     int result = URC_OK;
 
-    CHECK_IS_TYPE(iter, map, result, exit);
-    CborValue map_item;
-    CborError err = cbor_value_enter_container(iter, &map_item);
-
-    out->is_private = false;
-    if (is_map_key(&map_item, 2)) {
-        ADVANCE(&map_item, result, exit);
-        CHECK_IS_TYPE(&map_item, boolean, result, exit);
-        err = cbor_value_get_boolean(&map_item, &out->is_private);
+    CHECK_IS_TYPE(value, text_string, result, exit);
+    // chunked strings have no view, the truncated copy below is still there
+    if (borrow_text_string(value, &view->text, &view->len) != URC_OK) {
+        view->text = NULL;
+        view->len = 0;
+    }
+    size_t len = buffer_size;
+    CborError err = cbor_value_copy_text_string(value, buffer, &len, NULL);
+    // If the text is too long, truncate it and null-terminate it.
+    if (err == CborErrorOutOfMemory) {
+        buffer[buffer_size - 1] = '\0';
+    } else {
         CHECK_CBOR_ERROR(err, result, exit);
-        ADVANCE(&map_item, result, exit);
     }
+    ADVANCE(value, result, exit);
 
-    result = check_map_key(&map_item, 3);
-    if (result != URC_OK) {
-        goto exit;
-    }
-    ADVANCE(&map_item, result, exit);
-    CHECK_IS_TYPE(&map_item, byte_string, result, exit);
-    result = copy_fixed_size_byte_string(&map_item, (uint8_t *)&out->keydata, CRYPTO_HDKEY_KEYDATA_SIZE);
-    if (result != URC_OK) {
-        goto exit;
-    }
-    ADVANCE(&map_item, result, exit);
+exit:
+    return result;
+}
 
-    out->valid_chaincode = false;
-    if (is_map_key(&map_item, 4)) {
-        ADVANCE(&map_item, result, exit);
+static int name_parse(CborValue *value, void *out, void *ctx)
+{
+    (void)ctx;
+    hd_derived_key *key = out;
+    return text_parse(value, key->name, NAME_BUFFER_SIZE, &key->name_view);
+}
 
-        CHECK_IS_TYPE(&map_item, byte_string, result, exit);
-        result = copy_fixed_size_byte_string(&map_item, (uint8_t *)&out->chaincode, CRYPTO_HDKEY_CHAINCODE_SIZE);
-        if (result != URC_OK) {
-            goto exit;
-        }
-        out->valid_chaincode = true;
-        ADVANCE(&map_item, result, exit);
-    }
+static int note_parse(CborValue *value, void *out, void *ctx)
+{
+    (void)ctx;
+    hd_derived_key *key = out;
+    return text_parse(value, key->note, NOTE_BUFFER_SIZE, &key->note_view);
+}
+
+static int useinfo_parse(CborValue *value, void *out, void *ctx)
+{
+    (void)ctx;
+    return urc_crypto_hdkey_coininfo_parse(value, &((hd_derived_key *)out)->useinfo);
+}
 
+static int origin_parse(CborValue *value, void *out, void *ctx)
+{
+    (void)ctx;
+    return urc_crypto_hdkey_keypath_parse(value, &((hd_derived_key *)out)->origin);
+}
+
+static int children_parse(CborValue *value, void *out, void *ctx)
+{
+    (void)ctx;
+    return urc_crypto_hdkey_keypath_parse(value, &((hd_derived_key *)out)->children);
+}
+
+static const schema_field masterkey_fields[] = {
+    {.key = 1, .kind = schema_kind_bool, .offset = offsetof(hd_master_key, is_master)},
+    {.key = 3, .kind = schema_kind_bytes, .offset = offsetof(hd_master_key, keydata), .size = CRYPTO_HDKEY_KEYDATA_SIZE},
+    {.key = 4, .kind = schema_kind_bytes, .offset = offsetof(hd_master_key, chaincode), .size = CRYPTO_HDKEY_CHAINCODE_SIZE},
+};
+static const schema masterkey_schema = SCHEMA(masterkey_fields);
+
+static const schema_field derivedkey_fields[] = {
+    {.key = 2, .kind = schema_kind_bool, .optional = true, .offset = offsetof(hd_derived_key, is_private)},
+    {.key = 3, .kind = schema_kind_bytes, .offset = offsetof(hd_derived_key, keydata), .size = CRYPTO_HDKEY_KEYDATA_SIZE},
+    {.key = 4,
+     .kind = schema_kind_bytes,
+     .optional = true,
+     .offset = offsetof(hd_derived_key, chaincode),
+     .size = CRYPTO_HDKEY_CHAINCODE_SIZE,
+     .presence = SCHEMA_PRESENCE(hd_derived_key, valid_chaincode)},
+    {.key = 5, .kind = schema_kind_custom, .optional = true, .tag = urc_urtypes_tags_crypto_coin_info, .parse = useinfo_parse},
+    {.key = 6, .kind = schema_kind_custom, .optional = true, .tag = urc_urtypes_tags_crypto_keypath, .parse = origin_parse},
+    {.key = 7, .kind = schema_kind_custom, .optional = true, .tag = urc_urtypes_tags_crypto_keypath, .parse = children_parse},
+    {.key = 8, .kind = schema_kind_uint32, .optional = true, .offset = offsetof(hd_derived_key, parent_fingerprint)},
+    {.key = 9, .kind = schema_kind_custom, .optional = true, .parse = name_parse},
+    {.key = 10, .kind = schema_kind_custom, .optional = true, .parse = note_parse},
+};
+static const schema derivedkey_schema = SCHEMA(derivedkey_fields);
+
+static const schema_field coininfo_fields[] = {
+    {.key = 1, .kind = schema_kind_uint32, .optional = true, .offset = offsetof(crypto_coininfo, type)},
+    {.key = 2, .kind = schema_kind_int32, .optional = true, .offset = offsetof(crypto_coininfo, network)},
+};
+static const schema coininfo_schema = SCHEMA(coininfo_fields);
+
+static int keypath_components_parse(CborValue *value, void *out, void *ctx);
+
+static const schema_field keypath_fields[] = {
+    {.key = 1, .kind = schema_kind_custom, .parse = keypath_components_parse},
+    {.key = 2, .kind = schema_kind_uint32, .optional = true, .offset = offsetof(crypto_keypath, source_fingerprint)},
+    {.key = 3, .kind = schema_kind_uint8, .optional = true, .offset = offsetof(crypto_keypath, depth)},
+};
+static const schema keypath_schema = SCHEMA(keypath_fields);
+
+// ``map_item`` points to the first key of an already entered map, the caller leaves the container
+int urc_crypto_hdkey_masterkey_parse(CborValue *map_item, hd_master_key *out)
+{
+    return schema_decode_entries(&masterkey_schema, map_item, out, NULL);
+}
+
+// ``map_item`` points to the first key of an already entered map, the caller leaves the container
+int urc_crypto_hdkey_derivedkey_parse(CborValue *map_item, hd_derived_key *out)
+{
+    out->is_private = false;
+    out->valid_chaincode = false;
     out->useinfo.network = CRYPTO_COININFO_MAINNET;
     out->useinfo.type = CRYPTO_COININFO_TYPE_BTC;
-    if (is_map_key(&map_item, 5)) {
-        ADVANCE(&map_item, result, exit);
-        result = check_tag(&map_item, urc_urtypes_tags_crypto_coin_info);
-        if (result != URC_OK) {
-            goto exit;
-        }
-        ADVANCE(&map_item, result, exit);
-        result = urc_crypto_hdkey_coininfo_parse(&map_item, &out->useinfo);
-        if (result != URC_OK) {
-            goto exit;
-        }
-    }
-
     out->origin.components_count = 0;
     out->origin.depth = 0;
     out->origin.source_fingerprint = 0;
-    if (is_map_key(&map_item, 6)) {
-        ADVANCE(&map_item, result, exit);
-        result = check_tag(&map_item, urc_urtypes_tags_crypto_keypath);
-        if (result != URC_OK) {
-            goto exit;
-        }
-        ADVANCE(&map_item, result, exit);
-        result = urc_crypto_hdkey_keypath_parse(&map_item, &out->origin);
-        if (result != URC_OK) {
-            goto exit;
-        }
-    }
-
     out->children.components_count = 0;
     out->children.depth = 0;
     out->children.source_fingerprint = 0;
-    if (is_map_key(&map_item, 7)) {
-        ADVANCE(&map_item, result, exit);
-        result = check_tag(&map_item, urc_urtypes_tags_crypto_keypath);
-        if (result != URC_OK) {
-            goto exit;
-        }
-        ADVANCE(&map_item, result, exit);
-        result = urc_crypto_hdkey_keypath_parse(&map_item, &out->children);
-        if (result != URC_OK) {
-            goto exit;
-        }
-    }
-
     out->parent_fingerprint = 0;
-    if (is_map_key(&map_item, 8)) {
-        ADVANCE(&map_item, result, exit);
-        CHECK_IS_TYPE(&map_item, unsigned_integer, result, exit);
-        err = cbor_value_get_int(&map_item, (int *)&out->parent_fingerprint);
-        CHECK_CBOR_ERROR(err, result, exit);
-        ADVANCE(&map_item, result, exit);
-    }
-
     memset(&out->name, 0, NAME_BUFFER_SIZE);
-    if (is_map_key(&map_item, 9)) {
-        ADVANCE(&map_item, result, exit);
-        CHECK_IS_TYPE(&map_item, text_string, result, exit);
-        size_t len = NAME_BUFFER_SIZE;
-        err = cbor_value_copy_text_string(&map_item, (char *)&out->name, &len, NULL);
-        // If the name is too long, truncate it and null-terminate it.
-        if (err == CborErrorOutOfMemory) {
-            out->name[NAME_BUFFER_SIZE - 1] = '\0';
-        } else {
-            CHECK_CBOR_ERROR(err, result, exit);
-        }
-        ADVANCE(&map_item, result, exit);
-    }
-
+    out->name_view.text = NULL;
+    out->name_view.len = 0;
     memset(&out->note, 0, NOTE_BUFFER_SIZE);
-    if (is_map_key(&map_item, 10)) {
-        ADVANCE(&map_item, result, exit);
-        CHECK_IS_TYPE(&map_item, text_string, result, exit);
-        size_t len = NOTE_BUFFER_SIZE;
-        err = cbor_value_copy_text_string(&map_item, (char *)&out->note, &len, NULL);
-        // If the note is too long, truncate it and null-terminate it.
-        if (err == CborErrorOutOfMemory) {
-            out->note[NOTE_BUFFER_SIZE - 1] = '\0';
-        } else {
-            CHECK_CBOR_ERROR(err, result, exit);
-        }
-        ADVANCE(&map_item, result, exit);
-    }
+    out->note_view.text = NULL;
+    out->note_view.len = 0;
 
-    LEAVE_CONTAINER_SAFELY(iter, &map_item, result, exit);
-
-exit:
-    return result;
+    return schema_decode_entries(&derivedkey_schema, map_item, out, NULL);
 }
 
 int urc_crypto_hdkey_coininfo_parse(CborValue *iter, crypto_coininfo *out)
 {
-    int result = URC_OK;
-
-    CHECK_IS_TYPE(iter, map, result, exit);
-    CborValue map_item;
-    CborError err = cbor_value_enter_container(iter, &map_item);
-    CHECK_CBOR_ERROR(err, result, exit);
-
     out->type = CRYPTO_COININFO_TYPE_BTC;
-    if (is_map_key(&map_item, 1)) {
-        ADVANCE(&map_item, result, exit);
-        CHECK_IS_TYPE(&map_item, unsigned_integer, result, exit);
-        CborError err = cbor_value_get_int(&map_item, (int *)&out->type);
-        CHECK_CBOR_ERROR(err, result, exit);
-        ADVANCE(&map_item, result, exit);
-    }
-
     out->network = CRYPTO_COININFO_MAINNET;
-    if (is_map_key(&map_item, 2)) {
-        ADVANCE(&map_item, result, exit);
-        CHECK_IS_TYPE(&map_item, integer, result, exit);
-        CborError err = cbor_value_get_int(&map_item, (int *)&out->network);
-        CHECK_CBOR_ERROR(err, result, exit);
-        ADVANCE(&map_item, result, exit);
-    }
-
-    LEAVE_CONTAINER_SAFELY(iter, &map_item, result, exit);
-
-exit:
-    return result;
+    return schema_decode_map(&coininfo_schema, iter, out, NULL);
 }
 
 int urc_crypto_hdkey_keypath_parse(CborValue *iter, crypto_keypath *out)
 {
-    int result = URC_OK;
+    out->components_count = 0;
+    out->source_fingerprint = 0;
     out->depth = 0;
 
-    CHECK_IS_TYPE(iter, map, result, exit);
+    int result = schema_decode_map(&keypath_schema, iter, out, NULL);
+    if (result == URC_OK && out->components_count == 0 && out->source_fingerprint == 0) {
+        result = URC_EUNHANDLEDCASE;
+    }
+    return result;
+}
 
-    CborValue map_item;
-    CborError err;
-    err = cbor_value_enter_container(iter, &map_item);
-    CHECK_CBOR_ERROR(err, result, exit);
+static int keypath_components_parse(CborValue *value, void *out, void *ctx)
+{
+    (void)ctx;
+    crypto_keypath *keypath = out;
+    int result = URC_OK;
 
-    result = check_map_key(&map_item, 1);
-    if (result != URC_OK) {
-        goto exit;
-    }
-    ADVANCE(&map_item, result, exit);
-    CHECK_IS_TYPE(&map_item, array, result, exit);
+    CHECK_IS_TYPE(value, array, result, exit);
     size_t len = 0;
-    err = cbor_value_get_array_length(&map_item, &len);
+    CborError err = cbor_value_get_array_length(value, &len);
     CHECK_CBOR_ERROR(err, result, exit);
     // NOTE: every path component is made of two elements
     if (len / 2 > CRYPTO_KEYPATH_MAX_COMPONENTS) {
@@ -299,42 +239,17 @@ int urc_crypto_hdkey_keypath_parse(CborValue *iter, crypto_keypath *out)
         goto exit;
     }
     CborValue comp_item;
-    err = cbor_value_enter_container(&map_item, &comp_item);
+    err = cbor_value_enter_container(value, &comp_item);
     CHECK_CBOR_ERROR(err, result, exit);
     int idx = 0;
     while (!cbor_value_at_end(&comp_item) && idx < CRYPTO_KEYPATH_MAX_COMPONENTS) {
-        result = urc_crypto_hdkey_pathcomponent_parse(&comp_item, &out->components[idx++]);
+        result = urc_crypto_hdkey_pathcomponent_parse(&comp_item, &keypath->components[idx++]);
         if (result != URC_OK) {
             goto exit;
         }
     }
-    out->components_count = idx;
-    LEAVE_CONTAINER_SAFELY(&map_item, &comp_item, result, exit);
-
-    out->source_fingerprint = 0;
-    if (is_map_key(&map_item, 2)) {
-        ADVANCE(&map_item, result, exit);
-        CHECK_IS_TYPE(&map_item, unsigned_integer, result, exit);
-        err = cbor_value_get_int(&map_item, (int *)&out->source_fingerprint);
-        CHECK_CBOR_ERROR(err, result, exit);
-        ADVANCE(&map_item, result, exit);
-    }
-
-    if (is_map_key(&map_item, 3)) {
-        ADVANCE(&map_item, result, exit);
-        CHECK_IS_TYPE(&map_item, unsigned_integer, result, exit);
-        int val;
-        err = cbor_value_get_int(&map_item, &val);
-        CHECK_CBOR_ERROR(err, result, exit);
-        out->depth = val;
-        ADVANCE(&map_item, result, exit);
-    }
-
-    if (out->components_count == 0 && out->source_fingerprint == 0) {
-        result = URC_EUNHANDLEDCASE;
-    }
-
-    LEAVE_CONTAINER_SAFELY(iter, &map_item, result, exit);
+    keypath->components_count = idx;
+    LEAVE_CONTAINER_SAFELY(value, &comp_item, result, exit);
 
 exit:
     return result;
@@ -472,6 +387,304 @@ exit:
     return result;
 }
 
+static int index_component_serialize(CborEncoder *encoder, const child_index_component *component)
+{
+    int result = URC_OK;
+    CborError err = cbor_encode_uint(encoder, component->index);
+    CHECK_CBOR_ENCODE_ERROR(err, result, exit);
+    err = cbor_encode_boolean(encoder, component->is_hardened);
+    CHECK_CBOR_ENCODE_ERROR(err, result, exit);
+
+exit:
+    return result;
+}
+
+// CBOR items each component takes in the components array
+static size_t pathcomponent_items(const path_component *component)
+{
+    return component->type == path_component_type_pair ? 1 : 2;
+}
+
+static int pathcomponent_serialize(CborEncoder *encoder, const path_component *component)
+{
+    int result = URC_OK;
+    CborEncoder array;
+    CborError err;
+    switch (component->type) {
+    case path_component_type_index:
+        return index_component_serialize(encoder, &component->component.index);
+    case path_component_type_range:
+        err = cbor_encoder_create_array(encoder, &array, 2);
+        CHECK_CBOR_ENCODE_ERROR(err, result, exit);
+        err = cbor_encode_uint(&array, component->component.range.low);
+        CHECK_CBOR_ENCODE_ERROR(err, result, exit);
+        err = cbor_encode_uint(&array, component->component.range.high);
+        CHECK_CBOR_ENCODE_ERROR(err, result, exit);
+        err = cbor_encoder_close_container(encoder, &array);
+        CHECK_CBOR_ENCODE_ERROR(err, result, exit);
+        err = cbor_encode_boolean(encoder, component->component.range.is_hardened);
+        CHECK_CBOR_ENCODE_ERROR(err, result, exit);
+        break;
+    case path_component_type_wildcard:
+        err = cbor_encoder_create_array(encoder, &array, 0);
+        CHECK_CBOR_ENCODE_ERROR(err, result, exit);
+        err = cbor_encoder_close_container(encoder, &array);
+        CHECK_CBOR_ENCODE_ERROR(err, result, exit);
+        err = cbor_encode_boolean(encoder, component->component.wildcard.is_hardened);
+        CHECK_CBOR_ENCODE_ERROR(err, result, exit);
+        break;
+    case path_component_type_pair:
+        err = cbor_encoder_create_array(encoder, &array, 4);
+        CHECK_CBOR_ENCODE_ERROR(err, result, exit);
+        result = index_component_serialize(&array, &component->component.pair.internal);
+        if (result != URC_OK) {
+            goto exit;
+        }
+        result = index_component_serialize(&array, &component->component.pair.external);
+        if (result != URC_OK) {
+            goto exit;
+        }
+        err = cbor_encoder_close_container(encoder, &array);
+        CHECK_CBOR_ENCODE_ERROR(err, result, exit);
+        break;
+    default:
+        result = URC_EINVALIDARG;
+    }
+
+exit:
+    return result;
+}
+
+static bool keypath_is_empty(const crypto_keypath *keypath)
+{
+    return keypath->components_count == 0 && keypath->source_fingerprint == 0;
+}
+
+// tagged, source fingerprint and depth are left out when 0
+static int keypath_serialize(CborEncoder *encoder, const crypto_keypath *keypath)
+{
+    int result = URC_OK;
+    if (keypath->components_count > CRYPTO_KEYPATH_MAX_COMPONENTS) {
+        return URC_EINVALIDARG;
+    }
+    size_t items = 0;
+    for (size_t idx = 0; idx < keypath->components_count; idx++) {
+        items += pathcomponent_items(&keypath->components[idx]);
+    }
+
+    CborError err = cbor_encode_tag(encoder, urc_urtypes_tags_crypto_keypath);
+    CHECK_CBOR_ENCODE_ERROR(err, result, exit);
+    CborEncoder map;
+    err = cbor_encoder_create_map(encoder, &map, 1 + (keypath->source_fingerprint != 0) + (keypath->depth != 0));
+    CHECK_CBOR_ENCODE_ERROR(err, result, exit);
+    err = cbor_encode_uint(&map, 1);
+    CHECK_CBOR_ENCODE_ERROR(err, result, exit);
+    CborEncoder components;
+    err = cbor_encoder_create_array(&map, &components, items);
+    CHECK_CBOR_ENCODE_ERROR(err, result, exit);
+    for (size_t idx = 0; idx < keypath->components_count; idx++) {
+        result = pathcomponent_serialize(&components, &keypath->components[idx]);
+        if (result != URC_OK) {
+            goto exit;
+        }
+    }
+    err = cbor_encoder_close_container(&map, &components);
+    CHECK_CBOR_ENCODE_ERROR(err, result, exit);
+    if (keypath->source_fingerprint) {
+        err = cbor_encode_uint(&map, 2);
+        CHECK_CBOR_ENCODE_ERROR(err, result, exit);
+        err = cbor_encode_uint(&map, keypath->source_fingerprint);
+        CHECK_CBOR_ENCODE_ERROR(err, result, exit);
+    }
+    if (keypath->depth) {
+        err = cbor_encode_uint(&map, 3);
+        CHECK_CBOR_ENCODE_ERROR(err, result, exit);
+        err = cbor_encode_uint(&map, keypath->depth);
+        CHECK_CBOR_ENCODE_ERROR(err, result, exit);
+    }
+    err = cbor_encoder_close_container(encoder, &map);
+    CHECK_CBOR_ENCODE_ERROR(err, result, exit);
+
+exit:
+    return result;
+}
+
+// tagged, bitcoin and mainnet are left out
+static int coininfo_serialize(CborEncoder *encoder, const crypto_coininfo *coininfo)
+{
+    int result = URC_OK;
+    const bool with_type = coininfo->type != CRYPTO_COININFO_TYPE_BTC;
+    const bool with_network = coininfo->network != CRYPTO_COININFO_MAINNET;
+    CborError err = cbor_encode_tag(encoder, urc_urtypes_tags_crypto_coin_info);
+    CHECK_CBOR_ENCODE_ERROR(err, result, exit);
+    CborEncoder map;
+    err = cbor_encoder_create_map(encoder, &map, with_type + with_network);
+    CHECK_CBOR_ENCODE_ERROR(err, result, exit);
+    if (with_type) {
+        err = cbor_encode_uint(&map, 1);
+        CHECK_CBOR_ENCODE_ERROR(err, result, exit);
+        err = cbor_encode_uint(&map, coininfo->type);
+        CHECK_CBOR_ENCODE_ERROR(err, result, exit);
+    }
+    if (with_network) {
+        err = cbor_encode_uint(&map, 2);
+        CHECK_CBOR_ENCODE_ERROR(err, result, exit);
+        err = cbor_encode_int(&map, coininfo->network);
+        CHECK_CBOR_ENCODE_ERROR(err, result, exit);
+    }
+    err = cbor_encoder_close_container(encoder, &map);
+    CHECK_CBOR_ENCODE_ERROR(err, result, exit);
+
+exit:
+    return result;
+}
+
+static int masterkey_serialize(CborEncoder *encoder, const hd_master_key *key)
+{
+    int result = URC_OK;
+    CborEncoder map;
+    CborError err = cbor_encoder_create_map(encoder, &map, 3);
+    CHECK_CBOR_ENCODE_ERROR(err, result, exit);
+    err = cbor_encode_uint(&map, 1);
+    CHECK_CBOR_ENCODE_ERROR(err, result, exit);
+    err = cbor_encode_boolean(&map, true);
+    CHECK_CBOR_ENCODE_ERROR(err, result, exit);
+    err = cbor_encode_uint(&map, 3);
+    CHECK_CBOR_ENCODE_ERROR(err, result, exit);
+    err = cbor_encode_byte_string(&map, key->keydata, CRYPTO_HDKEY_KEYDATA_SIZE);
+    CHECK_CBOR_ENCODE_ERROR(err, result, exit);
+    err = cbor_encode_uint(&map, 4);
+    CHECK_CBOR_ENCODE_ERROR(err, result, exit);
+    err = cbor_encode_byte_string(&map, key->chaincode, CRYPTO_HDKEY_CHAINCODE_SIZE);
+    CHECK_CBOR_ENCODE_ERROR(err, result, exit);
+    err = cbor_encoder_close_container(encoder, &map);
+    CHECK_CBOR_ENCODE_ERROR(err, result, exit);
+
+exit:
+    return result;
+}
+
+// the copies kept inside the key, the views may point into a buffer that is gone
+static urc_text_view name_text(const hd_derived_key *key)
+{
+    return (urc_text_view){.text = key->name, .len = strlen(key->name)};
+}
+
+static urc_text_view note_text(const hd_derived_key *key)
+{
+    return (urc_text_view){.text = key->note, .len = strlen(key->note)};
+}
+
+// optional fields holding their deserializer's default are left out
+static int derivedkey_serialize(CborEncoder *encoder, const hd_derived_key *key)
+{
+    int result = URC_OK;
+    const bool with_useinfo =
+        key->useinfo.type != CRYPTO_COININFO_TYPE_BTC || key->useinfo.network != CRYPTO_COININFO_MAINNET;
+    const urc_text_view name = name_text(key);
+    const urc_text_view note = note_text(key);
+    const size_t fields = 1 + key->is_private + key->valid_chaincode + with_useinfo + !keypath_is_empty(&key->origin) +
+                          !keypath_is_empty(&key->children) + (key->parent_fingerprint != 0) + (name.len != 0) +
+                          (note.len != 0);
+
+    CborEncoder map;
+    CborError err = cbor_encoder_create_map(encoder, &map, fields);
+    CHECK_CBOR_ENCODE_ERROR(err, result, exit);
+    if (key->is_private) {
+        err = cbor_encode_uint(&map, 2);
+        CHECK_CBOR_ENCODE_ERROR(err, result, exit);
+        err = cbor_encode_boolean(&map, true);
+        CHECK_CBOR_ENCODE_ERROR(err, result, exit);
+    }
+    err = cbor_encode_uint(&map, 3);
+    CHECK_CBOR_ENCODE_ERROR(err, result, exit);
+    err = cbor_encode_byte_string(&map, key->keydata, CRYPTO_HDKEY_KEYDATA_SIZE);
+    CHECK_CBOR_ENCODE_ERROR(err, result, exit);
+    if (key->valid_chaincode) {
+        err = cbor_encode_uint(&map, 4);
+        CHECK_CBOR_ENCODE_ERROR(err, result, exit);
+        err = cbor_encode_byte_string(&map, key->chaincode, CRYPTO_HDKEY_CHAINCODE_SIZE);
+        CHECK_CBOR_ENCODE_ERROR(err, result, exit);
+    }
+    if (with_useinfo) {
+        err = cbor_encode_uint(&map, 5);
+        CHECK_CBOR_ENCODE_ERROR(err, result, exit);
+        result = coininfo_serialize(&map, &key->useinfo);
+        if (result != URC_OK) {
+            goto exit;
+        }
+    }
+    if (!keypath_is_empty(&key->origin)) {
+        err = cbor_encode_uint(&map, 6);
+        CHECK_CBOR_ENCODE_ERROR(err, result, exit);
+        result = keypath_serialize(&map, &key->origin);
+        if (result != URC_OK) {
+            goto exit;
+        }
+    }
+    if (!keypath_is_empty(&key->children)) {
+        err = cbor_encode_uint(&map, 7);
+        CHECK_CBOR_ENCODE_ERROR(err, result, exit);
+        result = keypath_serialize(&map, &key->children);
+        if (result != URC_OK) {
+            goto exit;
+        }
+    }
+    if (key->parent_fingerprint) {
+        err = cbor_encode_uint(&map, 8);
+        CHECK_CBOR_ENCODE_ERROR(err, result, exit);
+        err = cbor_encode_uint(&map, key->parent_fingerprint);
+        CHECK_CBOR_ENCODE_ERROR(err, result, exit);
+    }
+    if (name.len) {
+        err = cbor_encode_uint(&map, 9);
+        CHECK_CBOR_ENCODE_ERROR(err, result, exit);
+        err = cbor_encode_text_string(&map, name.text, name.len);
+        CHECK_CBOR_ENCODE_ERROR(err, result, exit);
+    }
+    if (note.len) {
+        err = cbor_encode_uint(&map, 10);
+        CHECK_CBOR_ENCODE_ERROR(err, result, exit);
+        err = cbor_encode_text_string(&map, note.text, note.len);
+        CHECK_CBOR_ENCODE_ERROR(err, result, exit);
+    }
+    err = cbor_encoder_close_container(encoder, &map);
+    CHECK_CBOR_ENCODE_ERROR(err, result, exit);
+
+exit:
+    return result;
+}
+
+int urc_crypto_hdkey_serialize_impl(CborEncoder *encoder, const crypto_hdkey *hdkey)
+{
+    switch (hdkey->type) {
+    case hdkey_type_master:
+        return masterkey_serialize(encoder, &hdkey->key.master);
+    case hdkey_type_derived:
+        return derivedkey_serialize(encoder, &hdkey->key.derived);
+    default:
+        return URC_EINVALIDARG;
+    }
+}
+
+static int hdkey_serialize(CborEncoder *encoder, const void *in) { return urc_crypto_hdkey_serialize_impl(encoder, in); }
+
+int urc_crypto_hdkey_serialize(const crypto_hdkey *hdkey, uint8_t **cbor_out, size_t *cbor_len)
+{
+    if (!hdkey || !cbor_out || !cbor_len) {
+        return URC_EINVALIDARG;
+    }
+    return serialize_alloc(hdkey_serialize, hdkey, cbor_out, cbor_len);
+}
+
+int urc_crypto_hdkey_serialize_to_buffer(const crypto_hdkey *hdkey, uint8_t *out, size_t out_len, size_t *cbor_len)
+{
+    if (!hdkey || (!out && out_len) || !cbor_len) {
+        return URC_EINVALIDARG;
+    }
+    return serialize_to_buffer(hdkey_serialize, hdkey, out, out_len, cbor_len);
+}
+
 int urc_hdkey_getversion(const crypto_hdkey *hdkey, uint32_t *out)
 {
     *out = 0;
@@ -609,46 +822,48 @@ int urc_hdkey_getkeyorigin_levels(const crypto_hdkey *hdkey, size_t *out)
     }
 }
 
-int format_hdkey_path_component(const path_component *component, char *out, size_t out_len)
+static int write_path_component(urc_writer *writer, const path_component *component)
 {
     switch (component->type) {
     case path_component_type_index:
-        return snprintf(out, out_len, "/%d%s", component->component.index.index,
-                        component->component.index.is_hardened ? "'" : "");
+        writer_appendz(writer, "/");
+        writer_append_uint(writer, component->component.index.index);
+        writer_appendz(writer, component->component.index.is_hardened ? "'" : "");
+        return URC_OK;
     case path_component_type_range: {
         const child_range_component *range = &component->component.range;
-        int len = snprintf(out, out_len, "/<%d%s", range->low, range->is_hardened ? "'" : "");
-        size_t total_len = len;
-        if (len < 0 || (size_t)len >= out_len) {
-            return len;
-        }
-        for (uint32_t i = range->low + 1; i <= range->high; i++) {
-            len = snprintf(&out[total_len], out_len - total_len, ";%d%s", i, range->is_hardened ? "'" : "");
-            total_len += len;
-            if (len < 0)
-                return len;
-            if (total_len >= out_len)
-                return (int)total_len;
+        const char *hardened = range->is_hardened ? "'" : "";
+        writer_appendz(writer, "/<");
+        writer_append_uint(writer, range->low);
+        writer_appendz(writer, hardened);
+        for (uint64_t i = (uint64_t)range->low + 1; i <= range->high; i++) {
+            writer_appendz(writer, ";");
+            writer_append_uint(writer, (uint32_t)i);
+            writer_appendz(writer, hardened);
         }
-        len = snprintf(&out[total_len], out_len - total_len, ">");
-        total_len += len;
-        if (len < 0)
-            return len;
-        return (int)total_len;
+        writer_appendz(writer, ">");
+        return URC_OK;
     }
     case path_component_type_wildcard:
-        return snprintf(out, out_len, "/*");
+        writer_appendz(writer, "/*");
+        return URC_OK;
     case path_component_type_pair: {
-        char *hardened = component->component.pair.external.is_hardened ? "'" : "";
-        return snprintf(out, out_len, "/<%d%s,%d%s>", component->component.pair.external.index, hardened,
-                        component->component.pair.internal.index, hardened);
+        const char *hardened = component->component.pair.external.is_hardened ? "'" : "";
+        writer_appendz(writer, "/<");
+        writer_append_uint(writer, component->component.pair.external.index);
+        writer_appendz(writer, hardened);
+        writer_appendz(writer, ",");
+        writer_append_uint(writer, component->component.pair.internal.index);
+        writer_appendz(writer, hardened);
+        writer_appendz(writer, ">");
+        return URC_OK;
     }
     default:
         return URC_EINVALIDARG;
     }
 }
 
-int format_keyorigin(const crypto_hdkey *hdkey, char *out, size_t out_len)
+int write_keyorigin(urc_writer *writer, const crypto_hdkey *hdkey)
 {
     uint32_t fpr = 0;
     switch (hdkey->type) {
@@ -672,47 +887,61 @@ int format_keyorigin(const crypto_hdkey *hdkey, char *out, size_t out_len)
         comps_count = hdkey->key.derived.origin.components_count;
     }
 
-    int total_len = 0;
-    int len = snprintf(out, out_len, "[%08x", fpr);
-    CHECK_SNPRINTF_BOUNDS(out_len, total_len, len);
-
+    const uint8_t fpr_bytes[4] = {fpr >> 24, fpr >> 16, fpr >> 8, fpr};
+    writer_appendz(writer, "[");
+    writer_append_hex(writer, fpr_bytes, sizeof(fpr_bytes));
     for (size_t idx = 0; idx < comps_count; idx++) {
-        len = format_hdkey_path_component(&comps[idx], &out[total_len], out_len - total_len);
-        CHECK_SNPRINTF_BOUNDS(out_len, total_len, len);
+        int result = write_path_component(writer, &comps[idx]);
+        if (result != URC_OK) {
+            return result;
+        }
     }
-    len = snprintf(&out[total_len], out_len - total_len, "]");
-    CHECK_SNPRINTF_BOUNDS(out_len, total_len, len);
-    return total_len;
+    writer_appendz(writer, "]");
+    return URC_OK;
 }
 
-int format_keyderivationpath(const crypto_hdkey *hdkey, char *out, size_t out_len)
+int write_keyderivationpath(urc_writer *writer, const crypto_hdkey *hdkey)
 {
     if (hdkey->type == hdkey_type_na) {
-        return -1;
+        return URC_EINVALIDARG;
     }
     if (hdkey->type == hdkey_type_master) {
-        return 0;
-    }
-    if (out_len == 0) {
-        return -1;
+        return URC_OK;
     }
-    int total_len = 0;
 
     const path_component *comps = hdkey->key.derived.children.components;
-    size_t comps_count = comps_count = hdkey->key.derived.children.components_count;
+    size_t comps_count = hdkey->key.derived.children.components_count;
     for (size_t idx = 0; idx < comps_count; idx++) {
-        int len = format_hdkey_path_component(&comps[idx], &out[total_len], out_len - total_len);
-        CHECK_SNPRINTF_BOUNDS(out_len, total_len, len);
+        int result = write_path_component(writer, &comps[idx]);
+        if (result != URC_OK) {
+            return result;
+        }
     }
-    return total_len;
+    return URC_OK;
 }
 
-int urc_crypto_hdkey_format(const crypto_hdkey *hdkey, char **out)
+int format_keyorigin(const crypto_hdkey *hdkey, char *out, size_t out_len)
 {
-    if (hdkey == NULL || hdkey->type == hdkey_type_na || out == NULL) {
-        return URC_EINVALIDARG;
+    urc_writer writer;
+    writer_init(&writer, out, out_len);
+    if (write_keyorigin(&writer, hdkey) != URC_OK) {
+        return -1;
+    }
+    return (int)writer.len;
+}
+
+int format_keyderivationpath(const crypto_hdkey *hdkey, char *out, size_t out_len)
+{
+    urc_writer writer;
+    writer_init(&writer, out, out_len);
+    if (write_keyderivationpath(&writer, hdkey) != URC_OK) {
+        return -1;
     }
+    return (int)writer.len;
+}
 
+int urc_hdkey_to_ext_key(const crypto_hdkey *hdkey, struct ext_key *out, uint32_t *serialization_flag)
+{
     int result = URC_OK;
 
     uint32_t version;
@@ -750,27 +979,202 @@ int urc_crypto_hdkey_format(const crypto_hdkey *hdkey, char **out)
     size_t priv_key_len = 0;
     unsigned char *pub_key = NULL;
     size_t pub_key_len = 0;
-    uint32_t serialization_flag = 0;
     if (hdkey->type == hdkey_type_master || hdkey->key.derived.is_private) {
         priv_key = keydata + 1;
         priv_key_len = CRYPTO_HDKEY_KEYDATA_SIZE - 1;
-        serialization_flag = BIP32_FLAG_KEY_PRIVATE;
+        *serialization_flag = BIP32_FLAG_KEY_PRIVATE;
     } else {
         pub_key = keydata;
         pub_key_len = CRYPTO_HDKEY_KEYDATA_SIZE;
-        serialization_flag = BIP32_FLAG_KEY_PUBLIC;
+        *serialization_flag = BIP32_FLAG_KEY_PUBLIC;
     }
 
-    int urc_result = URC_OK;
-    struct ext_key wally_key;
+    trace_span span = trace_begin(TRACE_TYPE_CURRENT, urc_trace_phase_bip32_init);
     int wally_result = bip32_key_init(version, depth, child_num, chaincode, CRYPTO_HDKEY_CHAINCODE_SIZE, pub_key, pub_key_len,
-                                      priv_key, priv_key_len, NULL, 0, (uint8_t *)&parent_fpr, sizeof(uint32_t), &wally_key);
-    CHECK_WALLY_ERROR(wally_result, urc_result, exit);
+                                      priv_key, priv_key_len, NULL, 0, (uint8_t *)&parent_fpr, sizeof(uint32_t), out);
+    trace_end(&span);
+    CHECK_WALLY_ERROR(wally_result, result, exit);
+
+exit:
+    return result;
+}
+
+static const char base58_alphabet[] = "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
+
+// ``out`` must be able to hold len * 138 / 100 + 2 characters
+static void base58_encode(const uint8_t *bytes, size_t len, char *out)
+{
+    size_t zeros = 0;
+    while (zeros < len && bytes[zeros] == 0) {
+        zeros++;
+    }
+
+    // big endian base 58 digits, log(256) / log(58) ~ 1.38
+    uint8_t digits[(BIP32_SERIALIZED_LEN + 4) * 138 / 100 + 1];
+    const size_t digits_size = (len - zeros) * 138 / 100 + 1;
+    size_t digits_len = 0;
+    memset(digits, 0, digits_size);
+    for (size_t idx = zeros; idx < len; idx++) {
+        uint32_t carry = bytes[idx];
+        size_t processed = 0;
+        for (size_t pos = digits_size; pos > 0 && (carry != 0 || processed < digits_len); pos--, processed++) {
+            carry += 256 * (uint32_t)digits[pos - 1];
+            digits[pos - 1] = carry % 58;
+            carry /= 58;
+        }
+        digits_len = processed;
+    }
+
+    size_t start = digits_size - digits_len;
+    while (start < digits_size && digits[start] == 0) {
+        start++;
+    }
+    size_t out_len = 0;
+    for (size_t idx = 0; idx < zeros; idx++) {
+        out[out_len++] = '1';
+    }
+    for (size_t idx = start; idx < digits_size; idx++) {
+        out[out_len++] = base58_alphabet[digits[idx]];
+    }
+    out[out_len] = '\0';
+    wally_bzero(digits, sizeof(digits));
+}
+
+static void write_be32(uint8_t *out, uint32_t value)
+{
+    out[0] = (uint8_t)(value >> 24);
+    out[1] = (uint8_t)(value >> 16);
+    out[2] = (uint8_t)(value >> 8);
+    out[3] = (uint8_t)value;
+}
+
+// the BIP32 serialization of a public key, built from the fields without going through wally
+static int hdkey_cache_key(const crypto_hdkey *hdkey, uint8_t out[BIP32_SERIALIZED_LEN])
+{
+    uint32_t version;
+    int result = urc_hdkey_getversion(hdkey, &version);
+    if (result != URC_OK) {
+        return result;
+    }
+    uint8_t depth;
+    result = urc_hdkey_getdepth(hdkey, &depth);
+    if (result != URC_OK) {
+        return result;
+    }
+    uint32_t parent_fpr;
+    result = urc_hdkey_getparentfingerprint(hdkey, &parent_fpr);
+    if (result != URC_OK) {
+        return result;
+    }
+    uint32_t child_num;
+    result = urc_hdkey_getchildnumber(hdkey, &child_num);
+    if (result != URC_OK) {
+        return result;
+    }
+    uint8_t *chaincode;
+    result = urc_hdkey_getchaincode(hdkey, &chaincode);
+    if (result != URC_OK) {
+        return result;
+    }
+    uint8_t *keydata;
+    result = urc_hdkey_getkeydata(hdkey, &keydata);
+    if (result != URC_OK) {
+        return result;
+    }
 
-    wally_result = bip32_key_to_base58(&wally_key, serialization_flag, out);
-    CHECK_WALLY_ERROR(wally_result, urc_result, exit);
+    write_be32(out, version);
+    out[4] = depth;
+    write_be32(&out[5], parent_fpr);
+    write_be32(&out[9], child_num);
+    memcpy(&out[13], chaincode, CRYPTO_HDKEY_CHAINCODE_SIZE);
+    memcpy(&out[13 + CRYPTO_HDKEY_CHAINCODE_SIZE], keydata, CRYPTO_HDKEY_KEYDATA_SIZE);
+    return URC_OK;
+}
+
+int urc_hdkey_format_base58(const crypto_hdkey *hdkey, char out[URC_HDKEY_BASE58_BUFFER_SIZE])
+{
+    uint8_t cache_key[BIP32_SERIALIZED_LEN];
+    const bool cacheable = hdkey_cache_enabled() && hdkey->type == hdkey_type_derived && !hdkey->key.derived.is_private &&
+                           hdkey_cache_key(hdkey, cache_key) == URC_OK;
+    if (cacheable && hdkey_cache_lookup(cache_key, out)) {
+        return URC_OK;
+    }
 
+    uint32_t serialization_flag;
+    struct ext_key wally_key;
+    int result = urc_hdkey_to_ext_key(hdkey, &wally_key, &serialization_flag);
+    if (result != URC_OK) {
+        goto exit;
+    }
+
+    // BIP32 serialization followed by the first 4 bytes of its double sha256
+    uint8_t serialized[BIP32_SERIALIZED_LEN + SHA256_LEN];
+    int wally_result = bip32_key_serialize(&wally_key, serialization_flag, serialized, BIP32_SERIALIZED_LEN);
+    CHECK_WALLY_ERROR(wally_result, result, wipe_and_exit);
+    wally_result = wally_sha256d(serialized, BIP32_SERIALIZED_LEN, &serialized[BIP32_SERIALIZED_LEN], SHA256_LEN);
+    CHECK_WALLY_ERROR(wally_result, result, wipe_and_exit);
+
+    trace_span span = trace_begin(TRACE_TYPE_CURRENT, urc_trace_phase_base58);
+    base58_encode(serialized, BIP32_SERIALIZED_LEN + 4, out);
+    trace_end(&span);
+    if (cacheable) {
+        hdkey_cache_insert(cache_key, out);
+    }
+
+wipe_and_exit:
+    wally_bzero(serialized, sizeof(serialized));
 exit:
     wally_bzero(&wally_key, sizeof(wally_key));
-    return urc_result;
+    return result;
+}
+
+int urc_crypto_hdkey_format(const crypto_hdkey *hdkey, char **out)
+{
+    if (hdkey == NULL || hdkey->type == hdkey_type_na || out == NULL) {
+        return URC_EINVALIDARG;
+    }
+
+    trace_span span = trace_begin(urc_trace_type_crypto_hdkey, urc_trace_phase_format);
+    char base58[URC_HDKEY_BASE58_BUFFER_SIZE];
+    int result = urc_hdkey_format_base58(hdkey, base58);
+    if (result != URC_OK) {
+        goto exit;
+    }
+
+    size_t base58_len = strlen(base58) + 1;
+    *out = urc_malloc(base58_len);
+    if (!*out) {
+        result = URC_ENOMEM;
+    } else {
+        memcpy(*out, base58, base58_len);
+    }
+exit:
+    wally_bzero(base58, sizeof(base58));
+    trace_end(&span);
+    return result;
+}
+
+int urc_crypto_hdkey_format_to_buffer(const crypto_hdkey *hdkey, char *out, size_t out_len, size_t *base58_len)
+{
+    if (hdkey == NULL || hdkey->type == hdkey_type_na || (out == NULL && out_len) || base58_len == NULL) {
+        return URC_EINVALIDARG;
+    }
+
+    trace_span span = trace_begin(urc_trace_type_crypto_hdkey, urc_trace_phase_format);
+    char base58[URC_HDKEY_BASE58_BUFFER_SIZE];
+    int result = urc_hdkey_format_base58(hdkey, base58);
+    if (result != URC_OK) {
+        goto exit;
+    }
+
+    *base58_len = strlen(base58);
+    if (out_len <= *base58_len) {
+        result = URC_EBUFFERTOOSMALL;
+    } else {
+        memcpy(out, base58, *base58_len + 1);
+    }
+exit:
+    wally_bzero(base58, sizeof(base58));
+    trace_end(&span);
+    return result;
 }
@@ -0,0 +1,224 @@
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "wally_core.h"
+
+#include "urc/crypto_hdkey.h"
+#include "urc/error.h"
+
+#include "internals.h"
+
+#define NO_ENTRY UINT32_MAX
+
+typedef struct {
+    uint8_t key[BIP32_SERIALIZED_LEN];
+    char base58[URC_HDKEY_BASE58_BUFFER_SIZE];
+    // next entry hashing to the same bucket
+    uint32_t bucket_next;
+    // recency list, most recently used first
+    uint32_t lru_prev;
+    uint32_t lru_next;
+} cache_entry;
+
+// the cache outlives any call and any thread, its memory comes from wally_malloc rather than the thread allocator
+static struct {
+    pthread_mutex_t lock;
+    cache_entry *entries;
+    uint32_t *buckets;
+    size_t buckets_mask;
+    size_t capacity;
+    size_t count;
+    uint32_t lru_head;
+    uint32_t lru_tail;
+    uint64_t hits;
+    uint64_t misses;
+} cache = {.lock = PTHREAD_MUTEX_INITIALIZER};
+
+// read without the lock so that a disabled cache costs nothing
+static atomic_bool cache_enabled;
+
+static size_t bucket_of(const uint8_t key[BIP32_SERIALIZED_LEN])
+{
+    // fnv-1a
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (size_t idx = 0; idx < BIP32_SERIALIZED_LEN; idx++) {
+        hash = (hash ^ key[idx]) * 0x100000001b3ULL;
+    }
+    return (size_t)(hash ^ (hash >> 32)) & cache.buckets_mask;
+}
+
+static void lru_unlink(uint32_t idx)
+{
+    cache_entry *entry = &cache.entries[idx];
+    if (entry->lru_prev != NO_ENTRY) {
+        cache.entries[entry->lru_prev].lru_next = entry->lru_next;
+    } else {
+        cache.lru_head = entry->lru_next;
+    }
+    if (entry->lru_next != NO_ENTRY) {
+        cache.entries[entry->lru_next].lru_prev = entry->lru_prev;
+    } else {
+        cache.lru_tail = entry->lru_prev;
+    }
+}
+
+static void lru_push_front(uint32_t idx)
+{
+    cache_entry *entry = &cache.entries[idx];
+    entry->lru_prev = NO_ENTRY;
+    entry->lru_next = cache.lru_head;
+    if (cache.lru_head != NO_ENTRY) {
+        cache.entries[cache.lru_head].lru_prev = idx;
+    } else {
+        cache.lru_tail = idx;
+    }
+    cache.lru_head = idx;
+}
+
+static void bucket_unlink(uint32_t idx)
+{
+    uint32_t *link = &cache.buckets[bucket_of(cache.entries[idx].key)];
+    while (*link != idx) {
+        link = &cache.entries[*link].bucket_next;
+    }
+    *link = cache.entries[idx].bucket_next;
+}
+
+static void release_locked(void)
+{
+    wally_free(cache.entries);
+    wally_free(cache.buckets);
+    cache.entries = NULL;
+    cache.buckets = NULL;
+    cache.buckets_mask = 0;
+    cache.capacity = 0;
+    cache.count = 0;
+    cache.lru_head = NO_ENTRY;
+    cache.lru_tail = NO_ENTRY;
+}
+
+int urc_hdkey_cache_enable(size_t capacity)
+{
+    if (capacity == 0 || capacity >= NO_ENTRY / 2) {
+        return URC_EINVALIDARG;
+    }
+    // at least two buckets per entry keeps chains short
+    size_t buckets_count = 1;
+    while (buckets_count < capacity * 2) {
+        buckets_count *= 2;
+    }
+    cache_entry *entries = wally_malloc(sizeof(cache_entry) * capacity);
+    uint32_t *buckets = wally_malloc(sizeof(uint32_t) * buckets_count);
+    if (!entries || !buckets) {
+        wally_free(entries);
+        wally_free(buckets);
+        return URC_ENOMEM;
+    }
+    for (size_t idx = 0; idx < buckets_count; idx++) {
+        buckets[idx] = NO_ENTRY;
+    }
+
+    pthread_mutex_lock(&cache.lock);
+    release_locked();
+    cache.entries = entries;
+    cache.buckets = buckets;
+    cache.buckets_mask = buckets_count - 1;
+    cache.capacity = capacity;
+    cache.hits = 0;
+    cache.misses = 0;
+    atomic_store(&cache_enabled, true);
+    pthread_mutex_unlock(&cache.lock);
+    return URC_OK;
+}
+
+void urc_hdkey_cache_disable(void)
+{
+    pthread_mutex_lock(&cache.lock);
+    atomic_store(&cache_enabled, false);
+    release_locked();
+    pthread_mutex_unlock(&cache.lock);
+}
+
+void urc_hdkey_cache_get_stats(urc_hdkey_cache_stats *out)
+{
+    pthread_mutex_lock(&cache.lock);
+    out->hits = cache.hits;
+    out->misses = cache.misses;
+    out->entries = cache.count;
+    out->capacity = cache.capacity;
+    pthread_mutex_unlock(&cache.lock);
+}
+
+void urc_hdkey_cache_reset_stats(void)
+{
+    pthread_mutex_lock(&cache.lock);
+    cache.hits = 0;
+    cache.misses = 0;
+    pthread_mutex_unlock(&cache.lock);
+}
+
+bool hdkey_cache_enabled(void) { return atomic_load_explicit(&cache_enabled, memory_order_relaxed); }
+
+bool hdkey_cache_lookup(const uint8_t key[BIP32_SERIALIZED_LEN], char out[URC_HDKEY_BASE58_BUFFER_SIZE])
+{
+    bool found = false;
+    pthread_mutex_lock(&cache.lock);
+    if (!cache.entries) {
+        goto exit;
+    }
+    for (uint32_t idx = cache.buckets[bucket_of(key)]; idx != NO_ENTRY; idx = cache.entries[idx].bucket_next) {
+        if (memcmp(cache.entries[idx].key, key, BIP32_SERIALIZED_LEN) == 0) {
+            memcpy(out, cache.entries[idx].base58, URC_HDKEY_BASE58_BUFFER_SIZE);
+            lru_unlink(idx);
+            lru_push_front(idx);
+            found = true;
+            break;
+        }
+    }
+    if (found) {
+        cache.hits++;
+    } else {
+        cache.misses++;
+    }
+
+exit:
+    pthread_mutex_unlock(&cache.lock);
+    return found;
+}
+
+void hdkey_cache_insert(const uint8_t key[BIP32_SERIALIZED_LEN], const char base58[URC_HDKEY_BASE58_BUFFER_SIZE])
+{
+    pthread_mutex_lock(&cache.lock);
+    if (!cache.entries) {
+        goto exit;
+    }
+    // another thread may have inserted the same key since our lookup
+    const size_t bucket = bucket_of(key);
+    for (uint32_t idx = cache.buckets[bucket]; idx != NO_ENTRY; idx = cache.entries[idx].bucket_next) {
+        if (memcmp(cache.entries[idx].key, key, BIP32_SERIALIZED_LEN) == 0) {
+            goto exit;
+        }
+    }
+
+    uint32_t idx;
+    if (cache.count < cache.capacity) {
+        idx = (uint32_t)cache.count++;
+    } else {
+        // evict the least recently used entry
+        idx = cache.lru_tail;
+        lru_unlink(idx);
+        bucket_unlink(idx);
+    }
+    cache_entry *entry = &cache.entries[idx];
+    memcpy(entry->key, key, BIP32_SERIALIZED_LEN);
+    memcpy(entry->base58, base58, URC_HDKEY_BASE58_BUFFER_SIZE);
+    entry->bucket_next = cache.buckets[bucket];
+    cache.buckets[bucket] = idx;
+    lru_push_front(idx);
+
+exit:
+    pthread_mutex_unlock(&cache.lock);
+}
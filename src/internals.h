@@ -1,14 +1,54 @@
 #pragma once
 
 #include "cbor.h"
+#include "wally_bip32.h"
 
+#include "urc/crypto_account.h"
 #include "urc/crypto_eckey.h"
 #include "urc/crypto_hdkey.h"
 #include "urc/crypto_output.h"
+#include "urc/crypto_psbt.h"
+#include "urc/crypto_seed.h"
+#include "urc/jade_bip8539.h"
+#include "urc/jade_rpc.h"
+#include "urc/ur.h"
+
+#include "writer.h"
+
+// the public deserializers under an explicit validation profile, they use the calling thread's one
+int urc_crypto_seed_deserialize_with_profile(const uint8_t *buffer, size_t len, crypto_seed *out,
+                                             urc_validation_profile profile);
+int urc_crypto_psbt_deserialize_with_profile(const uint8_t *cbor_buffer, size_t cbor_len, crypto_psbt *out,
+                                             urc_validation_profile profile);
+int urc_crypto_psbt_deserialize_borrowed_with_profile(const uint8_t *cbor_buffer, size_t cbor_len, crypto_psbt_view *out,
+                                                      urc_validation_profile profile);
+int urc_crypto_eckey_deserialize_with_profile(const uint8_t *buffer, size_t len, crypto_eckey *out,
+                                              urc_validation_profile profile);
+int urc_crypto_hdkey_deserialize_with_profile(const uint8_t *buffer, size_t len, crypto_hdkey *out,
+                                              urc_validation_profile profile);
+int urc_crypto_output_deserialize_with_profile(const uint8_t *buffer, size_t len, crypto_output *out,
+                                               urc_validation_profile profile);
+int urc_crypto_account_deserialize_with_profile(const uint8_t *buffer, size_t len, crypto_account *out,
+                                                urc_validation_profile profile);
+int urc_jade_account_deserialize_with_profile(const uint8_t *buffer, size_t len, crypto_account *out,
+                                              urc_validation_profile profile);
+int urc_jade_bip8539_response_deserialize_with_profile(const uint8_t *cbor, size_t cbor_len, jade_bip8539_response *response,
+                                                       urc_validation_profile profile);
+int urc_jade_rpc_deserialize_with_profile(const uint8_t *cbor, size_t cbor_len, char **out, urc_validation_profile profile);
 
 int urc_crypto_output_deserialize_impl(CborValue *iter, crypto_output *out);
 int urc_crypto_eckey_deserialize_impl(CborValue *iter, crypto_eckey *out);
 int urc_crypto_hdkey_deserialize_impl(CborValue *iter, crypto_hdkey *out);
+// untagged, as the deserializers above expect them
+int urc_crypto_output_serialize_impl(CborEncoder *encoder, const crypto_output *output);
+int urc_crypto_eckey_serialize_impl(CborEncoder *encoder, const crypto_eckey *eckey);
+int urc_crypto_hdkey_serialize_impl(CborEncoder *encoder, const crypto_hdkey *hdkey);
+// crypto-account introduces descriptors by tag 308, jade's format doesn't
+int urc_account_deserialize_impl(CborValue *iter, crypto_account *out, bool tagged_descriptors);
+int urc_account_unbounded_deserialize_impl(CborValue *iter, size_t cbor_len, crypto_account_unbounded *out,
+                                           bool tagged_descriptors);
+
+int urc_eckey_getkey(const crypto_eckey *eckey, const uint8_t **key, size_t *key_len);
 
 int urc_hdkey_getversion(const crypto_hdkey *hdkey, uint32_t *out);
 int urc_hdkey_getdepth(const crypto_hdkey *hdkey, uint8_t *out);
@@ -18,5 +58,25 @@ int urc_hdkey_getchaincode(const crypto_hdkey *hdkey, uint8_t **out);
 int urc_hdkey_getkeydata(const crypto_hdkey *hdkey, uint8_t **out);
 int urc_hdkey_getparentfingerprint(const crypto_hdkey *hdkey, uint32_t *out);
 
+int urc_hdkey_to_ext_key(const crypto_hdkey *hdkey, struct ext_key *out, uint32_t *serialization_flag);
+// base58check encoded extended keys are 111 characters long, 112 at most for 82 bytes
+#define URC_HDKEY_BASE58_BUFFER_SIZE 113
+int urc_hdkey_format_base58(const crypto_hdkey *hdkey, char out[URC_HDKEY_BASE58_BUFFER_SIZE]);
+
+// base58 cache, keyed by the BIP32 serialization (version, depth, parent fingerprint, child number, chaincode, keydata)
+bool hdkey_cache_enabled(void);
+// lookups count as hits or misses
+bool hdkey_cache_lookup(const uint8_t key[BIP32_SERIALIZED_LEN], char out[URC_HDKEY_BASE58_BUFFER_SIZE]);
+void hdkey_cache_insert(const uint8_t key[BIP32_SERIALIZED_LEN], const char base58[URC_HDKEY_BASE58_BUFFER_SIZE]);
+
+// snprintf alike: return the length of the whole output, even when truncated, negative on error
 int format_keyorigin(const crypto_hdkey *hdkey, char *out, size_t out_len);
 int format_keyderivationpath(const crypto_hdkey *hdkey, char *out, size_t out_len);
+int write_keyorigin(urc_writer *writer, const crypto_hdkey *hdkey);
+int write_keyderivationpath(urc_writer *writer, const crypto_hdkey *hdkey);
+
+// ``ur:<type>/[<seqNum>-<seqLen>/]<bytewords>``, ``sequence`` is left empty for single part URs
+int ur_split(const char *ur, size_t ur_len, urc_text_view *type, urc_text_view *sequence, urc_text_view *words);
+// deserializes ``cbor`` in place with the deserializer matching ``type``, under ``profile``
+int ur_object_deserialize(const char *type, size_t type_len, const uint8_t *cbor, size_t cbor_len,
+                          urc_validation_profile profile, urc_ur_object *out);
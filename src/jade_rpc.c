@@ -4,33 +4,49 @@
 
 #include "urc/jade_rpc.h"
 
+#include "internals.h"
 #include "macros.h"
+#include "stats.h"
+#include "trace.h"
 #include "utils.h"
 
 int urc_jade_rpc_deserialize(const uint8_t *cbor, size_t cbor_len, char **out)
 {
+    return urc_jade_rpc_deserialize_with_profile(cbor, cbor_len, out, urc_get_thread_validation_profile());
+}
+
+int urc_jade_rpc_deserialize_with_profile(const uint8_t *cbor, size_t cbor_len, char **out, urc_validation_profile profile)
+{
+    trace_span span = trace_begin(urc_trace_type_jade_rpc, urc_trace_phase_decode);
     CborParser parser;
     CborValue value;
-    CborError err = cbor_parser_init(cbor, cbor_len, 0, &parser, &value);
-    if (err != CborNoError) {
-        return URC_ECBORINTERNALERROR;
+    int result = init_cbor_parser(cbor, cbor_len, profile, &parser, &value);
+    if (result != URC_OK) {
+        goto exit;
     }
     *out = NULL;
+    CborError err;
     size_t buffer_len = cbor_len;
     do {
-        wally_free(*out);
-        *out = wally_malloc(buffer_len);
+        urc_free(*out);
+        *out = urc_malloc(buffer_len);
         if (!*out) {
-            return URC_EWALLYINTERNALERROR;
+            result = URC_ENOMEM;
+            goto exit;
         }
         MEMFILE stream = MEMFILE_INIT(*out, buffer_len);
         err = cbor_value_to_json(&stream, &value, CborConvertIgnoreTags | CborConvertRequireMapStringKeys);
+        if (err == CborErrorIO) {
+            stats_record_retry();
+        }
         buffer_len *= 2;
     } while (err == CborErrorIO);
     if (err != CborNoError) {
-        wally_free(*out);
+        urc_free(*out);
         *out = NULL;
-        return URC_ECBORINTERNALERROR;
+        result = URC_ECBORINTERNALERROR;
     }
-    return URC_OK;
+exit:
+    trace_end(&span);
+    return result;
 }
@@ -15,6 +15,13 @@
         goto exit_point;                                                                                                         \
     }
 
+// encoders carry on past the end of their buffer, counting the bytes that don't fit: running out of space is not an error
+#define CHECK_CBOR_ENCODE_ERROR(error, urcerror, exit_point)                                                                     \
+    if ((error) != CborNoError && (error) != CborErrorOutOfMemory) {                                                             \
+        (urcerror) = URC_ECBORINTERNALERROR;                                                                                     \
+        goto exit_point;                                                                                                         \
+    }
+
 #define CHECK_IS_TYPE(cursor, type, urcerror, exit_point)                                                                        \
     if (!cbor_value_is_##type(cursor)) {                                                                                         \
         (urcerror) = URC_EUNEXPECTEDTYPE;                                                                                        \
@@ -44,9 +51,3 @@
         goto exit_point;                                                                                                         \
     }
 
-#define CHECK_SNPRINTF_BOUNDS(buffer_len, accumulated_len, snprintf_len)                                                         \
-    if ((snprintf_len) < 0)                                                                                                      \
-        return URC_EINTERNALERROR;                                                                                               \
-    (accumulated_len) += (snprintf_len);                                                                                         \
-    if ((size_t)(accumulated_len) >= (buffer_len))                                                                               \
-        return (accumulated_len);
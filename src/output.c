@@ -6,20 +6,28 @@
 
 #include "internals.h"
 #include "macros.h"
+#include "trace.h"
 #include "utils.h"
 
 int urc_crypto_output_keyexp_deserialize(CborValue *iter, output_keyexp *out);
 
 int urc_crypto_output_deserialize(const uint8_t *buffer, size_t len, crypto_output *out)
 {
+    return urc_crypto_output_deserialize_with_profile(buffer, len, out, urc_get_thread_validation_profile());
+}
+
+int urc_crypto_output_deserialize_with_profile(const uint8_t *buffer, size_t len, crypto_output *out,
+                                               urc_validation_profile profile)
+{
+    trace_span span = trace_begin(urc_trace_type_crypto_output, urc_trace_phase_decode);
     CborParser parser;
     CborValue iter;
-    CborError err;
-    err = cbor_parser_init(buffer, len, cbor_flags, &parser, &iter);
-    if (err != CborNoError) {
-        return URC_ECBORINTERNALERROR;
+    int result = init_cbor_parser(buffer, len, profile, &parser, &iter);
+    if (result == URC_OK) {
+        result = urc_crypto_output_deserialize_impl(&iter, out);
     }
-    return urc_crypto_output_deserialize_impl(&iter, out);
+    trace_end(&span);
+    return result;
 }
 
 int urc_crypto_output_deserialize_impl(CborValue *iter, crypto_output *out)
@@ -136,104 +144,133 @@ exit:
     return result;
 }
 
-typedef int (*hdkey_formatter)(const crypto_hdkey *, char *out, size_t out_len);
-static int format_with_retry(const crypto_hdkey *key, hdkey_formatter formatter, char **out)
+static int keyexp_serialize(CborEncoder *encoder, const output_keyexp *keyexp)
 {
     int result = URC_OK;
-    size_t out_len = 32;
-    int len = 0;
-    *out = NULL;
-    do {
-        out_len *= 2;
-        wally_free(*out);
-        *out = wally_malloc(out_len);
-        if (!*out) {
-            return URC_ENOMEM;
-        }
-        *out[0] = '\0';
+    CborTag tag;
+    switch (keyexp->type) {
+    case keyexp_type_pk:
+        tag = urc_urtypes_tags_output_pk;
+        break;
+    case keyexp_type_pkh:
+        tag = urc_urtypes_tags_output_pkh;
+        break;
+    case keyexp_type_wpkh:
+        tag = urc_urtypes_tags_output_wpkh;
+        break;
+    case keyexp_type_cosigner:
+        tag = urc_urtypes_tags_output_cosigner;
+        break;
+    default:
+        return URC_EINVALIDARG;
+    }
+    CborError err = cbor_encode_tag(encoder, tag);
+    CHECK_CBOR_ENCODE_ERROR(err, result, exit);
 
-        len = formatter(key, *out, out_len);
-        if (len < 0) {
-            result = URC_EINTERNALERROR;
-            break;
-        }
-    } while ((size_t)len >= out_len);
+    switch (keyexp->keytype) {
+    case keyexp_keytype_eckey:
+        err = cbor_encode_tag(encoder, urc_urtypes_tags_crypto_eckey);
+        CHECK_CBOR_ENCODE_ERROR(err, result, exit);
+        result = urc_crypto_eckey_serialize_impl(encoder, &keyexp->key.eckey);
+        break;
+    case keyexp_keytype_hdkey:
+        err = cbor_encode_tag(encoder, urc_urtypes_tags_crypto_hdkey);
+        CHECK_CBOR_ENCODE_ERROR(err, result, exit);
+        result = urc_crypto_hdkey_serialize_impl(encoder, &keyexp->key.hdkey);
+        break;
+    default:
+        result = URC_EINVALIDARG;
+    }
 
-    if (result != URC_OK) {
-        wally_free(*out);
-        *out = NULL;
+exit:
+    return result;
+}
+
+int urc_crypto_output_serialize_impl(CborEncoder *encoder, const crypto_output *output)
+{
+    int result = URC_OK;
+    CborError err;
+    switch (output->type) {
+    case output_type__:
+        return keyexp_serialize(encoder, &output->output.key);
+    case output_type_sh:
+        err = cbor_encode_tag(encoder, urc_urtypes_tags_output_sh);
+        CHECK_CBOR_ENCODE_ERROR(err, result, exit);
+        return keyexp_serialize(encoder, &output->output.key);
+    case output_type_wsh:
+        err = cbor_encode_tag(encoder, urc_urtypes_tags_output_wsh);
+        CHECK_CBOR_ENCODE_ERROR(err, result, exit);
+        return keyexp_serialize(encoder, &output->output.key);
+    case output_type_sh_wsh:
+        err = cbor_encode_tag(encoder, urc_urtypes_tags_output_sh);
+        CHECK_CBOR_ENCODE_ERROR(err, result, exit);
+        err = cbor_encode_tag(encoder, urc_urtypes_tags_output_wsh);
+        CHECK_CBOR_ENCODE_ERROR(err, result, exit);
+        return keyexp_serialize(encoder, &output->output.key);
+    case output_type_rawscript:
+        err = cbor_encode_tag(encoder, urc_urtypes_tags_output_rawscript);
+        CHECK_CBOR_ENCODE_ERROR(err, result, exit);
+        err = cbor_encode_byte_string(encoder, output->output.raw, URC_RAWSCRIPT_LEN);
+        CHECK_CBOR_ENCODE_ERROR(err, result, exit);
+        break;
+    default:
+        result = URC_EINVALIDARG;
     }
+
+exit:
     return result;
 }
 
-int urc_crypto_hdkey_descriptor_format_impl(const crypto_hdkey *key, urc_crypto_output_format_mode mode, char **out)
+static int output_serialize(CborEncoder *encoder, const void *in) { return urc_crypto_output_serialize_impl(encoder, in); }
+
+int urc_crypto_output_serialize(const crypto_output *output, uint8_t **cbor_out, size_t *cbor_len)
 {
-    char *keyorigin = NULL;
-    char *derivation_path = NULL;
-    char *bip32_base58_key = NULL;
+    if (!output || !cbor_out || !cbor_len) {
+        return URC_EINVALIDARG;
+    }
+    return serialize_alloc(output_serialize, output, cbor_out, cbor_len);
+}
 
-    int result = format_with_retry(key, format_keyorigin, &keyorigin);
-    if (result != URC_OK) {
-        goto exit;
+int urc_crypto_output_serialize_to_buffer(const crypto_output *output, uint8_t *out, size_t out_len, size_t *cbor_len)
+{
+    if (!output || (!out && out_len) || !cbor_len) {
+        return URC_EINVALIDARG;
     }
-    size_t keyorigin_len = strlen(keyorigin);
+    return serialize_to_buffer(output_serialize, output, out, out_len, cbor_len);
+}
 
-    result = urc_crypto_hdkey_format(key, &bip32_base58_key);
+static int write_hdkey_descriptor(urc_writer *writer, const crypto_hdkey *key, const char *base58,
+                                  urc_crypto_output_format_mode mode)
+{
+    int result = write_keyorigin(writer, key);
     if (result != URC_OK) {
-        goto exit;
+        return result;
     }
-    size_t bip32_base58_key_len = strlen(bip32_base58_key);
+    writer_appendz(writer, base58);
 
-    result = format_with_retry(key, format_keyderivationpath, &derivation_path);
+    size_t path_start = writer->len;
+    result = write_keyderivationpath(writer, key);
     if (result != URC_OK) {
-        goto exit;
+        return result;
     }
-    size_t derivation_path_len = strlen(derivation_path);
     size_t keyorigin_levels;
     result = urc_hdkey_getkeyorigin_levels(key, &keyorigin_levels);
     if (result != URC_OK) {
-        goto exit;
+        return result;
     }
-
-    if (keyorigin_levels == 3 && derivation_path_len == 0 && mode == urc_crypto_output_format_mode_BIP44_compatible) {
-        wally_free(derivation_path);
-        derivation_path = wally_malloc(5);
-        if (!derivation_path) {
-            result = URC_ENOMEM;
-            goto exit;
-        }
-        snprintf(derivation_path, 5, "/0/*");
-        derivation_path_len = strlen(derivation_path);
+    if (keyorigin_levels == 3 && writer->len == path_start && (mode & urc_crypto_output_format_mode_BIP44_compatible)) {
+        writer_appendz(writer, "/0/*");
     }
-
-    size_t out_len = keyorigin_len + bip32_base58_key_len + derivation_path_len + 1;
-    *out = wally_malloc(out_len);
-    if (!*out) {
-        result = URC_ENOMEM;
-        goto exit;
-    }
-
-    int len = snprintf(*out, out_len, "%s%s%s", keyorigin, bip32_base58_key, derivation_path);
-    if (len < 0) {
-        wally_free(*out);
-        result = URC_EINTERNALERROR;
-    }
-
-exit:
-    wally_free(derivation_path);
-    wally_free(bip32_base58_key);
-    wally_free(keyorigin);
-    return result;
+    return URC_OK;
 }
 
-int urc_crypto_output_format(const crypto_output *output, urc_crypto_output_format_mode mode, char **out)
+// ``hdkey_base58`` is the already encoded key when the output holds an hdkey, it is computed once and shared by
+// the measuring and the writing pass
+static int write_descriptor(urc_writer *writer, const crypto_output *output, urc_crypto_output_format_mode mode,
+                            const char *hdkey_base58)
 {
-    if (!output || !out || output->type == output_type_na) {
-        return URC_EINVALIDARG;
-    }
-
-    char *outer_desc;
-    char *outer_desc_end;
+    const char *outer_desc;
+    const char *outer_desc_end;
     switch (output->type) {
     case output_type__:
         outer_desc = "";
@@ -252,63 +289,168 @@ int urc_crypto_output_format(const crypto_output *output, urc_crypto_output_form
         outer_desc_end = "))";
         break;
     case output_type_rawscript:
-        outer_desc = "raw(";
-        outer_desc_end = ")";
-        break;
+        writer_appendz(writer, "raw(");
+        writer_append_hex(writer, output->output.raw, URC_RAWSCRIPT_LEN);
+        writer_appendz(writer, ")");
+        return URC_OK;
     default:
         return URC_EINVALIDARG;
     }
 
-    char *inner_desc;
-    char *inner_desc_end;
+    const char *inner_desc;
     switch (output->output.key.type) {
     case keyexp_type_pk:
         inner_desc = "pk(";
-        inner_desc_end = ")";
         break;
     case keyexp_type_pkh:
         inner_desc = "pkh(";
-        inner_desc_end = ")";
         break;
     case keyexp_type_wpkh:
         inner_desc = "wpkh(";
-        inner_desc_end = ")";
         break;
     case keyexp_type_cosigner:
         inner_desc = "cosigner(";
-        inner_desc_end = ")";
         break;
     default:
         return URC_EINVALIDARG;
     }
-    int key_format_result = URC_OK;
-    char *key = NULL; // key as in KEY in bitcoin descriptor doc
+
+    writer_appendz(writer, outer_desc);
+    writer_appendz(writer, inner_desc);
+    // key as in KEY in bitcoin descriptor doc
     switch (output->output.key.keytype) {
-    case keyexp_keytype_eckey:
-        key_format_result = urc_crypto_eckey_format(&output->output.key.key.eckey, &key);
+    case keyexp_keytype_eckey: {
+        const uint8_t *key;
+        size_t key_len;
+        int result = urc_eckey_getkey(&output->output.key.key.eckey, &key, &key_len);
+        if (result != URC_OK) {
+            return result;
+        }
+        writer_append_hex(writer, key, key_len);
         break;
-    case keyexp_keytype_hdkey:
-        key_format_result = urc_crypto_hdkey_descriptor_format_impl(&output->output.key.key.hdkey, mode, &key);
+    }
+    case keyexp_keytype_hdkey: {
+        int result = write_hdkey_descriptor(writer, &output->output.key.key.hdkey, hdkey_base58, mode);
+        if (result != URC_OK) {
+            return result;
+        }
         break;
+    }
     default:
         return URC_EINVALIDARG;
     }
-    if (key_format_result != URC_OK) {
-        return key_format_result;
+    writer_appendz(writer, ")");
+    writer_appendz(writer, outer_desc_end);
+    return URC_OK;
+}
+
+// the descriptor followed, when asked for, by its ``#checksum``
+static int write_formatted_descriptor(urc_writer *writer, const crypto_output *output, urc_crypto_output_format_mode mode,
+                                      const char *hdkey_base58)
+{
+    descriptor_checksum checksum;
+    const bool with_checksum = mode & urc_crypto_output_format_mode_checksum;
+    if (with_checksum) {
+        descriptor_checksum_init(&checksum);
+        writer->checksum = &checksum;
+    }
+    int result = write_descriptor(writer, output, mode, hdkey_base58);
+    writer->checksum = NULL;
+    if (result == URC_OK && with_checksum) {
+        char checksum_chars[URC_DESCRIPTOR_CHECKSUM_LEN];
+        if (!descriptor_checksum_final(&checksum, checksum_chars)) {
+            return URC_EINTERNALERROR;
+        }
+        writer_appendz(writer, "#");
+        writer_append(writer, checksum_chars, URC_DESCRIPTOR_CHECKSUM_LEN);
+    }
+    return result;
+}
+
+static int format_hdkey_base58(const crypto_output *output, char hdkey_base58[URC_HDKEY_BASE58_BUFFER_SIZE])
+{
+    if (output->type != output_type_rawscript && output->output.key.keytype == keyexp_keytype_hdkey) {
+        return urc_hdkey_format_base58(&output->output.key.key.hdkey, hdkey_base58);
+    }
+    return URC_OK;
+}
+
+int urc_crypto_output_format(const crypto_output *output, urc_crypto_output_format_mode mode, char **out)
+{
+    if (!output || !out || output->type == output_type_na) {
+        return URC_EINVALIDARG;
+    }
+
+    *out = NULL;
+    trace_span span = trace_begin(urc_trace_type_crypto_output, urc_trace_phase_format);
+    char hdkey_base58[URC_HDKEY_BASE58_BUFFER_SIZE] = "";
+    int result = format_hdkey_base58(output, hdkey_base58);
+    if (result != URC_OK) {
+        goto exit;
+    }
+
+    // measure first, then allocate exactly once
+    urc_writer writer;
+    writer_init(&writer, NULL, 0);
+    result = write_descriptor(&writer, output, mode, hdkey_base58);
+    if (result != URC_OK) {
+        goto exit;
+    }
+    size_t descriptor_len = writer.len + 1;
+    if (mode & urc_crypto_output_format_mode_checksum) {
+        descriptor_len += URC_DESCRIPTOR_CHECKSUM_LEN + 1;
     }
-    size_t descriptor_len =
-        strlen(outer_desc) + strlen(inner_desc) + strlen(key) + strlen(inner_desc_end) + strlen(outer_desc_end) + 1;
-    *out = wally_malloc(descriptor_len);
+    *out = urc_malloc(descriptor_len);
     if (!*out) {
-        wally_free(key);
-        return URC_ENOMEM;
+        result = URC_ENOMEM;
+        goto exit;
     }
-    int len = snprintf(*out, descriptor_len, "%s%s%s%s%s", outer_desc, inner_desc, key, inner_desc_end, outer_desc_end);
-    wally_free(key);
-    if (len < 0) {
-        wally_free(*out);
+    writer_init(&writer, *out, descriptor_len);
+    result = write_formatted_descriptor(&writer, output, mode, hdkey_base58);
+    if (result != URC_OK || !writer_fits(&writer)) {
+        urc_free(*out);
         *out = NULL;
-        return URC_EINTERNALERROR;
+        result = result != URC_OK ? result : URC_EINTERNALERROR;
     }
-    return URC_OK;
+
+exit:
+    wally_bzero(hdkey_base58, sizeof(hdkey_base58));
+    trace_end(&span);
+    return result;
+}
+
+int urc_crypto_output_format_to_buffer(const crypto_output *output, urc_crypto_output_format_mode mode, char *out,
+                                       size_t out_len, size_t *descriptor_len)
+{
+    if (!output || (!out && out_len) || !descriptor_len || output->type == output_type_na) {
+        return URC_EINVALIDARG;
+    }
+
+    trace_span span = trace_begin(urc_trace_type_crypto_output, urc_trace_phase_format);
+    char hdkey_base58[URC_HDKEY_BASE58_BUFFER_SIZE] = "";
+    int result = format_hdkey_base58(output, hdkey_base58);
+    if (result != URC_OK) {
+        goto exit;
+    }
+
+    // a single pass: once ``out`` is full the writer only counts
+    urc_writer writer;
+    writer_init(&writer, out, out_len);
+    result = write_formatted_descriptor(&writer, output, mode, hdkey_base58);
+    if (result != URC_OK) {
+        goto exit;
+    }
+    *descriptor_len = writer.len;
+    if (!writer_fits(&writer)) {
+        // no truncated descriptor, it may hold a private key
+        result = URC_EBUFFERTOOSMALL;
+    }
+
+exit:
+    if (result != URC_OK && out_len) {
+        wally_bzero(out, out_len);
+    }
+    wally_bzero(hdkey_base58, sizeof(hdkey_base58));
+    trace_end(&span);
+    return result;
 }
@@ -0,0 +1,166 @@
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "urc/allocator.h"
+#include "urc/core.h"
+#include "urc/error.h"
+
+#include "parallel.h"
+#include "stats.h"
+#include "utils.h"
+
+// a share is [begin, end), packed as begin << 32 | end so that owner and thieves update it with a single CAS
+typedef struct {
+    _Atomic uint64_t range;
+    // keep shares on their own cache line
+    char padding[64 - sizeof(uint64_t)];
+} parallel_share;
+
+typedef struct parallel_job parallel_job;
+
+typedef struct {
+    parallel_job *job;
+    size_t idx;
+    pthread_t thread;
+} parallel_worker;
+
+struct parallel_job {
+    urc_parallel_fn fn;
+    void *ctx;
+    const urc_allocator *allocator;
+    urc_validation_profile validation_profile;
+    stats_counters *stats;
+    parallel_share *shares;
+    size_t shares_count;
+};
+
+#define RANGE(begin, end) ((uint64_t)(begin) << 32 | (uint64_t)(end))
+#define RANGE_BEGIN(range) ((uint32_t)((range) >> 32))
+#define RANGE_END(range) ((uint32_t)(range))
+
+size_t urc_parallel_default_threads(void)
+{
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? (size_t)info.dwNumberOfProcessors : 1;
+#else
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    return cpus > 0 ? (size_t)cpus : 1;
+#endif
+}
+
+static bool take_front(parallel_share *share, uint32_t *idx)
+{
+    uint64_t range = atomic_load(&share->range);
+    while (RANGE_BEGIN(range) < RANGE_END(range)) {
+        if (atomic_compare_exchange_weak(&share->range, &range, RANGE(RANGE_BEGIN(range) + 1, RANGE_END(range)))) {
+            *idx = RANGE_BEGIN(range);
+            return true;
+        }
+    }
+    return false;
+}
+
+// moves the back half of some other share into ``self``, false once every share is empty
+static bool steal(parallel_job *job, size_t self)
+{
+    for (size_t offset = 1; offset < job->shares_count; offset++) {
+        parallel_share *victim = &job->shares[(self + offset) % job->shares_count];
+        uint64_t range = atomic_load(&victim->range);
+        while (RANGE_BEGIN(range) < RANGE_END(range)) {
+            uint32_t begin = RANGE_BEGIN(range);
+            uint32_t end = RANGE_END(range);
+            uint32_t middle = end - (end - begin + 1) / 2;
+            if (atomic_compare_exchange_weak(&victim->range, &range, RANGE(begin, middle))) {
+                atomic_store(&job->shares[self].range, RANGE(middle, end));
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+static void run_worker(parallel_job *job, size_t self)
+{
+    do {
+        uint32_t idx;
+        while (take_front(&job->shares[self], &idx)) {
+            job->fn(job->ctx, idx);
+        }
+    } while (steal(job, self));
+}
+
+static void *worker_main(void *arg)
+{
+    parallel_worker *worker = arg;
+    urc_set_thread_allocator(worker->job->allocator);
+    urc_set_thread_validation_profile(worker->job->validation_profile);
+    stats_set_thread_counters(worker->job->stats);
+    run_worker(worker->job, worker->idx);
+    return NULL;
+}
+
+int urc_parallel_for(size_t count, size_t threads, urc_parallel_fn fn, void *ctx)
+{
+    if (!fn || count > UINT32_MAX) {
+        return URC_EINVALIDARG;
+    }
+    if (threads == 0) {
+        threads = urc_parallel_default_threads();
+    }
+    if (threads > count) {
+        threads = count;
+    }
+    if (threads <= 1) {
+        for (size_t idx = 0; idx < count; idx++) {
+            fn(ctx, idx);
+        }
+        return URC_OK;
+    }
+
+    parallel_share *shares = urc_malloc(threads * sizeof(parallel_share));
+    parallel_worker *workers = urc_malloc(threads * sizeof(parallel_worker));
+    if (!shares || !workers) {
+        urc_free(workers);
+        urc_free(shares);
+        return URC_ENOMEM;
+    }
+    for (size_t idx = 0; idx < threads; idx++) {
+        atomic_init(&shares[idx].range, RANGE(count * idx / threads, count * (idx + 1) / threads));
+    }
+    parallel_job job = {
+        .fn = fn,
+        .ctx = ctx,
+        .allocator = urc_get_thread_allocator(),
+        .validation_profile = urc_get_thread_validation_profile(),
+        .stats = stats_thread_counters(),
+        .shares = shares,
+        .shares_count = threads,
+    };
+
+    // worker 0 is the calling thread, the share of a worker that fails to start is stolen by the others
+    size_t started = 1;
+    for (size_t idx = 1; idx < threads; idx++) {
+        workers[started].job = &job;
+        workers[started].idx = idx;
+        if (pthread_create(&workers[started].thread, NULL, worker_main, &workers[started]) == 0) {
+            started++;
+        }
+    }
+    run_worker(&job, 0);
+    for (size_t idx = 1; idx < started; idx++) {
+        pthread_join(workers[idx].thread, NULL);
+    }
+
+    urc_free(workers);
+    urc_free(shares);
+    return URC_OK;
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <stddef.h>
+
+typedef void (*urc_parallel_fn)(void *ctx, size_t idx);
+
+// number of online cpus, at least 1
+size_t urc_parallel_default_threads(void);
+
+// calls ``fn(ctx, idx)`` exactly once for every idx in [0, count), on up to ``threads`` threads, the calling one included
+// every thread owns a contiguous share of the range and takes indices from its front, once empty it steals the back
+// half of another thread's share
+// the calling thread's allocator, validation profile and stats counters are installed on the workers
+// count is limited to UINT32_MAX, URC_EINVALIDARG otherwise
+int urc_parallel_for(size_t count, size_t threads, urc_parallel_fn fn, void *ctx);
@@ -1,10 +1,14 @@
 
+#include <string.h>
+
 #include "wally_core.h"
 
 #include "urc/crypto_psbt.h"
 #include "urc/error.h"
 
+#include "internals.h"
 #include "macros.h"
+#include "trace.h"
 #include "utils.h"
 
 // max_len represents the maximum length of the psbt buffer
@@ -13,19 +17,26 @@
 int urc_crypto_psbt_deserialize_impl(CborValue *iter, crypto_psbt *out, size_t max_len);
 
 int urc_crypto_psbt_deserialize(const uint8_t *cbor_buffer, size_t cbor_len, crypto_psbt *out)
+{
+    return urc_crypto_psbt_deserialize_with_profile(cbor_buffer, cbor_len, out, urc_get_thread_validation_profile());
+}
+
+int urc_crypto_psbt_deserialize_with_profile(const uint8_t *cbor_buffer, size_t cbor_len, crypto_psbt *out,
+                                             urc_validation_profile profile)
 {
     if (!cbor_buffer || !out) {
         return URC_EINVALIDARG;
     }
 
+    trace_span span = trace_begin(urc_trace_type_crypto_psbt, urc_trace_phase_decode);
     CborParser parser;
     CborValue iter;
-    CborError err;
-    err = cbor_parser_init(cbor_buffer, cbor_len, cbor_flags, &parser, &iter);
-    if (err != CborNoError) {
-        return URC_ECBORINTERNALERROR;
+    int result = init_cbor_parser(cbor_buffer, cbor_len, profile, &parser, &iter);
+    if (result == URC_OK) {
+        result = urc_crypto_psbt_deserialize_impl(&iter, out, cbor_len);
     }
-    return urc_crypto_psbt_deserialize_impl(&iter, out, cbor_len);
+    trace_end(&span);
+    return result;
 }
 
 int urc_crypto_psbt_deserialize_impl(CborValue *iter, crypto_psbt *out, size_t max_len)
@@ -42,7 +53,7 @@ int urc_crypto_psbt_deserialize_impl(CborValue *iter, crypto_psbt *out, size_t m
         return URC_EINVALIDARG;
     }
 
-    out->psbt = wally_malloc(len);
+    out->psbt = urc_malloc(len);
     if (!out->psbt) {
         return URC_ENOMEM;
     }
@@ -62,54 +73,314 @@ exit:
     return result;
 }
 
-int urc_crypto_psbt_serialize_impl(const crypto_psbt *psbt, uint8_t *out, size_t *out_len)
+int urc_crypto_psbt_deserialize_borrowed(const uint8_t *cbor_buffer, size_t cbor_len, crypto_psbt_view *out)
 {
-    CborEncoder encoder;
-    cbor_encoder_init(&encoder, out, *out_len, 0);
-    CborError err = cbor_encode_byte_string(&encoder, psbt->psbt, psbt->psbt_len);
-    if (err == CborErrorOutOfMemory) {
-        return URC_EBUFFERTOOSMALL;
+    return urc_crypto_psbt_deserialize_borrowed_with_profile(cbor_buffer, cbor_len, out, urc_get_thread_validation_profile());
+}
+
+int urc_crypto_psbt_deserialize_borrowed_with_profile(const uint8_t *cbor_buffer, size_t cbor_len, crypto_psbt_view *out,
+                                                      urc_validation_profile profile)
+{
+    if (!cbor_buffer || !out) {
+        return URC_EINVALIDARG;
+    }
+    out->psbt = NULL;
+    out->psbt_len = 0;
+
+    trace_span span = trace_begin(urc_trace_type_crypto_psbt, urc_trace_phase_decode);
+    CborParser parser;
+    CborValue iter;
+    int result = init_cbor_parser(cbor_buffer, cbor_len, profile, &parser, &iter);
+    if (result != URC_OK) {
+        goto exit;
+    }
+
+    const uint8_t *psbt;
+    size_t len;
+    result = borrow_byte_string(&iter, &psbt, &len);
+    if (result != URC_OK) {
+        goto exit;
+    }
+    if (len == 0) {
+        result = URC_EINVALIDARG;
+        goto exit;
+    }
+    ADVANCE(&iter, result, exit);
+
+    out->psbt = psbt;
+    out->psbt_len = len;
+exit:
+    trace_end(&span);
+    return result;
+}
+
+int urc_crypto_psbt_serialize_header(size_t psbt_len, uint8_t *header, size_t *header_len)
+{
+    if (!header || !header_len || psbt_len == 0) {
+        return URC_EINVALIDARG;
+    }
+    // major type 2, then the length in the fewest bytes, big endian
+    const uint8_t major_type = 2 << 5;
+    const uint64_t len = psbt_len;
+    size_t argument_bytes;
+    if (len < 24) {
+        header[0] = major_type | (uint8_t)len;
+        argument_bytes = 0;
+    } else if (len <= UINT8_MAX) {
+        header[0] = major_type | 24;
+        argument_bytes = 1;
+    } else if (len <= UINT16_MAX) {
+        header[0] = major_type | 25;
+        argument_bytes = 2;
+    } else if (len <= UINT32_MAX) {
+        header[0] = major_type | 26;
+        argument_bytes = 4;
+    } else {
+        header[0] = major_type | 27;
+        argument_bytes = 8;
+    }
+    for (size_t idx = 0; idx < argument_bytes; idx++) {
+        header[1 + idx] = (uint8_t)(len >> (8 * (argument_bytes - 1 - idx)));
+    }
+    *header_len = 1 + argument_bytes;
+    return URC_OK;
+}
+
+int urc_crypto_psbt_serialize_to_buffer(const crypto_psbt *psbt, uint8_t *out, size_t out_len, size_t *cbor_len)
+{
+    if (!psbt || !psbt->psbt || (!out && out_len) || !cbor_len) {
+        return URC_EINVALIDARG;
+    }
+    uint8_t header[URC_CRYPTO_PSBT_HEADER_MAX_LEN];
+    size_t header_len;
+    int result = urc_crypto_psbt_serialize_header(psbt->psbt_len, header, &header_len);
+    if (result != URC_OK) {
+        return result;
     }
-    if (err != CborNoError) {
-        return URC_ECBORINTERNALERROR;
+    if (psbt->psbt_len > SIZE_MAX - header_len) {
+        return URC_EINVALIDARG;
+    }
+    *cbor_len = header_len + psbt->psbt_len;
+    if (out_len < *cbor_len) {
+        return URC_EBUFFERTOOSMALL;
     }
-    *out_len = cbor_encoder_get_buffer_size(&encoder, out);
+    memcpy(out, header, header_len);
+    memcpy(&out[header_len], psbt->psbt, psbt->psbt_len);
     return URC_OK;
 }
 
 int urc_crypto_psbt_serialize(const crypto_psbt *psbt, uint8_t **cbor_out, size_t *cbor_len)
 {
-    if (!psbt || !cbor_out) {
+    if (!psbt || !cbor_out || !cbor_len) {
         return URC_EINVALIDARG;
     }
     *cbor_len = 0;
     *cbor_out = NULL;
 
-    size_t buffer_len = psbt->psbt_len * 2 + 1;
-    int result = URC_OK;
-    *cbor_out = NULL;
-    do {
-        wally_free(*cbor_out);
-        *cbor_out = wally_malloc(buffer_len);
-        if (!*cbor_out) {
-            return URC_ENOMEM;
-        }
-        *cbor_len = buffer_len;
-        result = urc_crypto_psbt_serialize_impl(psbt, *cbor_out, cbor_len);
-        buffer_len *= 2;
-    } while (result == URC_EBUFFERTOOSMALL);
+    size_t len;
+    int result = urc_crypto_psbt_serialize_to_buffer(psbt, NULL, 0, &len);
+    if (result != URC_EBUFFERTOOSMALL) {
+        return result;
+    }
+    *cbor_out = urc_malloc(len);
+    if (!*cbor_out) {
+        return URC_ENOMEM;
+    }
+    result = urc_crypto_psbt_serialize_to_buffer(psbt, *cbor_out, len, cbor_len);
     if (result != URC_OK) {
-        wally_free(*cbor_out);
+        urc_free(*cbor_out);
         *cbor_out = NULL;
         *cbor_len = 0;
     }
     return result;
 }
 
+static void psbt_decoder_reset(urc_crypto_psbt_decoder *decoder)
+{
+    decoder->sink = NULL;
+    decoder->sink_ctx = NULL;
+    decoder->buffer = NULL;
+    decoder->buffer_capacity = 0;
+    decoder->psbt_len = 0;
+    decoder->expected_len = 0;
+    decoder->remaining = 0;
+    decoder->argument_bytes = 0;
+    decoder->state = psbt_decoder_state_header;
+    decoder->indefinite = false;
+    decoder->reading_chunk = false;
+    decoder->error = URC_OK;
+}
+
+void urc_crypto_psbt_decoder_init(urc_crypto_psbt_decoder *decoder, urc_crypto_psbt_sink sink, void *sink_ctx)
+{
+    psbt_decoder_reset(decoder);
+    decoder->sink = sink;
+    decoder->sink_ctx = sink_ctx;
+    if (!sink) {
+        decoder->error = URC_EINVALIDARG;
+    }
+}
+
+void urc_crypto_psbt_decoder_init_buffer(urc_crypto_psbt_decoder *decoder, uint8_t *buffer, size_t buffer_len)
+{
+    psbt_decoder_reset(decoder);
+    decoder->buffer = buffer;
+    decoder->buffer_capacity = buffer_len;
+    if (!buffer) {
+        decoder->error = URC_EINVALIDARG;
+    }
+}
+
+static int psbt_decoder_fail(urc_crypto_psbt_decoder *decoder, int error)
+{
+    decoder->error = error;
+    return error;
+}
+
+// the header argument, held in ``remaining``, is complete
+static int psbt_decoder_start_data(urc_crypto_psbt_decoder *decoder)
+{
+    if (decoder->remaining > SIZE_MAX - decoder->psbt_len) {
+        return psbt_decoder_fail(decoder, URC_EINVALIDARG);
+    }
+    if (decoder->buffer && decoder->psbt_len + decoder->remaining > decoder->buffer_capacity) {
+        return psbt_decoder_fail(decoder, URC_EBUFFERTOOSMALL);
+    }
+    if (!decoder->reading_chunk) {
+        if (decoder->remaining == 0) {
+            return psbt_decoder_fail(decoder, URC_EINVALIDARG);
+        }
+        decoder->expected_len = decoder->remaining;
+    }
+    if (decoder->remaining == 0) {
+        decoder->state = psbt_decoder_state_chunk_header;
+    } else {
+        decoder->state = psbt_decoder_state_data;
+    }
+    return URC_OK;
+}
+
+static int psbt_decoder_deliver(urc_crypto_psbt_decoder *decoder, const uint8_t *data, size_t len)
+{
+    if (decoder->sink) {
+        int result = decoder->sink(decoder->sink_ctx, data, len);
+        if (result != URC_OK) {
+            return psbt_decoder_fail(decoder, result);
+        }
+    } else {
+        memcpy(&decoder->buffer[decoder->psbt_len], data, len);
+    }
+    decoder->psbt_len += len;
+    return URC_OK;
+}
+
+int urc_crypto_psbt_decoder_push(urc_crypto_psbt_decoder *decoder, const uint8_t *chunk, size_t chunk_len)
+{
+    if (!decoder || (!chunk && chunk_len)) {
+        return URC_EINVALIDARG;
+    }
+    if (decoder->error != URC_OK) {
+        return decoder->error;
+    }
+
+    int result = URC_OK;
+    size_t pos = 0;
+    while (pos < chunk_len) {
+        switch (decoder->state) {
+        case psbt_decoder_state_header:
+        case psbt_decoder_state_chunk_header: {
+            const uint8_t initial_byte = chunk[pos++];
+            const bool in_chunks = decoder->state == psbt_decoder_state_chunk_header;
+            if (in_chunks && initial_byte == 0xff) {
+                decoder->state = psbt_decoder_state_done;
+                break;
+            }
+            const uint8_t major_type = initial_byte >> 5;
+            const uint8_t additional_info = initial_byte & 0x1f;
+            if (major_type != 2) {
+                return psbt_decoder_fail(decoder, URC_EUNEXPECTEDTYPE);
+            }
+            decoder->reading_chunk = in_chunks;
+            decoder->remaining = 0;
+            if (additional_info < 24) {
+                decoder->remaining = additional_info;
+                result = psbt_decoder_start_data(decoder);
+            } else if (additional_info <= 27) {
+                decoder->argument_bytes = 1 << (additional_info - 24);
+                decoder->state = psbt_decoder_state_argument;
+            } else if (additional_info == 31 && !in_chunks) {
+                decoder->indefinite = true;
+                decoder->state = psbt_decoder_state_chunk_header;
+            } else {
+                // reserved values, or nested indefinite length string
+                return psbt_decoder_fail(decoder, URC_ECBORINTERNALERROR);
+            }
+            break;
+        }
+        case psbt_decoder_state_argument:
+            decoder->remaining = decoder->remaining << 8 | chunk[pos++];
+            if (--decoder->argument_bytes == 0) {
+                result = psbt_decoder_start_data(decoder);
+            }
+            break;
+        case psbt_decoder_state_data: {
+            size_t len = chunk_len - pos;
+            if (decoder->remaining < len) {
+                len = (size_t)decoder->remaining;
+            }
+            result = psbt_decoder_deliver(decoder, &chunk[pos], len);
+            pos += len;
+            decoder->remaining -= len;
+            if (decoder->remaining == 0) {
+                decoder->state = decoder->indefinite ? psbt_decoder_state_chunk_header : psbt_decoder_state_done;
+            }
+            break;
+        }
+        case psbt_decoder_state_done:
+        default:
+            return psbt_decoder_fail(decoder, URC_EINVALIDARG);
+        }
+        if (result != URC_OK) {
+            return result;
+        }
+    }
+    return URC_OK;
+}
+
+int urc_crypto_psbt_decoder_expected_len(const urc_crypto_psbt_decoder *decoder, size_t *psbt_len)
+{
+    if (!decoder || !psbt_len) {
+        return URC_EINVALIDARG;
+    }
+    if (decoder->indefinite || decoder->expected_len == 0) {
+        return URC_EUNHANDLEDCASE;
+    }
+    *psbt_len = (size_t)decoder->expected_len;
+    return URC_OK;
+}
+
+int urc_crypto_psbt_decoder_finish(const urc_crypto_psbt_decoder *decoder, size_t *psbt_len)
+{
+    if (!decoder || !psbt_len) {
+        return URC_EINVALIDARG;
+    }
+    if (decoder->error != URC_OK) {
+        return decoder->error;
+    }
+    if (decoder->state != psbt_decoder_state_done) {
+        return URC_EUNEXPECTEDSTRINGLENGTH;
+    }
+    if (decoder->psbt_len == 0) {
+        return URC_EINVALIDARG;
+    }
+    *psbt_len = decoder->psbt_len;
+    return URC_OK;
+}
+
 void urc_crypto_psbt_free(crypto_psbt *psbt)
 {
     if (psbt) {
-        wally_free(psbt->psbt);
+        urc_free(psbt->psbt);
         psbt->psbt = NULL;
         psbt->psbt_len = 0;
     }
@@ -0,0 +1,152 @@
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "urc/error.h"
+
+#include "macros.h"
+#include "schema.h"
+#include "utils.h"
+
+static int decode_unsigned(CborValue *value, uint64_t max, uint64_t *out)
+{
+    if (!cbor_value_is_unsigned_integer(value)) {
+        return URC_EUNEXPECTEDTYPE;
+    }
+    CborError err = cbor_value_get_uint64(value, out);
+    if (err != CborNoError) {
+        return URC_ECBORINTERNALERROR;
+    }
+    if (*out > max) {
+        return URC_EUNHANDLEDCASE;
+    }
+    return URC_OK;
+}
+
+static int decode_value(const schema_field *field, CborValue *value, void *out, void *ctx)
+{
+    int result = URC_OK;
+    uint8_t *dest = (uint8_t *)out + field->offset;
+    uint64_t number;
+    switch (field->kind) {
+    case schema_kind_bool:
+        CHECK_IS_TYPE(value, boolean, result, exit);
+        CHECK_CBOR_ERROR(cbor_value_get_boolean(value, (bool *)dest), result, exit);
+        break;
+    case schema_kind_uint8:
+        result = decode_unsigned(value, UINT8_MAX, &number);
+        if (result == URC_OK) {
+            *(uint8_t *)dest = (uint8_t)number;
+        }
+        break;
+    case schema_kind_uint32:
+        result = decode_unsigned(value, UINT32_MAX, &number);
+        if (result == URC_OK) {
+            *(uint32_t *)dest = (uint32_t)number;
+        }
+        break;
+    case schema_kind_int32: {
+        CHECK_IS_TYPE(value, integer, result, exit);
+        int signed_number;
+        CborError err = cbor_value_get_int_checked(value, &signed_number);
+        if (err == CborErrorDataTooLarge) {
+            result = URC_EUNHANDLEDCASE;
+            goto exit;
+        }
+        CHECK_CBOR_ERROR(err, result, exit);
+        *(int32_t *)dest = signed_number;
+        break;
+    }
+    case schema_kind_uint64:
+        result = decode_unsigned(value, UINT64_MAX, (uint64_t *)dest);
+        break;
+    case schema_kind_bytes:
+        result = copy_fixed_size_byte_string(value, dest, field->size);
+        break;
+    case schema_kind_custom:
+        // custom parsers advance by themselves
+        return field->parse(value, out, ctx);
+    default:
+        return URC_EINTERNALERROR;
+    }
+    if (result != URC_OK) {
+        goto exit;
+    }
+    ADVANCE(value, result, exit);
+
+exit:
+    return result;
+}
+
+int schema_decode_entries(const schema *schema, CborValue *map_item, void *out, void *ctx)
+{
+    int result = URC_OK;
+    const schema_field *field = schema->fields;
+    const schema_field *end = schema->fields + schema->fields_count;
+
+    while (!cbor_value_at_end(map_item)) {
+        uint64_t key;
+        result = decode_unsigned(map_item, UINT8_MAX, &key);
+        if (result == URC_EUNHANDLEDCASE) {
+            result = URC_EUNKNOWNFORMAT;
+        }
+        if (result != URC_OK) {
+            goto exit;
+        }
+        // keys are sorted, fields before ``key`` are absent
+        for (; field != end && field->key < key; field++) {
+            if (!field->optional) {
+                result = URC_EUNEXPECTEDMAPKEY;
+                goto exit;
+            }
+        }
+        if (field == end || field->key != key) {
+            result = URC_EUNKNOWNFORMAT;
+            goto exit;
+        }
+        ADVANCE(map_item, result, exit);
+
+        if (field->tag) {
+            result = check_tag(map_item, field->tag);
+            if (result != URC_OK) {
+                goto exit;
+            }
+            ADVANCE(map_item, result, exit);
+        }
+        result = decode_value(field, map_item, out, ctx);
+        if (result != URC_OK) {
+            goto exit;
+        }
+        if (field->presence) {
+            *(bool *)((uint8_t *)out + field->presence - 1) = true;
+        }
+        field++;
+    }
+    for (; field != end; field++) {
+        if (!field->optional) {
+            result = URC_EUNEXPECTEDMAPKEY;
+            goto exit;
+        }
+    }
+
+exit:
+    return result;
+}
+
+int schema_decode_map(const schema *schema, CborValue *iter, void *out, void *ctx)
+{
+    int result = URC_OK;
+
+    CHECK_IS_TYPE(iter, map, result, exit);
+    CborValue map_item;
+    CborError err = cbor_value_enter_container(iter, &map_item);
+    CHECK_CBOR_ERROR(err, result, exit);
+
+    result = schema_decode_entries(schema, &map_item, out, ctx);
+    if (result != URC_OK) {
+        goto exit;
+    }
+    LEAVE_CONTAINER_SAFELY(iter, &map_item, result, exit);
+
+exit:
+    return result;
+}
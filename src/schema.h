@@ -0,0 +1,55 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cbor.h"
+
+// table driven decoding of CBOR maps with small unsigned integer keys
+// a schema lists the fields of a UR type sorted by key, decoding walks the map once: every key is read a single time
+// and matched against the next expected fields, values are decoded according to their kind straight into the
+// destination struct, at the field's offset
+// absent optional fields are left untouched, defaults are set by the caller before decoding
+
+typedef enum {
+    schema_kind_bool,   // bool
+    schema_kind_uint8,  // uint8_t, unsigned integer up to UINT8_MAX
+    schema_kind_uint32, // uint32_t, unsigned integer up to UINT32_MAX
+    schema_kind_int32,  // int32_t, signed or unsigned integer within int32_t range
+    schema_kind_uint64, // uint64_t, unsigned integer
+    schema_kind_bytes,  // byte string of exactly ``size`` bytes
+    schema_kind_custom, // decoded by ``parse``
+} schema_kind;
+
+// ``value`` is on the (untagged) value, the parser must leave it past the value
+// ``out`` is the whole destination struct, ``ctx`` the context given to schema_decode_*
+typedef int (*schema_parse_fn)(CborValue *value, void *out, void *ctx);
+
+typedef struct {
+    uint8_t key;
+    uint8_t kind;
+    bool optional;
+    uint16_t offset;
+    uint16_t size;
+    // SCHEMA_PRESENCE of a bool set when the field is found, 0 if none
+    uint16_t presence;
+    // tag the value must be introduced by, 0 if none
+    uint32_t tag;
+    schema_parse_fn parse;
+} schema_field;
+
+#define SCHEMA_PRESENCE(type, member) ((uint16_t)(offsetof(type, member) + 1))
+
+typedef struct {
+    const schema_field *fields;
+    size_t fields_count;
+} schema;
+
+#define SCHEMA(fields) {(fields), sizeof(fields) / sizeof((fields)[0])}
+
+// decodes the map ``iter`` is on and leaves it, ``iter`` ends past the map
+// a missing required key is reported as URC_EUNEXPECTEDMAPKEY, unknown or out of order keys as URC_EUNKNOWNFORMAT
+int schema_decode_map(const schema *schema, CborValue *iter, void *out, void *ctx);
+// same, on an already entered map: ``map_item`` ends at the end of the map, the caller leaves the container
+int schema_decode_entries(const schema *schema, CborValue *map_item, void *out, void *ctx);
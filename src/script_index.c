@@ -0,0 +1,236 @@
+#include <string.h>
+
+#include "wally_bip32.h"
+#include "wally_core.h"
+
+#include "urc/core.h"
+#include "urc/error.h"
+#include "urc/script_index.h"
+
+#include "utils.h"
+
+// the shortest script a deriver produces is p2wpkh
+#define SCRIPT_MIN_LEN 22
+#define MIN_ENTRIES_CAPACITY 64
+
+// every derived script ends with a hash or a public key followed by at most two opcodes, 8 of those bytes are
+// as good as a hash already
+static uint32_t script_hash(const uint8_t *script, size_t script_len)
+{
+    uint64_t word;
+    memcpy(&word, &script[script_len - 10], sizeof(word));
+    word = (word ^ script_len) * 0x9e3779b97f4a7c15ULL;
+    return (uint32_t)(word >> 32);
+}
+
+static void insert_slot(uint64_t *slots, size_t slots_mask, uint32_t hash, size_t entry)
+{
+    size_t slot = hash & slots_mask;
+    while (slots[slot]) {
+        slot = (slot + 1) & slots_mask;
+    }
+    slots[slot] = (uint64_t)hash << 32 | (uint64_t)(entry + 1);
+}
+
+// grows the entries so that ``needed`` of them fit, the slots are rebuilt at twice that capacity
+static int reserve_entries(urc_script_index *index, size_t needed)
+{
+    if (needed <= index->entries_capacity) {
+        return URC_OK;
+    }
+    size_t capacity = index->entries_capacity ? index->entries_capacity * 2 : MIN_ENTRIES_CAPACITY;
+    while (capacity < needed) {
+        capacity *= 2;
+    }
+    if (capacity >= UINT32_MAX) {
+        return URC_ENOMEM;
+    }
+    const size_t slots_count = capacity * 2;
+
+    urc_scriptpubkey *scripts = urc_malloc(sizeof(urc_scriptpubkey) * capacity);
+    urc_script_index_hit *hits = urc_malloc(sizeof(urc_script_index_hit) * capacity);
+    uint64_t *slots = urc_malloc(sizeof(uint64_t) * slots_count);
+    if (!scripts || !hits || !slots) {
+        urc_free(scripts);
+        urc_free(hits);
+        urc_free(slots);
+        return URC_ENOMEM;
+    }
+    if (index->entries_count) {
+        memcpy(scripts, index->scripts, sizeof(urc_scriptpubkey) * index->entries_count);
+        memcpy(hits, index->hits, sizeof(urc_script_index_hit) * index->entries_count);
+    }
+    memset(slots, 0, sizeof(uint64_t) * slots_count);
+    for (size_t entry = 0; entry < index->entries_count; entry++) {
+        insert_slot(slots, slots_count - 1, script_hash(scripts[entry].script, scripts[entry].script_len), entry);
+    }
+
+    urc_free(index->scripts);
+    urc_free(index->hits);
+    urc_free(index->slots);
+    index->scripts = scripts;
+    index->hits = hits;
+    index->slots = slots;
+    index->slots_mask = slots_count - 1;
+    index->entries_capacity = capacity;
+    return URC_OK;
+}
+
+// adds the scripts of indexes [derived, end) of ``chain``
+static int extend_chain(urc_script_index *index, urc_script_index_source *source, uint32_t chain, uint32_t end)
+{
+    const uint32_t begin = source->derived[chain];
+    if (end <= begin) {
+        return URC_OK;
+    }
+    const size_t count = end - begin;
+    int result = reserve_entries(index, index->entries_count + count);
+    if (result != URC_OK) {
+        return result;
+    }
+    const size_t first_entry = index->entries_count;
+    result = urc_script_deriver_derive(&source->deriver, chain, begin, count, index->threads, &index->scripts[first_entry]);
+    if (result != URC_OK) {
+        return result;
+    }
+    for (size_t idx = 0; idx < count; idx++) {
+        const size_t entry = first_entry + idx;
+        index->hits[entry].descriptor = source->descriptor;
+        index->hits[entry].chain = chain;
+        index->hits[entry].index = begin + (uint32_t)idx;
+        insert_slot(index->slots, index->slots_mask,
+                    script_hash(index->scripts[entry].script, index->scripts[entry].script_len), entry);
+    }
+    index->entries_count += count;
+    source->derived[chain] = end;
+    return URC_OK;
+}
+
+static int script_index_init_impl(urc_script_index *index, const crypto_output *descriptors, size_t descriptors_count,
+                                  uint32_t gap_limit, size_t threads)
+{
+    memset(index, 0, sizeof(*index));
+    if (gap_limit == 0 || gap_limit > BIP32_INITIAL_HARDENED_CHILD) {
+        return URC_EINVALIDARG;
+    }
+    index->gap_limit = gap_limit;
+    index->threads = threads;
+    if (descriptors_count == 0) {
+        return URC_EUNHANDLEDCASE;
+    }
+    index->sources = urc_malloc(sizeof(urc_script_index_source) * descriptors_count);
+    if (!index->sources) {
+        return URC_ENOMEM;
+    }
+
+    int result = URC_OK;
+    for (size_t idx = 0; idx < descriptors_count; idx++) {
+        urc_script_index_source *source = &index->sources[index->sources_count];
+        result = urc_script_deriver_init(&source->deriver, &descriptors[idx]);
+        if (result == URC_EUNHANDLEDCASE) {
+            continue;
+        }
+        if (result != URC_OK) {
+            goto exit;
+        }
+        source->descriptor = idx;
+        for (size_t chain = 0; chain < URC_SCRIPT_DERIVER_MAX_CHAINS; chain++) {
+            source->derived[chain] = 0;
+        }
+        index->sources_count++;
+    }
+    if (index->sources_count == 0) {
+        result = URC_EUNHANDLEDCASE;
+        goto exit;
+    }
+
+    for (size_t idx = 0; idx < index->sources_count; idx++) {
+        urc_script_index_source *source = &index->sources[idx];
+        for (uint32_t chain = 0; chain < source->deriver.chains_count; chain++) {
+            result = extend_chain(index, source, chain, gap_limit);
+            if (result != URC_OK) {
+                goto exit;
+            }
+        }
+    }
+
+exit:
+    if (result != URC_OK) {
+        urc_script_index_free(index);
+    }
+    return result;
+}
+
+int urc_script_index_init(urc_script_index *index, const crypto_account *account, uint32_t gap_limit, size_t threads)
+{
+    if (!index || !account) {
+        return URC_EINVALIDARG;
+    }
+    return script_index_init_impl(index, account->descriptors, account->descriptors_count, gap_limit, threads);
+}
+
+int urc_script_index_init_unbounded(urc_script_index *index, const crypto_account_unbounded *account, uint32_t gap_limit,
+                                    size_t threads)
+{
+    if (!index || !account) {
+        return URC_EINVALIDARG;
+    }
+    return script_index_init_impl(index, account->descriptors, account->descriptors_count, gap_limit, threads);
+}
+
+bool urc_script_index_lookup(const urc_script_index *index, const uint8_t *script, size_t script_len,
+                             urc_script_index_hit *hit)
+{
+    if (!index || !index->slots || !script || script_len < SCRIPT_MIN_LEN || script_len > URC_SCRIPTPUBKEY_MAX_LEN) {
+        return false;
+    }
+    const uint32_t hash = script_hash(script, script_len);
+    for (size_t slot = hash & index->slots_mask; index->slots[slot]; slot = (slot + 1) & index->slots_mask) {
+        const uint64_t value = index->slots[slot];
+        if ((uint32_t)(value >> 32) != hash) {
+            continue;
+        }
+        const size_t entry = (uint32_t)value - 1;
+        if (index->scripts[entry].script_len == script_len && memcmp(index->scripts[entry].script, script, script_len) == 0) {
+            if (hit) {
+                *hit = index->hits[entry];
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+int urc_script_index_mark_used(urc_script_index *index, const urc_script_index_hit *used)
+{
+    if (!index || !used || used->index >= BIP32_INITIAL_HARDENED_CHILD) {
+        return URC_EINVALIDARG;
+    }
+    for (size_t idx = 0; idx < index->sources_count; idx++) {
+        urc_script_index_source *source = &index->sources[idx];
+        if (source->descriptor != used->descriptor) {
+            continue;
+        }
+        if (used->chain >= source->deriver.chains_count) {
+            return URC_EINVALIDARG;
+        }
+        uint64_t end = (uint64_t)used->index + 1 + index->gap_limit;
+        if (end > BIP32_INITIAL_HARDENED_CHILD) {
+            end = BIP32_INITIAL_HARDENED_CHILD;
+        }
+        return extend_chain(index, source, used->chain, (uint32_t)end);
+    }
+    return URC_EINVALIDARG;
+}
+
+void urc_script_index_free(urc_script_index *index)
+{
+    if (!index) {
+        return;
+    }
+    urc_free(index->sources);
+    urc_free(index->scripts);
+    urc_free(index->hits);
+    urc_free(index->slots);
+    memset(index, 0, sizeof(*index));
+}
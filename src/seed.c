@@ -2,76 +2,87 @@
 #include "urc/crypto_seed.h"
 #include "urc/tags.h"
 
+#include "internals.h"
 #include "macros.h"
+#include "schema.h"
+#include "trace.h"
 #include "utils.h"
 
 int urc_crypto_seed_deserialize_impl(CborValue *iter, crypto_seed *out);
 
 int urc_crypto_seed_deserialize(const uint8_t *buffer, size_t len, crypto_seed *out)
 {
+    return urc_crypto_seed_deserialize_with_profile(buffer, len, out, urc_get_thread_validation_profile());
+}
+
+int urc_crypto_seed_deserialize_with_profile(const uint8_t *buffer, size_t len, crypto_seed *out, urc_validation_profile profile)
+{
+    trace_span span = trace_begin(urc_trace_type_crypto_seed, urc_trace_phase_decode);
     CborParser parser;
     CborValue iter;
-    CborError err;
-    err = cbor_parser_init(buffer, len, cbor_flags, &parser, &iter);
-    if (err != CborNoError) {
-        int result = URC_ECBORINTERNALERROR;
-        return result;
+    int result = init_cbor_parser(buffer, len, profile, &parser, &iter);
+    if (result == URC_OK) {
+        result = urc_crypto_seed_deserialize_impl(&iter, out);
     }
-    return urc_crypto_seed_deserialize_impl(&iter, out);
+    trace_end(&span);
+    return result;
 }
 
+static const schema_field seed_fields[] = {
+    {.key = 1, .kind = schema_kind_bytes, .offset = offsetof(crypto_seed, seed), .size = CRYPTO_SEED_SIZE},
+    {.key = 2,
+     .kind = schema_kind_uint64,
+     .optional = true,
+     .offset = offsetof(crypto_seed, creation_date),
+     .tag = CborNumberOfDaysSinceTheEpochDate19700101Tag},
+};
+static const schema seed_schema = SCHEMA(seed_fields);
+
 int urc_crypto_seed_deserialize_impl(CborValue *iter, crypto_seed *out)
 {
-    int result = URC_OK;
-
-    CHECK_IS_TYPE(iter, map, result, exit);
-
-    CborValue item;
-    CborError err;
-    err = cbor_value_enter_container(iter, &item);
-    CHECK_CBOR_ERROR(err, result, exit);
-
-    result = check_map_key(&item, 1);
-    if (result != URC_OK) {
-        goto exit;
-    }
-
-    ADVANCE(&item, result, exit);
-
-    result = copy_fixed_size_byte_string(&item, out->seed, CRYPTO_SEED_SIZE);
-    if (result != URC_OK) {
-        goto exit;
-    }
+    out->creation_date = 0;
+    return schema_decode_map(&seed_schema, iter, out, NULL);
+}
 
-    if (cbor_value_at_end(&item)) {
-        goto leave_and_exit;
+// the creation date is left out when 0, as the deserializer defaults it
+static int seed_serialize(CborEncoder *encoder, const void *in)
+{
+    const crypto_seed *seed = in;
+    int result = URC_OK;
+    CborEncoder map;
+    CborError err = cbor_encoder_create_map(encoder, &map, seed->creation_date ? 2 : 1);
+    CHECK_CBOR_ENCODE_ERROR(err, result, exit);
+    err = cbor_encode_uint(&map, 1);
+    CHECK_CBOR_ENCODE_ERROR(err, result, exit);
+    err = cbor_encode_byte_string(&map, seed->seed, CRYPTO_SEED_SIZE);
+    CHECK_CBOR_ENCODE_ERROR(err, result, exit);
+    if (seed->creation_date) {
+        err = cbor_encode_uint(&map, 2);
+        CHECK_CBOR_ENCODE_ERROR(err, result, exit);
+        err = cbor_encode_tag(&map, CborNumberOfDaysSinceTheEpochDate19700101Tag);
+        CHECK_CBOR_ENCODE_ERROR(err, result, exit);
+        err = cbor_encode_uint(&map, seed->creation_date);
+        CHECK_CBOR_ENCODE_ERROR(err, result, exit);
     }
+    err = cbor_encoder_close_container(encoder, &map);
+    CHECK_CBOR_ENCODE_ERROR(err, result, exit);
 
-    ADVANCE(&item, result, exit);
+exit:
+    return result;
+}
 
-    result = check_map_key(&item, 2);
-    if (result != URC_OK) {
-        goto exit;
+int urc_crypto_seed_serialize(const crypto_seed *seed, uint8_t **cbor_out, size_t *cbor_len)
+{
+    if (!seed || !cbor_out || !cbor_len) {
+        return URC_EINVALIDARG;
     }
+    return serialize_alloc(seed_serialize, seed, cbor_out, cbor_len);
+}
 
-    ADVANCE(&item, result, exit);
-
-    result = check_tag(&item, CborNumberOfDaysSinceTheEpochDate19700101Tag);
-    if (result != URC_OK) {
-        goto exit;
+int urc_crypto_seed_serialize_to_buffer(const crypto_seed *seed, uint8_t *out, size_t out_len, size_t *cbor_len)
+{
+    if (!seed || (!out && out_len) || !cbor_len) {
+        return URC_EINVALIDARG;
     }
-
-    err = cbor_value_skip_tag(&item);
-    CHECK_CBOR_ERROR(err, result, exit);
-
-    err = cbor_value_get_uint64(&item, &out->creation_date);
-    CHECK_CBOR_ERROR(err, result, exit);
-
-    ADVANCE(&item, result, exit);
-
-leave_and_exit:
-    LEAVE_CONTAINER_SAFELY(iter, &item, result, exit)
-
-exit:
-    return result;
+    return serialize_to_buffer(seed_serialize, seed, out, out_len, cbor_len);
 }
@@ -0,0 +1,88 @@
+#include <stdatomic.h>
+#include <string.h>
+
+#include "urc/stats.h"
+
+#include "stats.h"
+
+#if URC_ENABLE_STATS
+struct stats_counters {
+    atomic_uint_least64_t allocs;
+    atomic_uint_least64_t frees;
+    atomic_uint_least64_t bytes_allocated;
+    atomic_int_least64_t live_bytes;
+    atomic_int_least64_t peak_live_bytes;
+    atomic_uint_least64_t retries;
+};
+
+static _Thread_local stats_counters thread_counters;
+// set on the threads working for another one
+static _Thread_local stats_counters *thread_target = NULL;
+
+stats_counters *stats_thread_counters(void) { return thread_target ? thread_target : &thread_counters; }
+
+stats_counters *stats_set_thread_counters(stats_counters *counters)
+{
+    stats_counters *previous = stats_thread_counters();
+    thread_target = counters;
+    return previous;
+}
+
+void stats_record_malloc(size_t size)
+{
+    stats_counters *counters = stats_thread_counters();
+    atomic_fetch_add_explicit(&counters->allocs, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&counters->bytes_allocated, size, memory_order_relaxed);
+    const int_least64_t live =
+        atomic_fetch_add_explicit(&counters->live_bytes, (int_least64_t)size, memory_order_relaxed) + (int_least64_t)size;
+    int_least64_t peak = atomic_load_explicit(&counters->peak_live_bytes, memory_order_relaxed);
+    while (live > peak && !atomic_compare_exchange_weak_explicit(&counters->peak_live_bytes, &peak, live,
+                                                                 memory_order_relaxed, memory_order_relaxed)) {
+    }
+}
+
+void stats_record_free(size_t size)
+{
+    stats_counters *counters = stats_thread_counters();
+    atomic_fetch_add_explicit(&counters->frees, 1, memory_order_relaxed);
+    atomic_fetch_sub_explicit(&counters->live_bytes, (int_least64_t)size, memory_order_relaxed);
+}
+
+void stats_record_retry(void)
+{
+    atomic_fetch_add_explicit(&stats_thread_counters()->retries, 1, memory_order_relaxed);
+}
+#endif
+
+bool urc_stats_enabled(void) { return URC_ENABLE_STATS; }
+
+void urc_stats_get(urc_stats *out)
+{
+    if (!out) {
+        return;
+    }
+    memset(out, 0, sizeof(*out));
+#if URC_ENABLE_STATS
+    stats_counters *counters = &thread_counters;
+    out->allocs = atomic_load_explicit(&counters->allocs, memory_order_relaxed);
+    out->frees = atomic_load_explicit(&counters->frees, memory_order_relaxed);
+    out->bytes_allocated = atomic_load_explicit(&counters->bytes_allocated, memory_order_relaxed);
+    const int_least64_t live = atomic_load_explicit(&counters->live_bytes, memory_order_relaxed);
+    out->live_bytes = live > 0 ? (uint64_t)live : 0;
+    out->peak_live_bytes = (uint64_t)atomic_load_explicit(&counters->peak_live_bytes, memory_order_relaxed);
+    out->retries = atomic_load_explicit(&counters->retries, memory_order_relaxed);
+#endif
+}
+
+void urc_stats_reset(void)
+{
+#if URC_ENABLE_STATS
+    stats_counters *counters = &thread_counters;
+    atomic_store_explicit(&counters->allocs, 0, memory_order_relaxed);
+    atomic_store_explicit(&counters->frees, 0, memory_order_relaxed);
+    atomic_store_explicit(&counters->bytes_allocated, 0, memory_order_relaxed);
+    atomic_store_explicit(&counters->live_bytes, 0, memory_order_relaxed);
+    atomic_store_explicit(&counters->peak_live_bytes, 0, memory_order_relaxed);
+    atomic_store_explicit(&counters->retries, 0, memory_order_relaxed);
+#endif
+}
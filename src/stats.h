@@ -0,0 +1,32 @@
+#pragma once
+
+#include <stdalign.h>
+#include <stddef.h>
+
+// counters behind urc_stats, URC_ENABLE_STATS is set by the build
+#ifndef URC_ENABLE_STATS
+#define URC_ENABLE_STATS 0
+#endif
+
+// counters of a thread, which the threads working on its behalf update as well
+typedef struct stats_counters stats_counters;
+
+#if URC_ENABLE_STATS
+// urc_malloc stores the size of every allocation in front of it, keeping the alignment of the allocator
+#define STATS_HEADER_LEN (alignof(max_align_t) > sizeof(size_t) ? alignof(max_align_t) : sizeof(size_t))
+
+stats_counters *stats_thread_counters(void);
+// the previous counters are returned, NULL installs the calling thread's own
+stats_counters *stats_set_thread_counters(stats_counters *counters);
+void stats_record_malloc(size_t size);
+void stats_record_free(size_t size);
+void stats_record_retry(void);
+#else
+static inline stats_counters *stats_thread_counters(void) { return NULL; }
+static inline stats_counters *stats_set_thread_counters(stats_counters *counters)
+{
+    (void)counters;
+    return NULL;
+}
+static inline void stats_record_retry(void) {}
+#endif
@@ -0,0 +1,163 @@
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+
+#include "wally_core.h"
+
+#include "urc/error.h"
+#include "urc/stats.h"
+
+#include "trace.h"
+
+#if URC_ENABLE_TRACING
+#if URC_HAVE_SYS_SDT_H
+#include <sys/sdt.h>
+#endif
+
+typedef struct {
+    atomic_uint_least64_t count;
+    atomic_uint_least64_t total_ns;
+    atomic_uint_least64_t max_ns;
+    atomic_uint_least64_t buckets[URC_TRACE_BUCKETS];
+} trace_histogram;
+
+// histograms of a thread, written by that thread only and read by snapshots
+// blocks are never freed: the block of a thread that exits is taken over by the next thread that needs one, its
+// counts carry on growing
+typedef struct trace_block {
+    trace_histogram histograms[urc_trace_types_count][urc_trace_phases_count];
+    atomic_bool in_use;
+    struct trace_block *next;
+} trace_block;
+
+static _Atomic(trace_block *) blocks = NULL;
+static _Thread_local trace_block *thread_block = NULL;
+static _Thread_local urc_trace_type thread_type = urc_trace_type_other;
+static pthread_once_t release_key_once = PTHREAD_ONCE_INIT;
+static pthread_key_t release_key;
+static bool release_key_created = false;
+
+static void release_block(void *block) { atomic_store_explicit(&((trace_block *)block)->in_use, false, memory_order_release); }
+
+static void create_release_key(void) { release_key_created = pthread_key_create(&release_key, release_block) == 0; }
+
+static trace_block *acquire_block(void)
+{
+    pthread_once(&release_key_once, create_release_key);
+    trace_block *block = atomic_load_explicit(&blocks, memory_order_acquire);
+    for (; block; block = block->next) {
+        bool in_use = false;
+        if (atomic_compare_exchange_strong_explicit(&block->in_use, &in_use, true, memory_order_acquire,
+                                                    memory_order_relaxed)) {
+            break;
+        }
+    }
+    if (!block) {
+        block = wally_malloc(sizeof(*block));
+        if (!block) {
+            return NULL;
+        }
+        memset(block, 0, sizeof(*block));
+        atomic_init(&block->in_use, true);
+        block->next = atomic_load_explicit(&blocks, memory_order_relaxed);
+        while (!atomic_compare_exchange_weak_explicit(&blocks, &block->next, block, memory_order_release,
+                                                      memory_order_relaxed)) {
+        }
+    }
+    // without a key the block stays with this thread for good
+    if (release_key_created) {
+        pthread_setspecific(release_key, block);
+    }
+    return block;
+}
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// single writer: plain load and store, atomic only so that snapshots never read a torn value
+static inline void add(atomic_uint_least64_t *counter, uint64_t value)
+{
+    atomic_store_explicit(counter, atomic_load_explicit(counter, memory_order_relaxed) + value, memory_order_relaxed);
+}
+
+static size_t bucket(uint64_t ns)
+{
+    size_t idx = 0;
+    while (ns > 1 && idx < URC_TRACE_BUCKETS - 1) {
+        ns >>= 1;
+        idx++;
+    }
+    return idx;
+}
+
+trace_span trace_begin(urc_trace_type type, urc_trace_phase phase)
+{
+    trace_span span = {
+        .type = type == TRACE_TYPE_CURRENT ? thread_type : type,
+        .phase = phase,
+        .previous_type = thread_type,
+    };
+    thread_type = span.type;
+#if URC_HAVE_SYS_SDT_H
+    DTRACE_PROBE2(urc, span__begin, (int)span.type, (int)span.phase);
+#endif
+    span.start_ns = now_ns();
+    return span;
+}
+
+void trace_end(const trace_span *span)
+{
+    const uint64_t ns = now_ns() - span->start_ns;
+    thread_type = span->previous_type;
+#if URC_HAVE_SYS_SDT_H
+    DTRACE_PROBE3(urc, span, (int)span->type, (int)span->phase, ns);
+#endif
+    if (!thread_block) {
+        thread_block = acquire_block();
+        if (!thread_block) {
+            return;
+        }
+    }
+    trace_histogram *histogram = &thread_block->histograms[span->type][span->phase];
+    add(&histogram->count, 1);
+    add(&histogram->total_ns, ns);
+    if (ns > atomic_load_explicit(&histogram->max_ns, memory_order_relaxed)) {
+        atomic_store_explicit(&histogram->max_ns, ns, memory_order_relaxed);
+    }
+    add(&histogram->buckets[bucket(ns)], 1);
+}
+#endif
+
+bool urc_tracing_enabled(void) { return URC_ENABLE_TRACING; }
+
+int urc_stats_snapshot(urc_trace_snapshot *out)
+{
+    if (!out) {
+        return URC_EINVALIDARG;
+    }
+    memset(out, 0, sizeof(*out));
+#if URC_ENABLE_TRACING
+    for (trace_block *block = atomic_load_explicit(&blocks, memory_order_acquire); block; block = block->next) {
+        for (size_t type = 0; type < urc_trace_types_count; type++) {
+            for (size_t phase = 0; phase < urc_trace_phases_count; phase++) {
+                const trace_histogram *from = &block->histograms[type][phase];
+                urc_trace_histogram *to = &out->histograms[type][phase];
+                to->count += atomic_load_explicit(&from->count, memory_order_relaxed);
+                to->total_ns += atomic_load_explicit(&from->total_ns, memory_order_relaxed);
+                const uint64_t max_ns = atomic_load_explicit(&from->max_ns, memory_order_relaxed);
+                to->max_ns = max_ns > to->max_ns ? max_ns : to->max_ns;
+                for (size_t idx = 0; idx < URC_TRACE_BUCKETS; idx++) {
+                    to->buckets[idx] += atomic_load_explicit(&from->buckets[idx], memory_order_relaxed);
+                }
+            }
+        }
+    }
+#endif
+    return URC_OK;
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "urc/stats.h"
+
+// spans behind urc_stats_snapshot, URC_ENABLE_TRACING is set by the build
+#ifndef URC_ENABLE_TRACING
+#define URC_ENABLE_TRACING 0
+#endif
+
+// the type of the innermost span open on the calling thread, for the phases that belong to whatever called them
+#define TRACE_TYPE_CURRENT urc_trace_types_count
+
+typedef struct {
+    uint64_t start_ns;
+    urc_trace_type type;
+    urc_trace_phase phase;
+    urc_trace_type previous_type;
+} trace_span;
+
+#if URC_ENABLE_TRACING
+trace_span trace_begin(urc_trace_type type, urc_trace_phase phase);
+void trace_end(const trace_span *span);
+#else
+static inline trace_span trace_begin(urc_trace_type type, urc_trace_phase phase)
+{
+    (void)type;
+    (void)phase;
+    return (trace_span){0};
+}
+static inline void trace_end(const trace_span *span) { (void)span; }
+#endif
@@ -0,0 +1,167 @@
+#include <string.h>
+
+#include "urc/error.h"
+#include "urc/ur.h"
+
+#include "bytewords.h"
+#include "internals.h"
+
+#define UR_SCHEME_LEN 3
+
+size_t urc_ur_decoded_max_len(size_t ur_len) { return ur_len / 2; }
+
+static inline bool is_letter(char ch)
+{
+    const char lower = (char)(ch | 0x20);
+    return lower >= 'a' && lower <= 'z';
+}
+
+static inline bool is_digit(char ch) { return ch >= '0' && ch <= '9'; }
+
+// non empty [begin, end)
+static bool is_number(const char *begin, const char *end)
+{
+    if (begin == end) {
+        return false;
+    }
+    for (const char *ch = begin; ch < end; ch++) {
+        if (!is_digit(*ch)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int ur_split(const char *ur, size_t ur_len, urc_text_view *type, urc_text_view *sequence, urc_text_view *words)
+{
+    if (ur_len < UR_SCHEME_LEN || (ur[0] | 0x20) != 'u' || (ur[1] | 0x20) != 'r' || ur[2] != ':') {
+        return URC_EUNKNOWNFORMAT;
+    }
+
+    // type: letters, digits and hyphens
+    size_t pos = UR_SCHEME_LEN;
+    const size_t type_begin = pos;
+    while (pos < ur_len && ur[pos] != '/') {
+        const char ch = ur[pos];
+        if (!is_letter(ch) && !is_digit(ch) && ch != '-') {
+            return URC_EUNKNOWNFORMAT;
+        }
+        pos++;
+    }
+    if (pos == type_begin || pos == ur_len) {
+        return URC_EUNKNOWNFORMAT;
+    }
+    type->text = &ur[type_begin];
+    type->len = pos - type_begin;
+    pos++;
+
+    // ``<seqNum>-<seqLen>/`` precedes the bytewords of multipart URs
+    sequence->text = &ur[pos];
+    sequence->len = 0;
+    const char *slash = memchr(&ur[pos], '/', ur_len - pos);
+    if (slash) {
+        const char *hyphen = memchr(&ur[pos], '-', (size_t)(slash - &ur[pos]));
+        if (!hyphen || !is_number(&ur[pos], hyphen) || !is_number(hyphen + 1, slash)) {
+            return URC_EUNKNOWNFORMAT;
+        }
+        sequence->len = (size_t)(slash - &ur[pos]);
+        pos += sequence->len + 1;
+    }
+    words->text = &ur[pos];
+    words->len = ur_len - pos;
+    return URC_OK;
+}
+
+int urc_ur_decode(const char *ur, size_t ur_len, urc_text_view *type, uint8_t *out, size_t out_capacity, size_t *out_len)
+{
+    if (!ur || !type || !out_len || (!out && out_capacity)) {
+        return URC_EINVALIDARG;
+    }
+    urc_text_view sequence;
+    urc_text_view words;
+    int result = ur_split(ur, ur_len, type, &sequence, &words);
+    if (result != URC_OK) {
+        return result;
+    }
+    if (sequence.len) {
+        return URC_EUNHANDLEDCASE;
+    }
+    return bytewords_decode(words.text, words.len, out, out_capacity, out_len);
+}
+
+static const struct {
+    const char *name;
+    urc_batch_type type;
+} ur_types[] = {
+    {"crypto-seed", urc_batch_type_crypto_seed},     {"crypto-psbt", urc_batch_type_crypto_psbt},
+    {"crypto-eckey", urc_batch_type_crypto_eckey},   {"crypto-hdkey", urc_batch_type_crypto_hdkey},
+    {"crypto-output", urc_batch_type_crypto_output}, {"crypto-account", urc_batch_type_crypto_account},
+};
+
+int urc_ur_type_lookup(const char *type, size_t type_len, urc_batch_type *out)
+{
+    if (!type || !out) {
+        return URC_EINVALIDARG;
+    }
+    for (size_t idx = 0; idx < sizeof(ur_types) / sizeof(ur_types[0]); idx++) {
+        const char *name = ur_types[idx].name;
+        if (strlen(name) != type_len) {
+            continue;
+        }
+        size_t matched = 0;
+        while (matched < type_len && (type[matched] | 0x20) == name[matched]) {
+            matched++;
+        }
+        if (matched == type_len) {
+            *out = ur_types[idx].type;
+            return URC_OK;
+        }
+    }
+    return URC_EUNIMPLEMENTEDURTYPE;
+}
+
+int ur_object_deserialize(const char *type, size_t type_len, const uint8_t *cbor, size_t cbor_len,
+                          urc_validation_profile profile, urc_ur_object *out)
+{
+    int result = urc_ur_type_lookup(type, type_len, &out->type);
+    if (result != URC_OK) {
+        return result;
+    }
+
+    switch (out->type) {
+    case urc_batch_type_crypto_seed:
+        return urc_crypto_seed_deserialize_with_profile(cbor, cbor_len, &out->value.seed, profile);
+    case urc_batch_type_crypto_psbt:
+        return urc_crypto_psbt_deserialize_borrowed_with_profile(cbor, cbor_len, &out->value.psbt, profile);
+    case urc_batch_type_crypto_eckey:
+        return urc_crypto_eckey_deserialize_with_profile(cbor, cbor_len, &out->value.eckey, profile);
+    case urc_batch_type_crypto_hdkey:
+        return urc_crypto_hdkey_deserialize_with_profile(cbor, cbor_len, &out->value.hdkey, profile);
+    case urc_batch_type_crypto_output:
+        return urc_crypto_output_deserialize_with_profile(cbor, cbor_len, &out->value.output, profile);
+    case urc_batch_type_crypto_account:
+        return urc_crypto_account_deserialize_with_profile(cbor, cbor_len, &out->value.account, profile);
+    default:
+        return URC_EUNIMPLEMENTEDURTYPE;
+    }
+}
+
+int urc_ur_deserialize(const char *ur, size_t ur_len, uint8_t *buffer, size_t buffer_len, urc_ur_object *out)
+{
+    return urc_ur_deserialize_with_profile(ur, ur_len, buffer, buffer_len, urc_get_thread_validation_profile(), out);
+}
+
+int urc_ur_deserialize_with_profile(const char *ur, size_t ur_len, uint8_t *buffer, size_t buffer_len,
+                                    urc_validation_profile profile, urc_ur_object *out)
+{
+    if (!out) {
+        return URC_EINVALIDARG;
+    }
+    urc_text_view type;
+    size_t cbor_len;
+    int result = urc_ur_decode(ur, ur_len, &type, buffer, buffer_len, &cbor_len);
+    if (result != URC_OK) {
+        return result;
+    }
+    return ur_object_deserialize(type.text, type.len, buffer, cbor_len, profile, out);
+}
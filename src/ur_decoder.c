@@ -0,0 +1,574 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "cbor.h"
+
+#include "urc/core.h"
+#include "urc/error.h"
+#include "urc/fountain.h"
+
+#include "bytewords.h"
+#include "crc32.h"
+#include "fountain.h"
+#include "internals.h"
+#include "macros.h"
+#include "utils.h"
+
+#define PART_FIELDS 5
+
+typedef struct {
+    uint32_t seq_num;
+    uint32_t seq_len;
+    uint64_t message_len;
+    uint32_t checksum;
+    const uint8_t *fragment;
+    size_t fragment_len;
+} part_header;
+
+static inline bool bit_test(const uint64_t *bits, uint32_t idx) { return (bits[idx / 64] >> (idx % 64)) & 1; }
+static inline void bit_set(uint64_t *bits, uint32_t idx) { bits[idx / 64] |= (uint64_t)1 << (idx % 64); }
+
+static inline uint8_t *fragment_at(const urc_ur_decoder *decoder, uint32_t idx)
+{
+    return &decoder->fragments[(size_t)idx * decoder->fragment_len];
+}
+
+// part data from the start of the store, index lists from its end
+static inline uint8_t *mixed_data_at(const urc_ur_decoder *decoder, size_t slot)
+{
+    return &decoder->mixed_store[slot * decoder->fragment_len];
+}
+
+static inline uint32_t *mixed_indexes_at(const urc_ur_decoder *decoder, size_t slot)
+{
+    return &((uint32_t *)decoder->mixed_store)[decoder->mixed_offsets[slot]];
+}
+
+void urc_ur_decoder_init(urc_ur_decoder *decoder, size_t max_message_len)
+{
+    memset(decoder, 0, sizeof(*decoder));
+    decoder->max_message_len = max_message_len;
+    decoder->validation_profile = urc_get_thread_validation_profile();
+}
+
+void urc_ur_decoder_set_validation_profile(urc_ur_decoder *decoder, urc_validation_profile profile)
+{
+    if (decoder) {
+        decoder->validation_profile = profile;
+    }
+}
+
+void urc_ur_decoder_free(urc_ur_decoder *decoder)
+{
+    if (!decoder) {
+        return;
+    }
+    urc_free(decoder->fragments);
+    urc_free(decoder->received);
+    urc_free(decoder->mixed_store);
+    urc_free(decoder->mixed_offsets);
+    urc_free(decoder->mixed_degrees);
+    urc_free(decoder->scratch);
+    urc_free(decoder->pending);
+    urc_free(decoder->chosen);
+    urc_free(decoder->part);
+    fountain_sampler_free(&decoder->sampler);
+    urc_validation_profile profile = decoder->validation_profile;
+    urc_ur_decoder_init(decoder, decoder->max_message_len);
+    decoder->validation_profile = profile;
+}
+
+bool urc_ur_decoder_is_complete(const urc_ur_decoder *decoder)
+{
+    return decoder && decoder->error == URC_OK && decoder->seq_len && decoder->received_count == decoder->seq_len;
+}
+
+double urc_ur_decoder_progress(const urc_ur_decoder *decoder)
+{
+    if (!decoder || !decoder->seq_len) {
+        return 0;
+    }
+    return (double)decoder->received_count / (double)decoder->seq_len;
+}
+
+static void copy_type(urc_ur_decoder *decoder, const urc_text_view *type)
+{
+    for (size_t idx = 0; idx < type->len; idx++) {
+        const char ch = type->text[idx];
+        decoder->type[idx] = ch >= 'A' && ch <= 'Z' ? (char)(ch - 'A' + 'a') : ch;
+    }
+    decoder->type_len = type->len;
+}
+
+static int parse_sequence_number(const char *text, size_t len, uint32_t *out)
+{
+    uint64_t value = 0;
+    for (size_t idx = 0; idx < len; idx++) {
+        value = value * 10 + (uint64_t)(text[idx] - '0');
+        if (value > UINT32_MAX) {
+            return URC_EUNKNOWNFORMAT;
+        }
+    }
+    *out = (uint32_t)value;
+    return URC_OK;
+}
+
+static int parse_uint32(CborValue *cursor, uint32_t *out)
+{
+    if (!cbor_value_is_unsigned_integer(cursor)) {
+        return URC_EUNEXPECTEDTYPE;
+    }
+    uint64_t value;
+    if (cbor_value_get_uint64(cursor, &value) != CborNoError) {
+        return URC_ECBORINTERNALERROR;
+    }
+    if (value > UINT32_MAX) {
+        return URC_EUNKNOWNFORMAT;
+    }
+    *out = (uint32_t)value;
+    return URC_OK;
+}
+
+// [seqNum, seqLen, messageLen, checksum, fragment]
+static int parse_part(const uint8_t *cbor, size_t cbor_len, urc_validation_profile profile, part_header *out)
+{
+    CborParser parser;
+    CborValue iter;
+    int result = init_cbor_parser(cbor, cbor_len, profile, &parser, &iter);
+    if (result != URC_OK) {
+        return result;
+    }
+
+    CHECK_IS_TYPE(&iter, array, result, exit);
+    size_t fields;
+    CborError err = cbor_value_get_array_length(&iter, &fields);
+    CHECK_CBOR_ERROR(err, result, exit);
+    if (fields != PART_FIELDS) {
+        result = URC_EUNKNOWNFORMAT;
+        goto exit;
+    }
+    CborValue field;
+    err = cbor_value_enter_container(&iter, &field);
+    CHECK_CBOR_ERROR(err, result, exit);
+
+    result = parse_uint32(&field, &out->seq_num);
+    if (result != URC_OK) {
+        goto exit;
+    }
+    ADVANCE(&field, result, exit);
+    result = parse_uint32(&field, &out->seq_len);
+    if (result != URC_OK) {
+        goto exit;
+    }
+    ADVANCE(&field, result, exit);
+    CHECK_IS_TYPE(&field, unsigned_integer, result, exit);
+    err = cbor_value_get_uint64(&field, &out->message_len);
+    CHECK_CBOR_ERROR(err, result, exit);
+    ADVANCE(&field, result, exit);
+    result = parse_uint32(&field, &out->checksum);
+    if (result != URC_OK) {
+        goto exit;
+    }
+    ADVANCE(&field, result, exit);
+    CHECK_IS_TYPE(&field, byte_string, result, exit);
+    result = borrow_byte_string(&field, &out->fragment, &out->fragment_len);
+    if (result != URC_OK) {
+        goto exit;
+    }
+    ADVANCE(&field, result, exit);
+    LEAVE_CONTAINER_SAFELY(&iter, &field, result, exit);
+
+    // the fragment length follows from the message length and the fragment count
+    if (out->seq_num == 0 || out->seq_len == 0 || out->message_len == 0 || out->fragment_len == 0 ||
+        (out->message_len + out->fragment_len - 1) / out->fragment_len != out->seq_len) {
+        result = URC_EUNKNOWNFORMAT;
+    }
+
+exit:
+    return result;
+}
+
+// sizes the buffers for ``header``, the first part of a message
+static int start_message(urc_ur_decoder *decoder, const urc_text_view *type, const part_header *header)
+{
+    if (type->len > URC_UR_DECODER_TYPE_MAX_LEN) {
+        return URC_EUNKNOWNFORMAT;
+    }
+    // the mixed store is twice the fragments, which take less than twice the message
+    if ((decoder->max_message_len && header->message_len > decoder->max_message_len) || header->message_len > SIZE_MAX / 8) {
+        return URC_EBUFFERTOOSMALL;
+    }
+    // a few words of bookkeeping per fragment, tiny fragments would make it outgrow the message many times over
+    const size_t seq_len = header->seq_len;
+    if (seq_len > 1 && header->fragment_len < URC_UR_DECODER_MIN_FRAGMENT_LEN) {
+        return URC_EUNKNOWNFORMAT;
+    }
+    const size_t bitset_words = (seq_len + 63) / 64;
+    const size_t fragments_size = seq_len * header->fragment_len;
+    const size_t store_words = (fragments_size + 1) / 2;
+    // every stored part mixes two fragments at least
+    const size_t capacity = store_words * sizeof(uint32_t) / (header->fragment_len + 2 * sizeof(uint32_t)) + 1;
+
+    copy_type(decoder, type);
+    decoder->seq_len = header->seq_len;
+    decoder->checksum = header->checksum;
+    decoder->message_len = (size_t)header->message_len;
+    decoder->fragment_len = header->fragment_len;
+    decoder->bitset_words = bitset_words;
+
+    decoder->mixed_store_words = store_words;
+    decoder->mixed_low = store_words;
+    decoder->mixed_capacity = capacity;
+
+    decoder->fragments = urc_malloc(fragments_size);
+    decoder->received = urc_malloc(sizeof(uint64_t) * bitset_words);
+    decoder->mixed_store = urc_malloc(sizeof(uint32_t) * store_words);
+    decoder->mixed_offsets = urc_malloc(sizeof(size_t) * capacity);
+    decoder->mixed_degrees = urc_malloc(sizeof(uint32_t) * capacity);
+    decoder->scratch = urc_malloc(header->fragment_len);
+    decoder->pending = urc_malloc(sizeof(uint32_t) * seq_len);
+    decoder->chosen = urc_malloc(sizeof(uint32_t) * seq_len);
+    if (!decoder->fragments || !decoder->received || !decoder->mixed_store || !decoder->mixed_offsets ||
+        !decoder->mixed_degrees || !decoder->scratch || !decoder->pending || !decoder->chosen) {
+        return URC_ENOMEM;
+    }
+    memset(decoder->received, 0, sizeof(uint64_t) * bitset_words);
+    return fountain_sampler_init(&decoder->sampler, header->seq_len);
+}
+
+static bool same_message(const urc_ur_decoder *decoder, const urc_text_view *type, const part_header *header)
+{
+    if (type->len != decoder->type_len || header->seq_len != decoder->seq_len || header->checksum != decoder->checksum ||
+        header->message_len != decoder->message_len || header->fragment_len != decoder->fragment_len) {
+        return false;
+    }
+    for (size_t idx = 0; idx < type->len; idx++) {
+        if ((type->text[idx] | 0x20) != (decoder->type[idx] | 0x20)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// the space of a removed part is reclaimed when the store is compacted
+static void remove_mixed(urc_ur_decoder *decoder, size_t slot)
+{
+    decoder->mixed_degrees[slot] = 0;
+    decoder->mixed_count--;
+}
+
+static bool find_index(const uint32_t *indexes, uint32_t degree, uint32_t idx, uint32_t *pos)
+{
+    uint32_t low = 0;
+    uint32_t high = degree;
+    while (low < high) {
+        const uint32_t mid = low + (high - low) / 2;
+        if (indexes[mid] < idx) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    *pos = low;
+    return low < degree && indexes[low] == idx;
+}
+
+static int compare_indexes(const void *lhs, const void *rhs)
+{
+    const uint32_t left = *(const uint32_t *)lhs;
+    const uint32_t right = *(const uint32_t *)rhs;
+    return (left > right) - (left < right);
+}
+
+// stores fragment ``idx`` and peels it off the mixed parts, which can reveal further fragments in turn
+static void add_fragment(urc_ur_decoder *decoder, uint32_t idx, const uint8_t *data)
+{
+    if (bit_test(decoder->received, idx)) {
+        return;
+    }
+    memcpy(fragment_at(decoder, idx), data, decoder->fragment_len);
+    bit_set(decoder->received, idx);
+    decoder->received_count++;
+    size_t pending_count = 0;
+    decoder->pending[pending_count++] = idx;
+
+    while (pending_count) {
+        const uint32_t known = decoder->pending[--pending_count];
+        for (size_t slot = 0; slot < decoder->mixed_slots; slot++) {
+            const uint32_t degree = decoder->mixed_degrees[slot];
+            if (!degree) {
+                continue;
+            }
+            uint32_t *indexes = mixed_indexes_at(decoder, slot);
+            uint32_t pos;
+            if (!find_index(indexes, degree, known, &pos)) {
+                continue;
+            }
+            fountain_xor(mixed_data_at(decoder, slot), fragment_at(decoder, known), decoder->fragment_len);
+            memmove(&indexes[pos], &indexes[pos + 1], sizeof(uint32_t) * (degree - pos - 1));
+            decoder->mixed_degrees[slot] = degree - 1;
+            if (degree - 1 > 1) {
+                continue;
+            }
+            // a fragment still pending may be the one left
+            const uint32_t revealed = indexes[0];
+            if (!bit_test(decoder->received, revealed)) {
+                memcpy(fragment_at(decoder, revealed), mixed_data_at(decoder, slot), decoder->fragment_len);
+                bit_set(decoder->received, revealed);
+                decoder->received_count++;
+                decoder->pending[pending_count++] = revealed;
+            }
+            remove_mixed(decoder, slot);
+        }
+    }
+}
+
+static bool has_room(const urc_ur_decoder *decoder, uint32_t degree)
+{
+    return decoder->mixed_slots < decoder->mixed_capacity && decoder->mixed_low >= degree &&
+           (decoder->mixed_slots + 1) * decoder->fragment_len <= (decoder->mixed_low - degree) * sizeof(uint32_t);
+}
+
+// reclaims the space of the removed parts, the stored ones keep their order
+static void compact_mixed(urc_ur_decoder *decoder)
+{
+    uint32_t *words = (uint32_t *)decoder->mixed_store;
+    size_t low = decoder->mixed_store_words;
+    size_t count = 0;
+    for (size_t slot = 0; slot < decoder->mixed_slots; slot++) {
+        const uint32_t degree = decoder->mixed_degrees[slot];
+        if (!degree) {
+            continue;
+        }
+        // index lists only move towards the end of the store and part data towards its start
+        low -= degree;
+        memmove(&words[low], mixed_indexes_at(decoder, slot), sizeof(uint32_t) * degree);
+        memmove(mixed_data_at(decoder, count), mixed_data_at(decoder, slot), decoder->fragment_len);
+        decoder->mixed_offsets[count] = low;
+        decoder->mixed_degrees[count] = degree;
+        count++;
+    }
+    decoder->mixed_slots = count;
+    decoder->mixed_low = low;
+}
+
+// once the store is full, the part mixing the most fragments makes room for one mixing fewer
+static bool make_room(urc_ur_decoder *decoder, uint32_t degree)
+{
+    if (has_room(decoder, degree)) {
+        return true;
+    }
+    compact_mixed(decoder);
+    if (has_room(decoder, degree)) {
+        return true;
+    }
+    size_t widest = 0;
+    for (size_t slot = 1; slot < decoder->mixed_slots; slot++) {
+        if (decoder->mixed_degrees[slot] > decoder->mixed_degrees[widest]) {
+            widest = slot;
+        }
+    }
+    if (!decoder->mixed_slots || decoder->mixed_degrees[widest] <= degree) {
+        return false;
+    }
+    // the space it frees, its data and more indexes than ``degree``, is enough
+    remove_mixed(decoder, widest);
+    compact_mixed(decoder);
+    return has_room(decoder, degree);
+}
+
+// reduces the part by the fragments already known, keeps it if it still mixes several of them
+static void add_mixed(urc_ur_decoder *decoder, uint32_t *chosen, uint32_t degree, const uint8_t *data)
+{
+    uint8_t *mixed = decoder->scratch;
+    memcpy(mixed, data, decoder->fragment_len);
+    uint32_t unknown = 0;
+    for (uint32_t idx = 0; idx < degree; idx++) {
+        if (bit_test(decoder->received, chosen[idx])) {
+            fountain_xor(mixed, fragment_at(decoder, chosen[idx]), decoder->fragment_len);
+        } else {
+            chosen[unknown++] = chosen[idx];
+        }
+    }
+    if (unknown == 0) {
+        return;
+    }
+    if (unknown == 1) {
+        add_fragment(decoder, chosen[0], mixed);
+        return;
+    }
+    // sorted index lists, compared as a whole and searched by bisection
+    qsort(chosen, unknown, sizeof(uint32_t), compare_indexes);
+    for (size_t slot = 0; slot < decoder->mixed_slots; slot++) {
+        if (decoder->mixed_degrees[slot] == unknown &&
+            memcmp(mixed_indexes_at(decoder, slot), chosen, sizeof(uint32_t) * unknown) == 0) {
+            return;
+        }
+    }
+    // a part that doesn't fit is dropped, the stream goes on and later parts make up for it
+    if (!make_room(decoder, unknown)) {
+        return;
+    }
+    const size_t slot = decoder->mixed_slots++;
+    decoder->mixed_low -= unknown;
+    decoder->mixed_offsets[slot] = decoder->mixed_low;
+    decoder->mixed_degrees[slot] = unknown;
+    memcpy(mixed_indexes_at(decoder, slot), chosen, sizeof(uint32_t) * unknown);
+    memcpy(mixed_data_at(decoder, slot), mixed, decoder->fragment_len);
+    decoder->mixed_count++;
+}
+
+static int receive_single_part(urc_ur_decoder *decoder, const urc_text_view *type, const urc_text_view *words)
+{
+    if (type->len > URC_UR_DECODER_TYPE_MAX_LEN) {
+        return URC_EUNKNOWNFORMAT;
+    }
+    size_t capacity = words->len / 2;
+    if (decoder->max_message_len && capacity > decoder->max_message_len) {
+        capacity = decoder->max_message_len;
+    }
+    decoder->fragments = urc_malloc(capacity ? capacity : 1);
+    if (!decoder->fragments) {
+        return URC_ENOMEM;
+    }
+    size_t message_len;
+    int result = bytewords_decode(words->text, words->len, decoder->fragments, capacity, &message_len);
+    if (result != URC_OK) {
+        return result;
+    }
+    copy_type(decoder, type);
+    decoder->message_len = message_len;
+    decoder->fragment_len = message_len;
+    decoder->seq_len = 1;
+    decoder->received_count = 1;
+    return URC_OK;
+}
+
+int urc_ur_decoder_receive(urc_ur_decoder *decoder, const char *part, size_t part_len)
+{
+    if (!decoder || !part) {
+        return URC_EINVALIDARG;
+    }
+    if (decoder->error != URC_OK) {
+        return decoder->error;
+    }
+    urc_text_view type;
+    urc_text_view sequence;
+    urc_text_view words;
+    int result = ur_split(part, part_len, &type, &sequence, &words);
+    if (result != URC_OK) {
+        return result;
+    }
+
+    if (urc_ur_decoder_is_complete(decoder)) {
+        return URC_OK;
+    }
+
+    if (!sequence.len) {
+        if (decoder->seq_len) {
+            return URC_EINVALIDARG;
+        }
+        result = receive_single_part(decoder, &type, &words);
+        if (result != URC_OK) {
+            urc_ur_decoder_free(decoder);
+        }
+        return result;
+    }
+
+    // ``<seqNum>-<seqLen>``, checked against the part itself
+    const char *hyphen = memchr(sequence.text, '-', sequence.len);
+    uint32_t seq_num;
+    uint32_t seq_len;
+    result = parse_sequence_number(sequence.text, (size_t)(hyphen - sequence.text), &seq_num);
+    if (result != URC_OK) {
+        return result;
+    }
+    result = parse_sequence_number(hyphen + 1, sequence.len - (size_t)(hyphen + 1 - sequence.text), &seq_len);
+    if (result != URC_OK) {
+        return result;
+    }
+
+    if (decoder->part_capacity < words.len / 2) {
+        urc_free(decoder->part);
+        decoder->part_capacity = 0;
+        decoder->part = urc_malloc(words.len / 2);
+        if (!decoder->part) {
+            return URC_ENOMEM;
+        }
+        decoder->part_capacity = words.len / 2;
+    }
+    size_t cbor_len;
+    result = bytewords_decode(words.text, words.len, decoder->part, decoder->part_capacity, &cbor_len);
+    if (result != URC_OK) {
+        return result;
+    }
+    part_header header;
+    result = parse_part(decoder->part, cbor_len, decoder->validation_profile, &header);
+    if (result != URC_OK) {
+        return result;
+    }
+    if (header.seq_num != seq_num || header.seq_len != seq_len) {
+        return URC_EUNKNOWNFORMAT;
+    }
+
+    if (!decoder->seq_len) {
+        result = start_message(decoder, &type, &header);
+        if (result != URC_OK) {
+            urc_ur_decoder_free(decoder);
+            return result;
+        }
+    } else if (!same_message(decoder, &type, &header)) {
+        return URC_EINVALIDARG;
+    }
+
+    uint32_t degree;
+    result = fountain_choose_fragments(&decoder->sampler, header.seq_num, header.checksum, decoder->chosen, &degree);
+    if (result != URC_OK) {
+        return result;
+    }
+    if (degree == 1) {
+        add_fragment(decoder, decoder->chosen[0], header.fragment);
+    } else {
+        add_mixed(decoder, decoder->chosen, degree, header.fragment);
+    }
+
+    if (decoder->received_count == decoder->seq_len &&
+        urc_crc32_update(0, decoder->fragments, decoder->message_len) != decoder->checksum) {
+        decoder->error = URC_EINVALIDCHECKSUM;
+        return decoder->error;
+    }
+    return URC_OK;
+}
+
+int urc_ur_decoder_result(const urc_ur_decoder *decoder, urc_text_view *type, const uint8_t **message, size_t *message_len)
+{
+    if (!decoder || !type || !message || !message_len) {
+        return URC_EINVALIDARG;
+    }
+    if (decoder->error != URC_OK) {
+        return decoder->error;
+    }
+    if (!urc_ur_decoder_is_complete(decoder)) {
+        return URC_EUNHANDLEDCASE;
+    }
+    type->text = decoder->type;
+    type->len = decoder->type_len;
+    *message = decoder->fragments;
+    *message_len = decoder->message_len;
+    return URC_OK;
+}
+
+int urc_ur_decoder_deserialize(const urc_ur_decoder *decoder, urc_ur_object *out)
+{
+    if (!out) {
+        return URC_EINVALIDARG;
+    }
+    urc_text_view type;
+    const uint8_t *message;
+    size_t message_len;
+    int result = urc_ur_decoder_result(decoder, &type, &message, &message_len);
+    if (result != URC_OK) {
+        return result;
+    }
+    return ur_object_deserialize(type.text, type.len, message, message_len, decoder->validation_profile, out);
+}
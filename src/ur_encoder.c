@@ -0,0 +1,252 @@
+#include <string.h>
+
+#include "cbor.h"
+
+#include "urc/core.h"
+#include "urc/error.h"
+#include "urc/fountain.h"
+
+#include "bytewords.h"
+#include "crc32.h"
+#include "fountain.h"
+#include "macros.h"
+#include "utils.h"
+
+#define UR_SCHEME "ur:"
+#define UR_SCHEME_LEN 3
+#define PART_FIELDS 5
+// array, four integers and the byte string header
+#define PART_HEADER_MAX_LEN (1 + 5 + 5 + 9 + 5 + 9)
+// ``<seqNum>-<seqLen>/``
+#define SEQUENCE_MAX_LEN (10 + 1 + 10 + 1)
+#define PSBT_UR_TYPE "crypto-psbt"
+
+// bc-ur's find_nominal_fragment_length looks for the smallest fragment count whose fragments are not longer than
+// ``max_fragment_len``, that is ceil(message_len / max_fragment_len)
+static size_t nominal_fragment_len(size_t message_len, size_t max_fragment_len)
+{
+    const size_t count = (message_len + max_fragment_len - 1) / max_fragment_len;
+    return (message_len + count - 1) / count;
+}
+
+// ``ur:<type>/``
+static size_t write_prefix(const urc_ur_encoder *encoder, char *out)
+{
+    memcpy(out, UR_SCHEME, UR_SCHEME_LEN);
+    memcpy(&out[UR_SCHEME_LEN], encoder->type, encoder->type_len);
+    out[UR_SCHEME_LEN + encoder->type_len] = '/';
+    return UR_SCHEME_LEN + encoder->type_len + 1;
+}
+
+static size_t write_decimal(uint32_t value, char *out)
+{
+    char digits[10];
+    size_t count = 0;
+    do {
+        digits[count++] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value);
+    for (size_t idx = 0; idx < count; idx++) {
+        out[idx] = digits[count - 1 - idx];
+    }
+    return count;
+}
+
+void urc_ur_encoder_free(urc_ur_encoder *encoder)
+{
+    if (!encoder) {
+        return;
+    }
+    urc_free(encoder->fragments);
+    urc_free(encoder->chosen);
+    urc_free(encoder->mixed);
+    urc_free(encoder->part);
+    urc_free(encoder->text);
+    fountain_sampler_free(&encoder->sampler);
+    memset(encoder, 0, sizeof(*encoder));
+}
+
+// the message is ``header`` followed by ``body``, so that a crypto-psbt is copied once, straight into the fragments
+static int encoder_init_impl(urc_ur_encoder *encoder, const char *type, const uint8_t *header, size_t header_len,
+                             const uint8_t *body, size_t body_len, size_t max_fragment_len)
+{
+    const size_t type_len = strlen(type);
+    if (type_len == 0 || type_len > URC_UR_DECODER_TYPE_MAX_LEN) {
+        return URC_EINVALIDARG;
+    }
+    for (size_t idx = 0; idx < type_len; idx++) {
+        const char ch = type[idx];
+        if (!(ch >= 'a' && ch <= 'z') && !(ch >= '0' && ch <= '9') && ch != '-') {
+            return URC_EINVALIDARG;
+        }
+    }
+    if (body_len > SIZE_MAX / 4 - header_len) {
+        return URC_EINVALIDARG;
+    }
+    const size_t cbor_len = header_len + body_len;
+    if (cbor_len == 0 || max_fragment_len < URC_UR_ENCODER_MIN_FRAGMENT_LEN) {
+        return URC_EINVALIDARG;
+    }
+
+    memcpy(encoder->type, type, type_len);
+    encoder->type_len = type_len;
+    encoder->message_len = cbor_len;
+    encoder->fragment_len = nominal_fragment_len(cbor_len, max_fragment_len);
+    const size_t seq_len = (cbor_len + encoder->fragment_len - 1) / encoder->fragment_len;
+    if (seq_len > UINT32_MAX) {
+        return URC_EINVALIDARG;
+    }
+    encoder->seq_len = (uint32_t)seq_len;
+
+    encoder->fragments = urc_malloc(seq_len * encoder->fragment_len);
+    if (!encoder->fragments) {
+        return URC_ENOMEM;
+    }
+    uint8_t *cbor = encoder->fragments;
+    if (header_len) {
+        memcpy(cbor, header, header_len);
+    }
+    memcpy(&cbor[header_len], body, body_len);
+    encoder->checksum = urc_crc32_update(0, cbor, cbor_len);
+    memset(&encoder->fragments[cbor_len], 0, seq_len * encoder->fragment_len - cbor_len);
+
+    if (seq_len == 1) {
+        // the whole message in bytewords, written once
+        encoder->text_capacity = UR_SCHEME_LEN + type_len + 1 + BYTEWORDS_MINIMAL_LEN(cbor_len) + 1;
+        encoder->text = urc_malloc(encoder->text_capacity);
+        if (!encoder->text) {
+            return URC_ENOMEM;
+        }
+        size_t len = write_prefix(encoder, encoder->text);
+        len += bytewords_encode_minimal(cbor, cbor_len, &encoder->text[len]);
+        encoder->text[len] = '\0';
+        return URC_OK;
+    }
+
+    encoder->part_capacity = PART_HEADER_MAX_LEN + encoder->fragment_len;
+    encoder->text_capacity =
+        UR_SCHEME_LEN + type_len + 1 + SEQUENCE_MAX_LEN + BYTEWORDS_MINIMAL_LEN(encoder->part_capacity) + 1;
+    encoder->chosen = urc_malloc(sizeof(uint32_t) * seq_len);
+    encoder->mixed = urc_malloc(encoder->fragment_len);
+    encoder->part = urc_malloc(encoder->part_capacity);
+    encoder->text = urc_malloc(encoder->text_capacity);
+    if (!encoder->chosen || !encoder->mixed || !encoder->part || !encoder->text) {
+        return URC_ENOMEM;
+    }
+    return fountain_sampler_init(&encoder->sampler, encoder->seq_len);
+}
+
+int urc_ur_encoder_init(urc_ur_encoder *encoder, const char *type, const uint8_t *cbor, size_t cbor_len,
+                        size_t max_fragment_len)
+{
+    if (!encoder) {
+        return URC_EINVALIDARG;
+    }
+    memset(encoder, 0, sizeof(*encoder));
+    if (!type || !cbor) {
+        return URC_EINVALIDARG;
+    }
+    int result = encoder_init_impl(encoder, type, NULL, 0, cbor, cbor_len, max_fragment_len);
+    if (result != URC_OK) {
+        urc_ur_encoder_free(encoder);
+    }
+    return result;
+}
+
+int urc_ur_encoder_init_psbt(urc_ur_encoder *encoder, const crypto_psbt *psbt, size_t max_fragment_len)
+{
+    if (!encoder) {
+        return URC_EINVALIDARG;
+    }
+    memset(encoder, 0, sizeof(*encoder));
+    if (!psbt) {
+        return URC_EINVALIDARG;
+    }
+    if (!psbt->psbt) {
+        return URC_EINVALIDARG;
+    }
+    uint8_t header[URC_CRYPTO_PSBT_HEADER_MAX_LEN];
+    size_t header_len;
+    int result = urc_crypto_psbt_serialize_header(psbt->psbt_len, header, &header_len);
+    if (result != URC_OK) {
+        return result;
+    }
+    result = encoder_init_impl(encoder, PSBT_UR_TYPE, header, header_len, psbt->psbt, psbt->psbt_len, max_fragment_len);
+    if (result != URC_OK) {
+        urc_ur_encoder_free(encoder);
+    }
+    return result;
+}
+
+uint32_t urc_ur_encoder_seq_len(const urc_ur_encoder *encoder) { return encoder ? encoder->seq_len : 0; }
+
+// [seqNum, seqLen, messageLen, checksum, fragment]
+static int encode_part(const urc_ur_encoder *encoder, size_t *part_len)
+{
+    int result = URC_OK;
+    CborEncoder cbor;
+    CborEncoder fields;
+    cbor_encoder_init(&cbor, encoder->part, encoder->part_capacity, 0);
+    CborError err = cbor_encoder_create_array(&cbor, &fields, PART_FIELDS);
+    CHECK_CBOR_ERROR(err, result, exit);
+    err = cbor_encode_uint(&fields, encoder->seq_num);
+    CHECK_CBOR_ERROR(err, result, exit);
+    err = cbor_encode_uint(&fields, encoder->seq_len);
+    CHECK_CBOR_ERROR(err, result, exit);
+    err = cbor_encode_uint(&fields, encoder->message_len);
+    CHECK_CBOR_ERROR(err, result, exit);
+    err = cbor_encode_uint(&fields, encoder->checksum);
+    CHECK_CBOR_ERROR(err, result, exit);
+    err = cbor_encode_byte_string(&fields, encoder->mixed, encoder->fragment_len);
+    CHECK_CBOR_ERROR(err, result, exit);
+    err = cbor_encoder_close_container(&cbor, &fields);
+    CHECK_CBOR_ERROR(err, result, exit);
+    *part_len = cbor_encoder_get_buffer_size(&cbor, encoder->part);
+
+exit:
+    return result;
+}
+
+int urc_ur_encoder_next_part(urc_ur_encoder *encoder, const char **part, size_t *part_len)
+{
+    if (!encoder || !encoder->text || !part || !part_len) {
+        return URC_EINVALIDARG;
+    }
+    if (encoder->seq_num == UINT32_MAX) {
+        return URC_EUNHANDLEDCASE;
+    }
+    encoder->seq_num++;
+    if (encoder->seq_len == 1) {
+        *part = encoder->text;
+        *part_len = encoder->text_capacity - 1;
+        return URC_OK;
+    }
+
+    uint32_t degree;
+    int result = fountain_choose_fragments(&encoder->sampler, encoder->seq_num, encoder->checksum, encoder->chosen, &degree);
+    if (result != URC_OK) {
+        return result;
+    }
+    const size_t fragment_len = encoder->fragment_len;
+    memcpy(encoder->mixed, &encoder->fragments[(size_t)encoder->chosen[0] * fragment_len], fragment_len);
+    for (uint32_t idx = 1; idx < degree; idx++) {
+        fountain_xor(encoder->mixed, &encoder->fragments[(size_t)encoder->chosen[idx] * fragment_len], fragment_len);
+    }
+    size_t cbor_len;
+    result = encode_part(encoder, &cbor_len);
+    if (result != URC_OK) {
+        return result;
+    }
+
+    char *text = encoder->text;
+    size_t len = write_prefix(encoder, text);
+    len += write_decimal(encoder->seq_num, &text[len]);
+    text[len++] = '-';
+    len += write_decimal(encoder->seq_len, &text[len]);
+    text[len++] = '/';
+    len += bytewords_encode_minimal(encoder->part, cbor_len, &text[len]);
+    text[len] = '\0';
+    *part = text;
+    *part_len = len;
+    return URC_OK;
+}
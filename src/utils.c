@@ -3,10 +3,39 @@
 #include <stdint.h>
 #include <stdio.h>
 
+#include "trace.h"
 #include "utils.h"
 
-const int cbor_flags = CborValidateBasic | CborValidateMapKeysAreUnique | CborValidateMapIsSorted | CborValidateUtf8 |
-                       CborValidateNoUndefined | CborValidateCompleteData;
+static const int strict_validation_flags = CborValidateBasic | CborValidateMapKeysAreUnique | CborValidateMapIsSorted |
+                                           CborValidateUtf8 | CborValidateNoUndefined | CborValidateCompleteData;
+
+static _Thread_local urc_validation_profile thread_validation_profile = urc_validation_profile_trusted;
+
+urc_validation_profile urc_set_thread_validation_profile(urc_validation_profile profile)
+{
+    urc_validation_profile previous = thread_validation_profile;
+    thread_validation_profile = profile;
+    return previous;
+}
+
+urc_validation_profile urc_get_thread_validation_profile(void) { return thread_validation_profile; }
+
+int init_cbor_parser(const uint8_t *buffer, size_t len, urc_validation_profile profile, CborParser *parser, CborValue *iter)
+{
+    CborError err = cbor_parser_init(buffer, len, 0, parser, iter);
+    if (err != CborNoError) {
+        return URC_ECBORINTERNALERROR;
+    }
+    if (profile == urc_validation_profile_strict) {
+        trace_span span = trace_begin(TRACE_TYPE_CURRENT, urc_trace_phase_validate);
+        err = cbor_value_validate(iter, strict_validation_flags);
+        trace_end(&span);
+        if (err != CborNoError) {
+            return URC_ECBORINTERNALERROR;
+        }
+    }
+    return URC_OK;
+}
 
 int check_map_key(CborValue *cursor, int expected)
 {
@@ -85,9 +114,99 @@ int copy_fixed_size_byte_string(CborValue *cursor, uint8_t *buffer, size_t len)
     if (cborlen != len) {
         return URC_EUNEXPECTEDSTRINGLENGTH;
     }
+    trace_span span = trace_begin(TRACE_TYPE_CURRENT, urc_trace_phase_key_copy);
     err = cbor_value_copy_byte_string(cursor, buffer, &len, NULL);
+    trace_end(&span);
     if (err != CborNoError) {
         return URC_ECBORINTERNALERROR;
     }
     return URC_OK;
 }
+
+int borrow_byte_string(const CborValue *cursor, const uint8_t **data, size_t *len)
+{
+    if (!cbor_value_is_byte_string(cursor)) {
+        return URC_EUNEXPECTEDTYPE;
+    }
+    if (!cbor_value_is_length_known(cursor)) {
+        return URC_EUNHANDLEDCASE;
+    }
+    // a definite length string is made of a single chunk
+    CborValue chunk = *cursor;
+    CborError err = cbor_value_begin_string_iteration(&chunk);
+    if (err == CborNoError) {
+        err = cbor_value_get_byte_string_chunk(&chunk, data, len, NULL);
+    }
+    if (err != CborNoError) {
+        return URC_ECBORINTERNALERROR;
+    }
+    if (!*data) {
+        *len = 0;
+    }
+    return URC_OK;
+}
+
+int borrow_text_string(const CborValue *cursor, const char **text, size_t *len)
+{
+    if (!cbor_value_is_text_string(cursor)) {
+        return URC_EUNEXPECTEDTYPE;
+    }
+    if (!cbor_value_is_length_known(cursor)) {
+        return URC_EUNHANDLEDCASE;
+    }
+    CborValue chunk = *cursor;
+    CborError err = cbor_value_begin_string_iteration(&chunk);
+    if (err == CborNoError) {
+        err = cbor_value_get_text_string_chunk(&chunk, text, len, NULL);
+    }
+    if (err != CborNoError) {
+        return URC_ECBORINTERNALERROR;
+    }
+    if (!*text) {
+        *len = 0;
+    }
+    return URC_OK;
+}
+
+int serialize_to_buffer(cbor_encode_fn encode, const void *in, uint8_t *out, size_t out_len, size_t *cbor_len)
+{
+    CborEncoder encoder;
+    cbor_encoder_init(&encoder, out, out_len, 0);
+    int result = encode(&encoder, in);
+    if (result != URC_OK) {
+        return result;
+    }
+    // once out of space the encoder only counts the bytes past the end of the buffer
+    const size_t missing = cbor_encoder_get_extra_bytes_needed(&encoder);
+    if (missing) {
+        *cbor_len = out_len + missing;
+        return URC_EBUFFERTOOSMALL;
+    }
+    *cbor_len = cbor_encoder_get_buffer_size(&encoder, out);
+    return URC_OK;
+}
+
+int serialize_alloc(cbor_encode_fn encode, const void *in, uint8_t **cbor_out, size_t *cbor_len)
+{
+    *cbor_out = NULL;
+    *cbor_len = 0;
+    size_t len;
+    int result = serialize_to_buffer(encode, in, NULL, 0, &len);
+    if (result != URC_EBUFFERTOOSMALL) {
+        // nothing encodes to 0 bytes
+        return result == URC_OK ? URC_EINTERNALERROR : result;
+    }
+    *cbor_out = urc_malloc(len);
+    if (!*cbor_out) {
+        return URC_ENOMEM;
+    }
+    result = serialize_to_buffer(encode, in, *cbor_out, len, cbor_len);
+    if (result != URC_OK) {
+        urc_free(*cbor_out);
+        *cbor_out = NULL;
+        *cbor_len = 0;
+        // the second run must fit what the first one measured
+        return result == URC_EBUFFERTOOSMALL ? URC_EINTERNALERROR : result;
+    }
+    return URC_OK;
+}
@@ -2,12 +2,29 @@
 
 #include "cbor.h"
 
+#include "urc/core.h"
 #include "urc/error.h"
 
-extern const int cbor_flags;
+// cbor_parser_init, followed by a full validation of the payload under the strict validation profile
+// public deserializers pass the calling thread's profile, their ``_with_profile`` variants the one they are given
+int init_cbor_parser(const uint8_t *buffer, size_t len, urc_validation_profile profile, CborParser *parser, CborValue *iter);
+
+// allocates through the allocator installed on the calling thread, release with urc_free
+void *urc_malloc(size_t size);
 
 int check_map_key(CborValue *cursor, int expected);
 bool is_map_key(CborValue *cursor, int expected);
 int check_tag(CborValue *cursor, unsigned long expected_tag);
 bool is_tag(CborValue *cursor, unsigned long expected_tag);
 int copy_fixed_size_byte_string(CborValue *cursor, uint8_t *buffer, size_t len);
+// point ``data`` to the content of the string ``cursor`` is on, without copying it
+// only definite length strings are contiguous in the input buffer, chunked ones return URC_EUNHANDLEDCASE
+int borrow_byte_string(const CborValue *cursor, const uint8_t **data, size_t *len);
+int borrow_text_string(const CborValue *cursor, const char **text, size_t *len);
+
+// writes ``in`` to ``encoder``, whose buffer may be too small: see CHECK_CBOR_ENCODE_ERROR
+typedef int (*cbor_encode_fn)(CborEncoder *encoder, const void *in);
+// ``cbor_len`` is set to the encoded size, also when URC_EBUFFERTOOSMALL is returned: a NULL ``out`` of 0 bytes measures
+int serialize_to_buffer(cbor_encode_fn encode, const void *in, uint8_t *out, size_t out_len, size_t *cbor_len);
+// measures first, then encodes into a buffer of exactly that size, to be released with urc_free
+int serialize_alloc(cbor_encode_fn encode, const void *in, uint8_t **cbor_out, size_t *cbor_len);
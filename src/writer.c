@@ -0,0 +1,52 @@
+#include <string.h>
+
+#include "writer.h"
+
+void writer_init(urc_writer *writer, char *buffer, size_t capacity)
+{
+    writer->buffer = buffer;
+    writer->capacity = buffer ? capacity : 0;
+    writer->len = 0;
+    writer->checksum = NULL;
+    if (writer->capacity) {
+        writer->buffer[0] = '\0';
+    }
+}
+
+void writer_append(urc_writer *writer, const char *data, size_t len)
+{
+    if (writer->len + 1 < writer->capacity) {
+        size_t room = writer->capacity - writer->len - 1;
+        size_t copied = len < room ? len : room;
+        memcpy(&writer->buffer[writer->len], data, copied);
+        writer->buffer[writer->len + copied] = '\0';
+    }
+    writer->len += len;
+    if (writer->checksum) {
+        descriptor_checksum_update(writer->checksum, data, len);
+    }
+}
+
+void writer_appendz(urc_writer *writer, const char *str) { writer_append(writer, str, strlen(str)); }
+
+void writer_append_uint(urc_writer *writer, uint32_t value)
+{
+    char digits[10];
+    size_t idx = sizeof(digits);
+    do {
+        digits[--idx] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value);
+    writer_append(writer, &digits[idx], sizeof(digits) - idx);
+}
+
+void writer_append_hex(urc_writer *writer, const uint8_t *bytes, size_t len)
+{
+    static const char hexdigits[] = "0123456789abcdef";
+    for (size_t idx = 0; idx < len; idx++) {
+        const char hex[2] = {hexdigits[bytes[idx] >> 4], hexdigits[bytes[idx] & 0x0f]};
+        writer_append(writer, hex, sizeof(hex));
+    }
+}
+
+bool writer_fits(const urc_writer *writer) { return writer->len < writer->capacity; }
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "descriptor_checksum.h"
+
+// string builder over a fixed size buffer
+// once the buffer is full the writer stops copying but keeps counting: ``len`` is always the length of the whole
+// output, so running a formatter over a zero sized writer measures it exactly
+// the buffer, when not empty, is always NUL terminated
+// when ``checksum`` is set every appended character is fed to it
+typedef struct {
+    char *buffer;
+    size_t capacity;
+    size_t len;
+    descriptor_checksum *checksum;
+} urc_writer;
+
+void writer_init(urc_writer *writer, char *buffer, size_t capacity);
+void writer_append(urc_writer *writer, const char *data, size_t len);
+void writer_appendz(urc_writer *writer, const char *str);
+void writer_append_uint(urc_writer *writer, uint32_t value);
+void writer_append_hex(urc_writer *writer, const uint8_t *bytes, size_t len);
+// output and NUL terminator fit in the buffer
+bool writer_fits(const urc_writer *writer);
@@ -17,6 +17,15 @@ TEST_GROUP(account);
 TEST_SETUP(account) {}
 TEST_TEAR_DOWN(account) {}
 
+// runs the tasks on the calling thread, last to first, any order must give the same result
+static void reverse_executor_run(void *ctx, size_t count, urc_task_fn fn, void *fn_ctx)
+{
+    (*(size_t *)ctx)++;
+    for (size_t idx = count; idx > 0; idx--) {
+        fn(fn_ctx, idx - 1);
+    }
+}
+
 TEST(account, test_vector_1)
 {
     // https://github.com/BlockchainCommons/Research/blob/master/papers/bcr-2020-015-account.md#exampletest-vector
@@ -68,7 +77,21 @@ TEST(account, test_vector_1)
     TEST_ASSERT_EQUAL(URC_OK, err);
     TEST_ASSERT_EQUAL_STRING_ARRAY(expected_desc, descs, expected_desc_size);
     TEST_ASSERT_NULL(descs[expected_desc_size]);
+    urc_string_array_free(descs);
+
+    err = urc_crypto_account_format_parallel(&account, urc_crypto_output_format_mode_default, 4, &descs);
+    TEST_ASSERT_EQUAL(URC_OK, err);
+    TEST_ASSERT_EQUAL_STRING_ARRAY(expected_desc, descs, expected_desc_size);
+    TEST_ASSERT_NULL(descs[expected_desc_size]);
+    urc_string_array_free(descs);
 
+    size_t runs = 0;
+    const urc_executor executor = {.run = reverse_executor_run, .ctx = &runs};
+    err = urc_crypto_account_format_with_executor(&account, urc_crypto_output_format_mode_default, &executor, &descs);
+    TEST_ASSERT_EQUAL(URC_OK, err);
+    TEST_ASSERT_EQUAL(1, runs);
+    TEST_ASSERT_EQUAL_STRING_ARRAY(expected_desc, descs, expected_desc_size);
+    TEST_ASSERT_NULL(descs[expected_desc_size]);
     urc_string_array_free(descs);
 }
 
@@ -102,6 +125,15 @@ TEST(account, jade)
     TEST_ASSERT_EQUAL_STRING_ARRAY(expected_desc, descs, expected_desc_size);
 
     urc_string_array_free(descs);
+
+    char descriptor[BUFLEN];
+    size_t descriptor_len;
+    err = urc_crypto_account_format_to_buffer(&account, 0, urc_crypto_output_format_mode_BIP44_compatible_checksum,
+                                              descriptor, BUFLEN, &descriptor_len);
+    TEST_ASSERT_EQUAL(URC_OK, err);
+    TEST_ASSERT_EQUAL(strlen(expected_desc[0]) + 1 + URC_DESCRIPTOR_CHECKSUM_LEN, descriptor_len);
+    TEST_ASSERT_EQUAL_MEMORY(expected_desc[0], descriptor, strlen(expected_desc[0]));
+    TEST_ASSERT_EQUAL(URC_OK, urc_descriptor_checksum_verify(descriptor, descriptor_len));
 }
 
 TEST(account, jadetest)
@@ -136,3 +168,131 @@ TEST(account, jadetest)
 
     urc_string_array_free(descs);
 }
+
+TEST(account, unbounded)
+{
+    // jade account with the same descriptor repeated 12 times, more than DESCRIPTORS_MAX_SIZE
+    const char *header_hex = "a2011ae3ebcc79028c";
+    const char *descriptor_hex =
+        "d90194d9012fa40358210354de5de4043b72d3e7529d57fc4e798bbf371478ada068eb20c84d3e45e14dea0458200977e5bab6742423edc8a588"
+        "c061ce96a1bdf6dc15016db3f3b7bb62c180c6f706d90130a301861854f500f501f5021ae3ebcc790303081a810d05a0";
+    const size_t expected_desc_size = 12;
+    const char *expected_desc =
+        "wpkh([e3ebcc79/84'/0'/"
+        "1']xpub6CbnTfaeNsCD1nUCyoVq9k4L7TdZ88ai4b9CMRh4R1sbPYGRTUubBmBrA1iejEGfxprJ4LHufCk9kjfHKpZob4vMhqUjpkv1cVjzQVyV2sf/0/"
+        "*)";
+
+    uint8_t raw[BUFLEN * 2];
+    size_t len = h2b(header_hex, sizeof(raw), raw);
+    TEST_ASSERT_GREATER_THAN_INT(0, len);
+    for (size_t idx = 0; idx < expected_desc_size; idx++) {
+        size_t descriptor_len = h2b(descriptor_hex, sizeof(raw) - len, &raw[len]);
+        TEST_ASSERT_GREATER_THAN_INT(0, descriptor_len);
+        len += descriptor_len;
+    }
+
+    crypto_account_unbounded account;
+    int err = urc_jade_account_unbounded_deserialize(raw, len, &account);
+    TEST_ASSERT_EQUAL(URC_OK, err);
+    TEST_ASSERT_EQUAL(3823881337, account.master_fingerprint);
+    TEST_ASSERT_EQUAL(expected_desc_size, urc_crypto_account_unbounded_count(&account));
+    TEST_ASSERT_NOT_NULL(urc_crypto_account_unbounded_descriptor(&account, expected_desc_size - 1));
+    TEST_ASSERT_NULL(urc_crypto_account_unbounded_descriptor(&account, expected_desc_size));
+
+    char **descs;
+    err = urc_crypto_account_unbounded_format(&account, urc_crypto_output_format_mode_BIP44_compatible, &descs);
+    TEST_ASSERT_EQUAL(URC_OK, err);
+    for (size_t idx = 0; idx < expected_desc_size; idx++) {
+        TEST_ASSERT_EQUAL_STRING(expected_desc, descs[idx]);
+    }
+    TEST_ASSERT_NULL(descs[expected_desc_size]);
+    urc_string_array_free(descs);
+
+    err = urc_crypto_account_unbounded_format_parallel(&account, urc_crypto_output_format_mode_BIP44_compatible, 0, &descs);
+    TEST_ASSERT_EQUAL(URC_OK, err);
+    for (size_t idx = 0; idx < expected_desc_size; idx++) {
+        TEST_ASSERT_EQUAL_STRING(expected_desc, descs[idx]);
+    }
+    TEST_ASSERT_NULL(descs[expected_desc_size]);
+    urc_string_array_free(descs);
+
+    urc_crypto_account_unbounded_free(&account);
+    TEST_ASSERT_NULL(account.descriptors);
+    TEST_ASSERT_EQUAL(0, urc_crypto_account_unbounded_count(&account));
+
+    crypto_account_compact compact;
+    err = urc_jade_account_deserialize_compact(raw, len, &compact);
+    TEST_ASSERT_EQUAL(URC_OK, err);
+    TEST_ASSERT_EQUAL(3823881337, compact.master_fingerprint);
+    TEST_ASSERT_EQUAL(expected_desc_size, urc_crypto_account_compact_count(&compact));
+    for (size_t idx = 0; idx < expected_desc_size; idx++) {
+        crypto_output output;
+        TEST_ASSERT_EQUAL(URC_OK, urc_crypto_account_compact_descriptor(&compact, idx, &output));
+        char descriptor[BUFLEN];
+        size_t descriptor_len;
+        err = urc_crypto_output_format_to_buffer(&output, urc_crypto_output_format_mode_BIP44_compatible, descriptor,
+                                                 BUFLEN, &descriptor_len);
+        TEST_ASSERT_EQUAL(URC_OK, err);
+        TEST_ASSERT_EQUAL_STRING(expected_desc, descriptor);
+    }
+    crypto_output output;
+    TEST_ASSERT_EQUAL(URC_EINVALIDARG, urc_crypto_account_compact_descriptor(&compact, expected_desc_size, &output));
+    urc_crypto_account_compact_free(&compact);
+    TEST_ASSERT_NULL(compact.descriptors);
+
+    // the bounded account can not hold them all
+    crypto_account bounded;
+    err = urc_jade_account_deserialize(raw, len, &bounded);
+    TEST_ASSERT_NOT_EQUAL(URC_OK, err);
+
+    // an array header claiming more descriptors than the input can hold is rejected before anything is allocated
+    len = h2b("a2011ae3ebcc790284", sizeof(raw), raw);
+    len += h2b(descriptor_hex, sizeof(raw) - len, &raw[len]);
+    err = urc_jade_account_unbounded_deserialize(raw, len, &account);
+    TEST_ASSERT_EQUAL(URC_EUNKNOWNFORMAT, err);
+    TEST_ASSERT_NULL(account.descriptors);
+}
+
+TEST(account, serialize)
+{
+    // jade account of 3 descriptors, crypto-account introduces them by tag 308
+    const char *header_hex = "a2011ae3ebcc790283";
+    const char *tag_hex = "d90134";
+    const char *descriptor_hex =
+        "d90194d9012fa40358210354de5de4043b72d3e7529d57fc4e798bbf371478ada068eb20c84d3e45e14dea0458200977e5bab6742423edc8a588"
+        "c061ce96a1bdf6dc15016db3f3b7bb62c180c6f706d90130a301861854f500f501f5021ae3ebcc790303081a810d05a0";
+    const size_t descriptors_count = 3;
+
+    uint8_t jade[BUFLEN];
+    uint8_t expected[BUFLEN];
+    size_t jade_len = h2b(header_hex, sizeof(jade), jade);
+    size_t expected_len = h2b(header_hex, sizeof(expected), expected);
+    for (size_t idx = 0; idx < descriptors_count; idx++) {
+        jade_len += h2b(descriptor_hex, sizeof(jade) - jade_len, &jade[jade_len]);
+        expected_len += h2b(tag_hex, sizeof(expected) - expected_len, &expected[expected_len]);
+        expected_len += h2b(descriptor_hex, sizeof(expected) - expected_len, &expected[expected_len]);
+    }
+
+    crypto_account account;
+    TEST_ASSERT_EQUAL(URC_OK, urc_jade_account_deserialize(jade, jade_len, &account));
+    uint8_t *cbor;
+    size_t cbor_len;
+    TEST_ASSERT_EQUAL(URC_OK, urc_crypto_account_serialize(&account, &cbor, &cbor_len));
+    TEST_ASSERT_EQUAL(expected_len, cbor_len);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, cbor, expected_len);
+    urc_free(cbor);
+
+    crypto_account_unbounded unbounded;
+    TEST_ASSERT_EQUAL(URC_OK, urc_jade_account_unbounded_deserialize(jade, jade_len, &unbounded));
+    uint8_t out[BUFLEN];
+    TEST_ASSERT_EQUAL(URC_EBUFFERTOOSMALL, urc_crypto_account_unbounded_serialize_to_buffer(&unbounded, out, 10, &cbor_len));
+    TEST_ASSERT_EQUAL(expected_len, cbor_len);
+    TEST_ASSERT_EQUAL(URC_OK, urc_crypto_account_unbounded_serialize_to_buffer(&unbounded, out, sizeof(out), &cbor_len));
+    TEST_ASSERT_EQUAL(expected_len, cbor_len);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, out, expected_len);
+    urc_crypto_account_unbounded_free(&unbounded);
+
+    // and back
+    TEST_ASSERT_EQUAL(URC_OK, urc_crypto_account_deserialize(out, cbor_len, &account));
+    TEST_ASSERT_EQUAL(descriptors_count, account.descriptors_count);
+}
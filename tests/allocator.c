@@ -0,0 +1,178 @@
+#include <string.h>
+
+#include "unity.h"
+#include "unity_fixture.h"
+
+#include "urc/urc.h"
+
+#include "helpers.h"
+
+#define BUFLEN 1024
+#define ARENA_SIZE 4096
+
+TEST_GROUP(allocator);
+
+TEST_SETUP(allocator) {}
+TEST_TEAR_DOWN(allocator) { urc_set_thread_allocator(NULL); }
+
+TEST(allocator, arena)
+{
+    static uint8_t buffer[ARENA_SIZE];
+    urc_arena arena;
+    urc_arena_init(&arena, buffer, ARENA_SIZE);
+    urc_allocator allocator = urc_arena_allocator(&arena);
+
+    void *first = allocator.malloc(allocator.ctx, 10);
+    TEST_ASSERT_NOT_NULL(first);
+    void *second = allocator.malloc(allocator.ctx, 10);
+    TEST_ASSERT_NOT_NULL(second);
+    TEST_ASSERT_EQUAL(0, (uintptr_t)second % sizeof(void *));
+    size_t used = arena.used;
+
+    // only the most recent allocation gives its space back
+    allocator.free(allocator.ctx, first);
+    TEST_ASSERT_EQUAL(used, arena.used);
+    allocator.free(allocator.ctx, second);
+    TEST_ASSERT_LESS_THAN(used, arena.used);
+    TEST_ASSERT_EQUAL_PTR(second, allocator.malloc(allocator.ctx, 10));
+
+    TEST_ASSERT_NULL(allocator.malloc(allocator.ctx, ARENA_SIZE));
+
+    urc_arena_reset(&arena);
+    TEST_ASSERT_EQUAL(0, arena.used);
+    TEST_ASSERT_EQUAL_PTR(first, allocator.malloc(allocator.ctx, 10));
+}
+
+TEST(allocator, account_format)
+{
+    const char *hex =
+        "a2011ae3ebcc790281d90194d9012fa40358210354de5de4043b72d3e7529d57fc4e798bbf371478ada068eb20c84d3e45e14dea0458200977e5bab6"
+        "742423edc8a588c061ce96a1bdf6dc15016db3f3b7bb62c180c6f706d90130a301861854f500f501f5021ae3ebcc790303081a810d05a0";
+    const char *expected =
+        "wpkh([e3ebcc79/84'/0'/"
+        "1']xpub6CbnTfaeNsCD1nUCyoVq9k4L7TdZ88ai4b9CMRh4R1sbPYGRTUubBmBrA1iejEGfxprJ4LHufCk9kjfHKpZob4vMhqUjpkv1cVjzQVyV2sf/0/"
+        "*)";
+
+    uint8_t raw[BUFLEN];
+    size_t len = h2b(hex, BUFLEN, (uint8_t *)(&raw));
+    TEST_ASSERT_GREATER_THAN_INT(0, len);
+
+    crypto_account account;
+    int err = urc_jade_account_deserialize(raw, len, &account);
+    TEST_ASSERT_EQUAL(URC_OK, err);
+
+    static uint8_t buffer[ARENA_SIZE];
+    urc_arena arena;
+    urc_arena_init(&arena, buffer, ARENA_SIZE);
+    urc_allocator allocator = urc_arena_allocator(&arena);
+    const urc_allocator *previous = urc_set_thread_allocator(&allocator);
+
+    char **descs;
+    err = urc_crypto_account_format(&account, urc_crypto_output_format_mode_BIP44_compatible, &descs);
+    TEST_ASSERT_EQUAL(URC_OK, err);
+    TEST_ASSERT_EQUAL_STRING(expected, descs[0]);
+    TEST_ASSERT_NULL(descs[1]);
+    // everything comes from the arena
+    TEST_ASSERT_TRUE((uint8_t *)descs >= buffer && (uint8_t *)descs < buffer + ARENA_SIZE);
+    TEST_ASSERT_TRUE((uint8_t *)descs[0] >= buffer && (uint8_t *)descs[0] < buffer + ARENA_SIZE);
+    TEST_ASSERT_GREATER_THAN(0, arena.used);
+
+    // released all at once
+    urc_arena_reset(&arena);
+
+    // into a caller buffer, without a single allocation
+    char desc[BUFLEN];
+    size_t desc_len;
+    err = urc_crypto_account_format_to_buffer(&account, 0, urc_crypto_output_format_mode_BIP44_compatible, desc, BUFLEN,
+                                              &desc_len);
+    TEST_ASSERT_EQUAL(URC_OK, err);
+    TEST_ASSERT_EQUAL(strlen(expected), desc_len);
+    TEST_ASSERT_EQUAL_STRING(expected, desc);
+    TEST_ASSERT_EQUAL(0, arena.used);
+    err = urc_crypto_account_format_to_buffer(&account, 1, urc_crypto_output_format_mode_BIP44_compatible, desc, BUFLEN,
+                                              &desc_len);
+    TEST_ASSERT_EQUAL(URC_EINVALIDARG, err);
+    TEST_ASSERT_EQUAL_PTR(&allocator, urc_set_thread_allocator(previous));
+}
+
+TEST(allocator, stats)
+{
+    // the json is longer than the cbor, which is the first buffer size tried
+    const char *hex =
+        "a36269646130666d6574686f646370696e66706172616d73a164646174617880377948355850466434675050425472596d5a75756659513961436770"
+        "716355656c432b796437495845354d456239695171616b78744e7a7a6265382f51385669566f4e657053714c3355494565416a655734483052334d70"
+        "32594d4c416b3942664b3961326a64495a4f2f774b464f3576704d6b464949724552452f5751382b";
+    uint8_t raw[BUFLEN];
+    size_t len = h2b(hex, BUFLEN, (uint8_t *)&raw);
+    TEST_ASSERT_GREATER_THAN_INT(0, len);
+
+    urc_stats stats;
+    urc_stats_reset();
+    char *out;
+    TEST_ASSERT_EQUAL(URC_OK, urc_jade_rpc_deserialize(raw, len, &out));
+    urc_stats_get(&stats);
+    if (!urc_stats_enabled()) {
+        TEST_ASSERT_EQUAL(0, stats.allocs);
+        TEST_ASSERT_EQUAL(0, stats.peak_live_bytes);
+        urc_string_free(out);
+        return;
+    }
+    TEST_ASSERT_GREATER_THAN(0, stats.retries);
+    TEST_ASSERT_EQUAL(stats.retries + 1, stats.allocs);
+    TEST_ASSERT_EQUAL(stats.retries, stats.frees);
+    // each buffer is freed before the next one, twice as large, is allocated: only the last one is live
+    TEST_ASSERT_GREATER_THAN(strlen(out), stats.live_bytes);
+    TEST_ASSERT_EQUAL(stats.live_bytes, stats.peak_live_bytes);
+    TEST_ASSERT_EQUAL(2 * stats.live_bytes - len, stats.bytes_allocated);
+
+    urc_string_free(out);
+    urc_stats_get(&stats);
+    TEST_ASSERT_EQUAL(stats.allocs, stats.frees);
+    TEST_ASSERT_EQUAL(0, stats.live_bytes);
+
+    // memory from before the reset
+    TEST_ASSERT_EQUAL(URC_OK, urc_jade_rpc_deserialize(raw, len, &out));
+    urc_stats_reset();
+    urc_string_free(out);
+    urc_stats_get(&stats);
+    TEST_ASSERT_EQUAL(0, stats.allocs);
+    TEST_ASSERT_EQUAL(1, stats.frees);
+    TEST_ASSERT_EQUAL(0, stats.live_bytes);
+    TEST_ASSERT_EQUAL(0, stats.peak_live_bytes);
+}
+
+TEST(allocator, trace)
+{
+    const char *hex = "a16a7061636b6167652e6964a1646e616d65646a616465";
+    uint8_t raw[BUFLEN];
+    size_t len = h2b(hex, BUFLEN, (uint8_t *)&raw);
+    TEST_ASSERT_GREATER_THAN_INT(0, len);
+
+    static urc_trace_snapshot before;
+    static urc_trace_snapshot after;
+    TEST_ASSERT_EQUAL(URC_OK, urc_stats_snapshot(&before));
+    urc_validation_profile previous = urc_set_thread_validation_profile(urc_validation_profile_strict);
+    char *out;
+    TEST_ASSERT_EQUAL(URC_OK, urc_jade_rpc_deserialize(raw, len, &out));
+    urc_set_thread_validation_profile(previous);
+    urc_string_free(out);
+    TEST_ASSERT_EQUAL(URC_OK, urc_stats_snapshot(&after));
+
+    const urc_trace_histogram *decode = &after.histograms[urc_trace_type_jade_rpc][urc_trace_phase_decode];
+    const urc_trace_histogram *validate = &after.histograms[urc_trace_type_jade_rpc][urc_trace_phase_validate];
+    if (!urc_tracing_enabled()) {
+        TEST_ASSERT_EQUAL(0, decode->count);
+        TEST_ASSERT_EQUAL(0, validate->count);
+        return;
+    }
+    TEST_ASSERT_EQUAL(before.histograms[urc_trace_type_jade_rpc][urc_trace_phase_decode].count + 1, decode->count);
+    TEST_ASSERT_EQUAL(before.histograms[urc_trace_type_jade_rpc][urc_trace_phase_validate].count + 1, validate->count);
+    // validation is part of the decode span
+    TEST_ASSERT_LESS_OR_EQUAL(decode->max_ns, validate->max_ns);
+    uint64_t bucketed = 0;
+    for (size_t idx = 0; idx < URC_TRACE_BUCKETS; idx++) {
+        bucketed += decode->buckets[idx];
+    }
+    TEST_ASSERT_EQUAL(decode->count, bucketed);
+    TEST_ASSERT_EQUAL(URC_EINVALIDARG, urc_stats_snapshot(NULL));
+}
@@ -0,0 +1,90 @@
+#include <string.h>
+
+#include "unity.h"
+#include "unity_fixture.h"
+
+#include "urc/urc.h"
+
+#include "helpers.h"
+
+#define BUFLEN 1024
+#define BATCH_SIZE 97
+
+TEST_GROUP(batch);
+
+TEST_SETUP(batch) {}
+TEST_TEAR_DOWN(batch) {}
+
+TEST(batch, deserialize)
+{
+    // https://github.com/BlockchainCommons/Research/blob/master/papers/urc-2020-007-hdkey.md#exampletest-vector-2
+    const char *hdkey_hex =
+        "a5035821026fe2355745bb2db3630bbc80ef5d58951c963c841f54170ba6e5c12be7fc12a6045820ced155c72456255881793514ed"
+        "c5bd9447e7f74abb88c6d6b6480fd016ee8c8505d90131a1020106d90130a1018a182cf501f501f500f401f4081ae9181cf3";
+    const char *psbt_hex = "4770736274ff0100";
+
+    uint8_t raw_hdkey[BUFLEN];
+    size_t hdkey_len = h2b(hdkey_hex, BUFLEN, raw_hdkey);
+    TEST_ASSERT_GREATER_THAN_INT(0, hdkey_len);
+    uint8_t raw_psbt[BUFLEN];
+    size_t psbt_len = h2b(psbt_hex, BUFLEN, raw_psbt);
+    TEST_ASSERT_GREATER_THAN_INT(0, psbt_len);
+
+    crypto_hdkey expected_hdkey;
+    TEST_ASSERT_EQUAL(URC_OK, urc_crypto_hdkey_deserialize(raw_hdkey, hdkey_len, &expected_hdkey));
+
+    static urc_batch_item items[BATCH_SIZE];
+    static crypto_hdkey hdkeys[BATCH_SIZE];
+    static crypto_psbt psbts[BATCH_SIZE];
+    for (size_t idx = 0; idx < BATCH_SIZE; idx++) {
+        items[idx].result = -1;
+        switch (idx % 3) {
+        case 0:
+            items[idx].type = urc_batch_type_crypto_hdkey;
+            items[idx].cbor_buffer = raw_hdkey;
+            items[idx].cbor_len = hdkey_len;
+            items[idx].out = &hdkeys[idx];
+            break;
+        case 1:
+            items[idx].type = urc_batch_type_crypto_psbt;
+            items[idx].cbor_buffer = raw_psbt;
+            items[idx].cbor_len = psbt_len;
+            items[idx].out = &psbts[idx];
+            break;
+        default:
+            // truncated
+            items[idx].type = urc_batch_type_crypto_hdkey;
+            items[idx].cbor_buffer = raw_hdkey;
+            items[idx].cbor_len = hdkey_len / 2;
+            items[idx].out = &hdkeys[idx];
+            break;
+        }
+    }
+
+    TEST_ASSERT_EQUAL(URC_OK, urc_batch_deserialize(items, BATCH_SIZE, 4));
+    for (size_t idx = 0; idx < BATCH_SIZE; idx++) {
+        switch (idx % 3) {
+        case 0:
+            TEST_ASSERT_EQUAL(URC_OK, items[idx].result);
+            TEST_ASSERT_EQUAL_MEMORY(&expected_hdkey.key.derived.keydata, &hdkeys[idx].key.derived.keydata,
+                                     sizeof(expected_hdkey.key.derived.keydata));
+            break;
+        case 1:
+            TEST_ASSERT_EQUAL(URC_OK, items[idx].result);
+            TEST_ASSERT_EQUAL(psbt_len - 1, psbts[idx].psbt_len);
+            TEST_ASSERT_EQUAL_UINT8_ARRAY(&raw_psbt[1], psbts[idx].psbt, psbts[idx].psbt_len);
+            // allocated by a worker, freed by the caller
+            urc_crypto_psbt_free(&psbts[idx]);
+            break;
+        default:
+            TEST_ASSERT_NOT_EQUAL(URC_OK, items[idx].result);
+            TEST_ASSERT_NOT_EQUAL(-1, items[idx].result);
+            break;
+        }
+    }
+
+    // more threads than items, and no items at all
+    TEST_ASSERT_EQUAL(URC_OK, urc_batch_deserialize(items, 1, 8));
+    TEST_ASSERT_EQUAL(URC_OK, items[0].result);
+    TEST_ASSERT_EQUAL(URC_OK, urc_batch_deserialize(NULL, 0, 0));
+}
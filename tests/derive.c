@@ -0,0 +1,147 @@
+#include <string.h>
+
+#include "unity.h"
+#include "unity_fixture.h"
+
+#include "urc/urc.h"
+
+#include "helpers.h"
+
+#define BUFLEN 1024
+#define RANGE_SIZE 600
+
+TEST_GROUP(derive);
+
+TEST_SETUP(derive) {}
+TEST_TEAR_DOWN(derive) {}
+
+static void assert_script(const char *expected_hex, const urc_scriptpubkey *script)
+{
+    uint8_t expected[URC_SCRIPTPUBKEY_MAX_LEN];
+    size_t expected_len = h2b(expected_hex, sizeof(expected), expected);
+    TEST_ASSERT_EQUAL(expected_len, script->script_len);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, script->script, expected_len);
+}
+
+TEST(derive, pkh_wildcard)
+{
+    // pkh([d34db33f/44'/0'/0']xpub6ERApfZwUNrhLCkDtcHTcxd75RbzS1ed54G1LkBUHQVHQKqhMkhgbmJbZRkrgZw4koxb5JaHWkY4ALHY2grBGRjaDMzQLcgJvLJuZZvRcEL/1/*)
+    const char *hex =
+        "d90193d9012fa503582102d2b36900396c9282fa14628566582f206a5dd0bcc8d5e892611806cafb0301f0045820637807030d55d01f9a0cb3a78395"
+        "15d796bd07706386a6eddf06cc29a65a0e2906d90130a30186182cf500f500f5021ad34db33f030407d90130a1018401f480f4081a78412e3a";
+    const char *expected[] = {
+        "76a9142a05c214617c9b0434c92d0583200a85ef61818f88ac",
+        "76a91449b2f81eea1ecb5bc97d78f2d8f89d9c861c3cf288ac",
+        "76a914b6375a30c7833b2f28e0d55c180d12b43d4dfaa488ac",
+    };
+
+    uint8_t raw[BUFLEN];
+    size_t len = h2b(hex, BUFLEN, raw);
+    crypto_output output;
+    TEST_ASSERT_EQUAL(URC_OK, urc_crypto_output_deserialize(raw, len, &output));
+
+    urc_script_deriver deriver;
+    TEST_ASSERT_EQUAL(URC_OK, urc_script_deriver_init(&deriver, &output));
+    TEST_ASSERT_EQUAL(urc_script_type_p2pkh, deriver.script_type);
+    TEST_ASSERT_EQUAL(1, deriver.chains_count);
+
+    urc_scriptpubkey scripts[3];
+    TEST_ASSERT_EQUAL(URC_OK, urc_script_deriver_derive(&deriver, 0, 0, 3, 1, scripts));
+    for (size_t idx = 0; idx < 3; idx++) {
+        assert_script(expected[idx], &scripts[idx]);
+    }
+    TEST_ASSERT_EQUAL(URC_OK, urc_script_deriver_derive(&deriver, 0, 2, 1, 1, scripts));
+    assert_script(expected[2], &scripts[0]);
+
+    TEST_ASSERT_EQUAL(URC_EINVALIDARG, urc_script_deriver_derive(&deriver, 1, 0, 1, 1, scripts));
+    TEST_ASSERT_EQUAL(URC_EINVALIDARG, urc_script_deriver_derive(&deriver, 0, 0x80000000, 1, 1, scripts));
+    TEST_ASSERT_EQUAL(URC_EINVALIDARG, urc_script_deriver_derive(&deriver, 0, 0x7fffffff, 2, 1, scripts));
+}
+
+TEST(derive, implicit_chains)
+{
+    // wpkh([e3ebcc79/84'/0'/1']xpub6CbnTfaeNsCD1nUCyoVq9k4L7TdZ88ai4b9CMRh4R1sbPYGRTUubBmBrA1iejEGfxprJ4LHufCk9kjfHKpZob4vMhqUjpkv1cVjzQVyV2sf)
+    // no children path, /<0;1>/* is assumed
+    const char *hex =
+        "a2011ae3ebcc790281d90194d9012fa40358210354de5de4043b72d3e7529d57fc4e798bbf371478ada068eb20c84d3e45e14dea0458200977e5bab6"
+        "742423edc8a588c061ce96a1bdf6dc15016db3f3b7bb62c180c6f706d90130a301861854f500f501f5021ae3ebcc790303081a810d05a0";
+
+    uint8_t raw[BUFLEN];
+    size_t len = h2b(hex, BUFLEN, raw);
+    crypto_account account;
+    TEST_ASSERT_EQUAL(URC_OK, urc_jade_account_deserialize(raw, len, &account));
+
+    urc_script_deriver deriver;
+    TEST_ASSERT_EQUAL(URC_OK, urc_script_deriver_init(&deriver, &account.descriptors[0]));
+    TEST_ASSERT_EQUAL(urc_script_type_p2wpkh, deriver.script_type);
+    TEST_ASSERT_EQUAL(2, deriver.chains_count);
+
+    // several blocks over several threads
+    static urc_scriptpubkey scripts[RANGE_SIZE];
+    TEST_ASSERT_EQUAL(URC_OK, urc_script_deriver_derive(&deriver, 0, 0, RANGE_SIZE, 4, scripts));
+    assert_script("00145b2a1b8cdd495292e71951150a7b16d151f4a648", &scripts[0]);
+    assert_script("00145384dcc1aa025e9ab2cc907027501ffa4e223193", &scripts[5]);
+    urc_scriptpubkey last;
+    TEST_ASSERT_EQUAL(URC_OK, urc_script_deriver_derive(&deriver, 0, RANGE_SIZE - 1, 1, 1, &last));
+    TEST_ASSERT_EQUAL(last.script_len, scripts[RANGE_SIZE - 1].script_len);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(last.script, scripts[RANGE_SIZE - 1].script, last.script_len);
+
+    TEST_ASSERT_EQUAL(URC_OK, urc_script_deriver_derive(&deriver, 1, 0, 1, 0, scripts));
+    assert_script("00141d429e006ee6eed374f70fc6e7bf8c9624a76e2a", &scripts[0]);
+}
+
+TEST(derive, unhandled)
+{
+    // pkh(02c6047f9441ed7d6d3045406e95c07cd85c778e4b8cef3ca7abac09b95c709ee5), not an hdkey
+    const char *hex = "d90193d90132a103582102c6047f9441ed7d6d3045406e95c07cd85c778e4b8cef3ca7abac09b95c709ee5";
+
+    uint8_t raw[BUFLEN];
+    size_t len = h2b(hex, BUFLEN, raw);
+    crypto_output output;
+    TEST_ASSERT_EQUAL(URC_OK, urc_crypto_output_deserialize(raw, len, &output));
+
+    urc_script_deriver deriver;
+    TEST_ASSERT_EQUAL(URC_EUNHANDLEDCASE, urc_script_deriver_init(&deriver, &output));
+}
+
+TEST(derive, script_index)
+{
+    // wpkh([e3ebcc79/84'/0'/1']xpub6CbnTfaeNsCD1nUCyoVq9k4L7TdZ88ai4b9CMRh4R1sbPYGRTUubBmBrA1iejEGfxprJ4LHufCk9kjfHKpZob4vMhqUjpkv1cVjzQVyV2sf)
+    const char *hex =
+        "a2011ae3ebcc790281d90194d9012fa40358210354de5de4043b72d3e7529d57fc4e798bbf371478ada068eb20c84d3e45e14dea0458200977e5bab6"
+        "742423edc8a588c061ce96a1bdf6dc15016db3f3b7bb62c180c6f706d90130a301861854f500f501f5021ae3ebcc790303081a810d05a0";
+    const uint32_t gap_limit = 20;
+
+    uint8_t raw[BUFLEN];
+    size_t len = h2b(hex, BUFLEN, raw);
+    crypto_account account;
+    TEST_ASSERT_EQUAL(URC_OK, urc_jade_account_deserialize(raw, len, &account));
+
+    urc_script_index index;
+    TEST_ASSERT_EQUAL(URC_OK, urc_script_index_init(&index, &account, gap_limit, 2));
+    TEST_ASSERT_EQUAL(2 * gap_limit, index.entries_count);
+
+    uint8_t script[URC_SCRIPTPUBKEY_MAX_LEN];
+    size_t script_len = h2b("00141d429e006ee6eed374f70fc6e7bf8c9624a76e2a", sizeof(script), script);
+    urc_script_index_hit hit;
+    TEST_ASSERT_TRUE(urc_script_index_lookup(&index, script, script_len, &hit));
+    TEST_ASSERT_EQUAL(0, hit.descriptor);
+    TEST_ASSERT_EQUAL(1, hit.chain);
+    TEST_ASSERT_EQUAL(0, hit.index);
+    script[script_len - 1] ^= 1;
+    TEST_ASSERT_FALSE(urc_script_index_lookup(&index, script, script_len, &hit));
+
+    // the external chain grows to keep gap_limit unused indexes after the last used one
+    urc_scriptpubkey beyond;
+    TEST_ASSERT_EQUAL(URC_OK, urc_script_deriver_derive(&index.sources[0].deriver, 0, gap_limit + 10, 1, 1, &beyond));
+    TEST_ASSERT_FALSE(urc_script_index_lookup(&index, beyond.script, beyond.script_len, &hit));
+    const urc_script_index_hit used = {.descriptor = 0, .chain = 0, .index = gap_limit - 1};
+    TEST_ASSERT_EQUAL(URC_OK, urc_script_index_mark_used(&index, &used));
+    TEST_ASSERT_EQUAL(3 * gap_limit, index.entries_count);
+    TEST_ASSERT_TRUE(urc_script_index_lookup(&index, beyond.script, beyond.script_len, &hit));
+    TEST_ASSERT_EQUAL(0, hit.chain);
+    TEST_ASSERT_EQUAL(gap_limit + 10, hit.index);
+
+    urc_script_index_free(&index);
+    TEST_ASSERT_NULL(index.slots);
+}
@@ -35,6 +35,13 @@ TEST(eckey, test_vector_1) {
     TEST_ASSERT_EQUAL_STRING(expected, output);
 
     urc_string_free(output);
+
+    char buffer[BUFLEN];
+    size_t key_len = 0;
+    TEST_ASSERT_EQUAL(URC_EBUFFERTOOSMALL, urc_crypto_eckey_format_to_buffer(&eckey, buffer, strlen(expected), &key_len));
+    TEST_ASSERT_EQUAL(strlen(expected), key_len);
+    TEST_ASSERT_EQUAL(URC_OK, urc_crypto_eckey_format_to_buffer(&eckey, buffer, key_len + 1, &key_len));
+    TEST_ASSERT_EQUAL_STRING(expected, buffer);
 }
 
 TEST(eckey, test_vector_2) {
@@ -58,3 +65,28 @@ TEST(eckey, test_vector_2) {
 
     urc_string_free(output);
 }
+
+TEST(eckey, serialize)
+{
+    const char *vectors[] = {"a202f50358208c05c4b4f3e88840a4f4b5f155cfd69473ea169f3d0431b7a6787a23777f08aa",
+                             "a103582103bec5163df25d8703150c3a1804eac7d615bb212b7cc9d7ff937aa8bd1c494b7f"};
+    for (size_t idx = 0; idx < sizeof(vectors) / sizeof(vectors[0]); idx++) {
+        uint8_t raw[BUFLEN];
+        size_t len = h2b(vectors[idx], BUFLEN, (uint8_t *)&raw);
+        TEST_ASSERT_GREATER_THAN_INT(0, len);
+        crypto_eckey eckey;
+        TEST_ASSERT_EQUAL(URC_OK, urc_crypto_eckey_deserialize(raw, len, &eckey));
+
+        uint8_t *cbor;
+        size_t cbor_len;
+        TEST_ASSERT_EQUAL(URC_OK, urc_crypto_eckey_serialize(&eckey, &cbor, &cbor_len));
+        TEST_ASSERT_EQUAL(len, cbor_len);
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(raw, cbor, len);
+        urc_free(cbor);
+    }
+
+    crypto_eckey eckey = {.type = eckey_type_na};
+    uint8_t *cbor;
+    size_t cbor_len;
+    TEST_ASSERT_EQUAL(URC_EINVALIDARG, urc_crypto_eckey_serialize(&eckey, &cbor, &cbor_len));
+}
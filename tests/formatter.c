@@ -40,3 +40,25 @@ TEST(formatter, jaderequest_format) {
     TEST_ASSERT_EQUAL_UINT8_ARRAY(bufferexpected, buffer, len);
     urc_free(buffer);
 }
+
+TEST(formatter, crypto_seed_serialize) {
+    // https://github.com/BlockchainCommons/Research/blob/master/papers/urc-2020-006-urtypes.md#exampletest-vector-1
+    const char *expected = "a20150c7098580125e2ab0981253468b2dbc5202d8641947da";
+    uint8_t bufferexpected[BUFLEN];
+    size_t len = h2b(expected, BUFLEN, bufferexpected);
+    TEST_ASSERT_GREATER_THAN(0, len);
+
+    crypto_seed seed;
+    TEST_ASSERT_EQUAL(URC_OK, urc_crypto_seed_deserialize(bufferexpected, len, &seed));
+
+    uint8_t buffer[SMALLBUFLEN];
+    size_t buflen = 0;
+    TEST_ASSERT_EQUAL(URC_EBUFFERTOOSMALL, urc_crypto_seed_serialize_to_buffer(&seed, buffer, SMALLBUFLEN, &buflen));
+    TEST_ASSERT_EQUAL(len, buflen);
+
+    uint8_t *allocated;
+    TEST_ASSERT_EQUAL(URC_OK, urc_crypto_seed_serialize(&seed, &allocated, &buflen));
+    TEST_ASSERT_EQUAL(len, buflen);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(bufferexpected, allocated, len);
+    urc_free(allocated);
+}
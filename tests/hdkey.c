@@ -37,6 +37,15 @@ TEST(hdkey, test_vector_1)
     TEST_ASSERT_EQUAL_STRING(expected, out);
     urc_string_free(out);
 
+    {
+        char buffer[BUFLEN];
+        size_t base58_len = 0;
+        TEST_ASSERT_EQUAL(URC_EBUFFERTOOSMALL, urc_crypto_hdkey_format_to_buffer(&hdkey, NULL, 0, &base58_len));
+        TEST_ASSERT_EQUAL(strlen(expected), base58_len);
+        TEST_ASSERT_EQUAL(URC_EBUFFERTOOSMALL, urc_crypto_hdkey_format_to_buffer(&hdkey, buffer, base58_len, &base58_len));
+        TEST_ASSERT_EQUAL(URC_OK, urc_crypto_hdkey_format_to_buffer(&hdkey, buffer, base58_len + 1, &base58_len));
+        TEST_ASSERT_EQUAL_STRING(expected, buffer);
+    }
     {
         const char *expected = "[00000000]";
         const size_t expected_len = strlen(expected);
@@ -114,3 +123,144 @@ TEST(hdkey, test_vector_2)
         free(derivationpath);
     }
 }
+
+TEST(hdkey, name_view)
+{
+    // test vector 2 with an extra name (key 9) "test"
+    const char *hex = "a6035821026fe2355745bb2db3630bbc80ef5d58951c963c841f54170ba6e5c12be7fc12a6045820ced155c72456255881793514ed"
+                      "c5bd9447e7f74abb88c6d6b6480fd016ee8c8505d90131a1020106d90130a1018a182cf501f501f500f401f4081ae9181cf3"
+                      "096474657374";
+
+    uint8_t raw[BUFLEN];
+    size_t len = h2b(hex, BUFLEN, (uint8_t *)(&raw));
+    TEST_ASSERT_GREATER_THAN_INT(0, len);
+
+    crypto_hdkey hdkey;
+    int err = urc_crypto_hdkey_deserialize(raw, len, &hdkey);
+    TEST_ASSERT_EQUAL(URC_OK, err);
+    TEST_ASSERT_EQUAL(hdkey_type_derived, hdkey.type);
+    TEST_ASSERT_EQUAL_STRING("test", hdkey.key.derived.name);
+    TEST_ASSERT_EQUAL(4, hdkey.key.derived.name_view.len);
+    TEST_ASSERT_EQUAL_PTR(&raw[len - 4], hdkey.key.derived.name_view.text);
+    TEST_ASSERT_NULL(hdkey.key.derived.note_view.text);
+    TEST_ASSERT_EQUAL(0, hdkey.key.derived.note_view.len);
+}
+
+TEST(hdkey, truncated_keyorigin)
+{
+    const char *hex = "a5035821026fe2355745bb2db3630bbc80ef5d58951c963c841f54170ba6e5c12be7fc12a6045820ced155c72456255881793514ed"
+                      "c5bd9447e7f74abb88c6d6b6480fd016ee8c8505d90131a1020106d90130a1018a182cf501f501f500f401f4081ae9181cf3";
+    const char *expected = "[e9181cf3/44'/1'/1'/0/1]";
+
+    uint8_t raw[BUFLEN];
+    size_t len = h2b(hex, BUFLEN, (uint8_t *)(&raw));
+    TEST_ASSERT_GREATER_THAN_INT(0, len);
+
+    crypto_hdkey hdkey;
+    int err = urc_crypto_hdkey_deserialize(raw, len, &hdkey);
+    TEST_ASSERT_EQUAL(URC_OK, err);
+
+    // like snprintf the whole length is returned, the output is truncated and terminated
+    TEST_ASSERT_EQUAL(strlen(expected), format_keyorigin(&hdkey, NULL, 0));
+    char keyorigin[10];
+    TEST_ASSERT_EQUAL(strlen(expected), format_keyorigin(&hdkey, keyorigin, sizeof(keyorigin)));
+    TEST_ASSERT_EQUAL_STRING("[e9181cf3", keyorigin);
+}
+
+TEST(hdkey, cache)
+{
+    const char *master_hex = "a301f503582100e8f32e723decf4051aefac8e2c93c9c5b214313817cdb01a1494b917c8436b35045820873dff81c02f525"
+                             "623fd1fe5167eac3a55a049de3d314bb42ee227ffed37d508";
+    const char *derived_hex = "a5035821026fe2355745bb2db3630bbc80ef5d58951c963c841f54170ba6e5c12be7fc12a6045820ced155c7245625588"
+                              "1793514edc5bd9447e7f74abb88c6d6b6480fd016ee8c8505d90131a1020106d90130a1018a182cf501f501f500f401f408"
+                              "1ae9181cf3";
+    const char *expected =
+        "tpubDHW3GtnVrTatx38EcygoSf9UhUd9Dx1rht7FAL8unrMo8r2NWhJuYNqDFS7cZFVbDaxJkV94MLZAr86XFPsAPYcoHWJ7sWYsrmHDw5sKQ2K";
+
+    uint8_t raw[BUFLEN];
+    size_t len = h2b(derived_hex, BUFLEN, raw);
+    crypto_hdkey derived;
+    TEST_ASSERT_EQUAL(URC_OK, urc_crypto_hdkey_deserialize(raw, len, &derived));
+    len = h2b(master_hex, BUFLEN, raw);
+    crypto_hdkey master;
+    TEST_ASSERT_EQUAL(URC_OK, urc_crypto_hdkey_deserialize(raw, len, &master));
+
+    TEST_ASSERT_EQUAL(URC_EINVALIDARG, urc_hdkey_cache_enable(0));
+    TEST_ASSERT_EQUAL(URC_OK, urc_hdkey_cache_enable(4));
+    urc_hdkey_cache_stats stats;
+    char *out;
+    for (size_t idx = 0; idx < 3; idx++) {
+        TEST_ASSERT_EQUAL(URC_OK, urc_crypto_hdkey_format(&derived, &out));
+        TEST_ASSERT_EQUAL_STRING(expected, out);
+        urc_string_free(out);
+    }
+    urc_hdkey_cache_get_stats(&stats);
+    TEST_ASSERT_EQUAL(2, stats.hits);
+    TEST_ASSERT_EQUAL(1, stats.misses);
+    TEST_ASSERT_EQUAL(1, stats.entries);
+    TEST_ASSERT_EQUAL(4, stats.capacity);
+
+    // private keys bypass the cache
+    TEST_ASSERT_EQUAL(URC_OK, urc_crypto_hdkey_format(&master, &out));
+    urc_string_free(out);
+    urc_hdkey_cache_get_stats(&stats);
+    TEST_ASSERT_EQUAL(2, stats.hits);
+    TEST_ASSERT_EQUAL(1, stats.misses);
+    TEST_ASSERT_EQUAL(1, stats.entries);
+
+    // a different parent fingerprint is a different key
+    derived.key.derived.parent_fingerprint ^= 1;
+    TEST_ASSERT_EQUAL(URC_OK, urc_crypto_hdkey_format(&derived, &out));
+    TEST_ASSERT_NOT_EQUAL(0, strcmp(expected, out));
+    urc_string_free(out);
+    urc_hdkey_cache_get_stats(&stats);
+    TEST_ASSERT_EQUAL(2, stats.misses);
+    TEST_ASSERT_EQUAL(2, stats.entries);
+
+    urc_hdkey_cache_reset_stats();
+    urc_hdkey_cache_get_stats(&stats);
+    TEST_ASSERT_EQUAL(0, stats.hits);
+    TEST_ASSERT_EQUAL(0, stats.misses);
+
+    urc_hdkey_cache_disable();
+    urc_hdkey_cache_get_stats(&stats);
+    TEST_ASSERT_EQUAL(0, stats.entries);
+    TEST_ASSERT_EQUAL(0, stats.capacity);
+}
+
+TEST(hdkey, serialize)
+{
+    // test vectors 1 and 2, and name_view's
+    const char *vectors[] = {
+        "a301f503582100e8f32e723decf4051aefac8e2c93c9c5b214313817cdb01a1494b917c8436b35045820873dff81c02f525623fd1fe5167eac3a"
+        "55a049de3d314bb42ee227ffed37d508",
+        "a5035821026fe2355745bb2db3630bbc80ef5d58951c963c841f54170ba6e5c12be7fc12a6045820ced155c72456255881793514edc5bd9447e7"
+        "f74abb88c6d6b6480fd016ee8c8505d90131a1020106d90130a1018a182cf501f501f500f401f4081ae9181cf3",
+        "a6035821026fe2355745bb2db3630bbc80ef5d58951c963c841f54170ba6e5c12be7fc12a6045820ced155c72456255881793514edc5bd9447e7"
+        "f74abb88c6d6b6480fd016ee8c8505d90131a1020106d90130a1018a182cf501f501f500f401f4081ae9181cf3096474657374",
+    };
+    for (size_t idx = 0; idx < sizeof(vectors) / sizeof(vectors[0]); idx++) {
+        uint8_t raw[BUFLEN];
+        size_t len = h2b(vectors[idx], BUFLEN, (uint8_t *)(&raw));
+        TEST_ASSERT_GREATER_THAN_INT(0, len);
+        crypto_hdkey hdkey;
+        TEST_ASSERT_EQUAL(URC_OK, urc_crypto_hdkey_deserialize(raw, len, &hdkey));
+
+        // measured without writing, then written in place
+        size_t cbor_len = 0;
+        TEST_ASSERT_EQUAL(URC_EBUFFERTOOSMALL, urc_crypto_hdkey_serialize_to_buffer(&hdkey, NULL, 0, &cbor_len));
+        TEST_ASSERT_EQUAL(len, cbor_len);
+        uint8_t cbor[BUFLEN];
+        TEST_ASSERT_EQUAL(URC_EBUFFERTOOSMALL, urc_crypto_hdkey_serialize_to_buffer(&hdkey, cbor, len - 1, &cbor_len));
+        TEST_ASSERT_EQUAL(len, cbor_len);
+        TEST_ASSERT_EQUAL(URC_OK, urc_crypto_hdkey_serialize_to_buffer(&hdkey, cbor, sizeof(cbor), &cbor_len));
+        TEST_ASSERT_EQUAL(len, cbor_len);
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(raw, cbor, len);
+
+        uint8_t *allocated;
+        TEST_ASSERT_EQUAL(URC_OK, urc_crypto_hdkey_serialize(&hdkey, &allocated, &cbor_len));
+        TEST_ASSERT_EQUAL(len, cbor_len);
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(raw, allocated, len);
+        urc_free(allocated);
+    }
+}
@@ -1,3 +1,4 @@
+#include <string.h>
 
 #include "unity_fixture.h"
 
@@ -81,3 +82,136 @@ TEST(output, test_vector_4)
     TEST_ASSERT_EQUAL_STRING(expected, out);
     urc_string_free(out);
 }
+
+TEST(output, checksum)
+{
+    // test vector 1
+    const char *hex = "d90193d90132a103582102c6047f9441ed7d6d3045406e95c07cd85c778e4b8cef3ca7abac09b95c709ee5";
+    const char *expected = "pkh(02c6047f9441ed7d6d3045406e95c07cd85c778e4b8cef3ca7abac09b95c709ee5)#8fhd9pwu";
+
+    uint8_t raw[BUFLEN];
+    size_t len = h2b(hex, BUFLEN, (uint8_t *)(&raw));
+    TEST_ASSERT_GREATER_THAN_INT(0, len);
+
+    crypto_output output;
+    int err = urc_crypto_output_deserialize(raw, len, &output);
+    TEST_ASSERT_EQUAL(URC_OK, err);
+
+    char *out;
+    err = urc_crypto_output_format(&output, urc_crypto_output_format_mode_checksum, &out);
+    TEST_ASSERT_EQUAL(URC_OK, err);
+    TEST_ASSERT_EQUAL_STRING(expected, out);
+    TEST_ASSERT_EQUAL(URC_OK, urc_descriptor_checksum_verify(out, strlen(out)));
+    urc_string_free(out);
+
+    char buffer[BUFLEN];
+    size_t descriptor_len = 0;
+    err = urc_crypto_output_format_to_buffer(&output, urc_crypto_output_format_mode_checksum, NULL, 0, &descriptor_len);
+    TEST_ASSERT_EQUAL(URC_EBUFFERTOOSMALL, err);
+    TEST_ASSERT_EQUAL(strlen(expected), descriptor_len);
+    // room for the descriptor but not its NUL: nothing truncated is left behind
+    memset(buffer, 'x', sizeof(buffer));
+    err = urc_crypto_output_format_to_buffer(&output, urc_crypto_output_format_mode_checksum, buffer, descriptor_len,
+                                             &descriptor_len);
+    TEST_ASSERT_EQUAL(URC_EBUFFERTOOSMALL, err);
+    TEST_ASSERT_EQUAL(strlen(expected), descriptor_len);
+    const char zeros[BUFLEN] = {0};
+    TEST_ASSERT_EQUAL_MEMORY(zeros, buffer, descriptor_len);
+    err = urc_crypto_output_format_to_buffer(&output, urc_crypto_output_format_mode_checksum, buffer, descriptor_len + 1,
+                                             &descriptor_len);
+    TEST_ASSERT_EQUAL(URC_OK, err);
+    TEST_ASSERT_EQUAL(strlen(expected), descriptor_len);
+    TEST_ASSERT_EQUAL_STRING(expected, buffer);
+
+    // https://github.com/bitcoin/bips/blob/master/bip-0380.mediawiki#test-vectors
+    char checksum[URC_DESCRIPTOR_CHECKSUM_LEN + 1];
+    TEST_ASSERT_EQUAL(URC_OK, urc_descriptor_checksum("raw(deadbeef)", 13, checksum));
+    TEST_ASSERT_EQUAL_STRING("89f8spxm", checksum);
+    TEST_ASSERT_EQUAL(URC_OK, urc_descriptor_checksum_verify("raw(deadbeef)#89f8spxm", 22));
+    TEST_ASSERT_EQUAL(URC_EINVALIDCHECKSUM, urc_descriptor_checksum_verify("raw(deedbeef)#89f8spxm", 22));
+    TEST_ASSERT_EQUAL(URC_EINVALIDCHECKSUM, urc_descriptor_checksum_verify("raw(deadbeef)#89f8spxn", 22));
+    TEST_ASSERT_EQUAL(URC_EINVALIDARG, urc_descriptor_checksum_verify("raw(deadbeef)#89f8spx", 21));
+    TEST_ASSERT_EQUAL(URC_EINVALIDARG, urc_descriptor_checksum_verify("raw(deadbeef)", 13));
+    TEST_ASSERT_EQUAL(URC_EINVALIDARG, urc_descriptor_checksum_verify("raw(\xe9)#89f8spxm", 15));
+}
+
+TEST(output, serialize)
+{
+    // test vectors 1, 2 and 4
+    const char *vectors[] = {
+        "d90193d90132a103582102c6047f9441ed7d6d3045406e95c07cd85c778e4b8cef3ca7abac09b95c709ee5",
+        "d90190d90194d90132a103582103fff97bd5755eeea420453a14355235d382f6472f8568a18b2f057a1460297556",
+        "d90193d9012fa503582102d2b36900396c9282fa14628566582f206a5dd0bcc8d5e892611806cafb0301f0045820637807030d55d01f9a0cb3a78395"
+        "15d796bd07706386a6eddf06cc29a65a0e2906d90130a30186182cf500f500f5021ad34db33f030407d90130a1018401f480f4081a78412e3a",
+    };
+    for (size_t idx = 0; idx < sizeof(vectors) / sizeof(vectors[0]); idx++) {
+        uint8_t raw[BUFLEN];
+        size_t len = h2b(vectors[idx], BUFLEN, (uint8_t *)(&raw));
+        TEST_ASSERT_GREATER_THAN_INT(0, len);
+        crypto_output output;
+        TEST_ASSERT_EQUAL(URC_OK, urc_crypto_output_deserialize(raw, len, &output));
+
+        uint8_t *cbor;
+        size_t cbor_len;
+        TEST_ASSERT_EQUAL(URC_OK, urc_crypto_output_serialize(&output, &cbor, &cbor_len));
+        TEST_ASSERT_EQUAL(len, cbor_len);
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(raw, cbor, len);
+        urc_free(cbor);
+    }
+}
+
+TEST(output, compact)
+{
+    // test vectors 1, 2 and 4, and wpkh of hdkey test vector 2 with an extra name (key 9) "test"
+    const char *vectors[] = {
+        "d90193d90132a103582102c6047f9441ed7d6d3045406e95c07cd85c778e4b8cef3ca7abac09b95c709ee5",
+        "d90190d90194d90132a103582103fff97bd5755eeea420453a14355235d382f6472f8568a18b2f057a1460297556",
+        "d90193d9012fa503582102d2b36900396c9282fa14628566582f206a5dd0bcc8d5e892611806cafb0301f0045820637807030d55d01f9a0cb3a78395"
+        "15d796bd07706386a6eddf06cc29a65a0e2906d90130a30186182cf500f500f5021ad34db33f030407d90130a1018401f480f4081a78412e3a",
+        "d90194d9012fa6035821026fe2355745bb2db3630bbc80ef5d58951c963c841f54170ba6e5c12be7fc12a6045820ced155c72456255881793514"
+        "edc5bd9447e7f74abb88c6d6b6480fd016ee8c8505d90131a1020106d90130a1018a182cf501f501f500f401f4081ae9181cf3096474657374",
+    };
+    TEST_ASSERT_LESS_THAN(sizeof(crypto_output) / 4, sizeof(crypto_output_compact));
+    for (size_t idx = 0; idx < sizeof(vectors) / sizeof(vectors[0]); idx++) {
+        uint8_t raw[BUFLEN];
+        size_t len = h2b(vectors[idx], BUFLEN, (uint8_t *)(&raw));
+        TEST_ASSERT_GREATER_THAN_INT(0, len);
+        crypto_output output;
+        TEST_ASSERT_EQUAL(URC_OK, urc_crypto_output_deserialize(raw, len, &output));
+        char expected[BUFLEN];
+        size_t expected_len;
+        TEST_ASSERT_EQUAL(URC_OK, urc_crypto_output_format_to_buffer(&output, urc_crypto_output_format_mode_default,
+                                                                     expected, BUFLEN, &expected_len));
+
+        crypto_output_compact compact;
+        TEST_ASSERT_EQUAL(URC_OK, urc_crypto_output_deserialize_compact(raw, len, &compact));
+        // nothing points into the deserialized buffer anymore
+        uint8_t copy[BUFLEN];
+        memcpy(copy, raw, len);
+        memset(raw, 0, len);
+
+        crypto_output expanded;
+        TEST_ASSERT_EQUAL(URC_OK, urc_crypto_output_compact_expand(&compact, &expanded));
+        char descriptor[BUFLEN];
+        size_t descriptor_len;
+        TEST_ASSERT_EQUAL(URC_OK, urc_crypto_output_format_to_buffer(&expanded, urc_crypto_output_format_mode_default,
+                                                                     descriptor, BUFLEN, &descriptor_len));
+        TEST_ASSERT_EQUAL_STRING(expected, descriptor);
+        uint8_t cbor[BUFLEN];
+        size_t cbor_len;
+        TEST_ASSERT_EQUAL(URC_OK, urc_crypto_output_serialize_to_buffer(&expanded, cbor, BUFLEN, &cbor_len));
+        TEST_ASSERT_EQUAL(len, cbor_len);
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(copy, cbor, len);
+        if (idx == 3) {
+            const hd_derived_key *key = &expanded.output.key.key.hdkey.key.derived;
+            TEST_ASSERT_EQUAL_STRING("test", key->name);
+            TEST_ASSERT_EQUAL(4, key->name_view.len);
+            TEST_ASSERT_EQUAL_MEMORY("test", key->name_view.text, 4);
+            TEST_ASSERT_NULL(key->note_view.text);
+        } else if (idx < 2) {
+            TEST_ASSERT_NULL(compact.extra);
+        }
+        urc_crypto_output_compact_free(&compact);
+        TEST_ASSERT_NULL(compact.extra);
+    }
+}
@@ -11,7 +11,7 @@
 TEST_GROUP(parser);
 
 TEST_SETUP(parser) {}
-TEST_TEAR_DOWN(parser) {}
+TEST_TEAR_DOWN(parser) { urc_set_thread_validation_profile(urc_validation_profile_trusted); }
 
 TEST(parser, crypto_seed_deserialize)
 {
@@ -44,3 +44,85 @@ TEST(parser, crypto_eckey_deserialize)
     TEST_ASSERT_EQUAL_HEX(0x8c, eckey.key.prvate[0]);
     TEST_ASSERT_EQUAL_HEX(0xaa, eckey.key.prvate[CRYPTO_ECKEY_PRIVATE_SIZE - 1]);
 }
+
+TEST(parser, jade_bip8539_response_deserialize)
+{
+    // {"pubkey": h'037aa2...d2', "encrypted": h'deadbeef'}
+    const char *hex = "a2667075626b65795821037aa2120135ae201c0586ad9f450ad3f4641ddabcd9bd3e692944d9d8fd8ed8d2"
+                      "69656e63727970746564"
+                      "44deadbeef";
+    uint8_t raw[BUFLEN];
+    size_t len = h2b(hex, BUFLEN, (uint8_t *)&raw);
+    TEST_ASSERT_GREATER_THAN_INT(0, len);
+    const uint8_t expected[] = {0xde, 0xad, 0xbe, 0xef};
+
+    jade_bip8539_response response;
+    int err = urc_jade_bip8539_response_deserialize(raw, len, &response);
+    TEST_ASSERT_EQUAL(URC_OK, err);
+    TEST_ASSERT_EQUAL_HEX(0x03, response.pubkey[0]);
+    TEST_ASSERT_EQUAL(sizeof(expected), response.encrypted_len);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, response.encrypted_data, sizeof(expected));
+    urc_jade_bip8539_response_free(&response);
+
+    jade_bip8539_response_view view;
+    err = urc_jade_bip8539_response_deserialize_borrowed(raw, len, &view);
+    TEST_ASSERT_EQUAL(URC_OK, err);
+    TEST_ASSERT_EQUAL_HEX(0xd2, view.pubkey[CRYPTO_ECKEY_PUBLIC_COMPRESSED_SIZE - 1]);
+    TEST_ASSERT_EQUAL(sizeof(expected), view.encrypted_len);
+    TEST_ASSERT_EQUAL_PTR(&raw[len - sizeof(expected)], view.encrypted_data);
+}
+
+TEST(parser, validation_profile)
+{
+    // crypto-seed test vector 1 followed by a stray byte
+    const char *hex = "a20150c7098580125e2ab0981253468b2dbc5202d8641947da00";
+    uint8_t raw[BUFLEN];
+    size_t len = h2b(hex, BUFLEN, (uint8_t *)&raw);
+    TEST_ASSERT_GREATER_THAN_INT(0, len);
+
+    crypto_seed seed;
+    TEST_ASSERT_EQUAL(urc_validation_profile_trusted, urc_get_thread_validation_profile());
+    TEST_ASSERT_EQUAL(URC_OK, urc_crypto_seed_deserialize(raw, len, &seed));
+
+    TEST_ASSERT_EQUAL(urc_validation_profile_trusted, urc_set_thread_validation_profile(urc_validation_profile_strict));
+    TEST_ASSERT_EQUAL(URC_ECBORINTERNALERROR, urc_crypto_seed_deserialize(raw, len, &seed));
+    TEST_ASSERT_EQUAL(URC_OK, urc_crypto_seed_deserialize(raw, len - 1, &seed));
+    TEST_ASSERT_EQUAL(18394, seed.creation_date);
+
+    // an explicit profile overrides the thread's one, both ways, and leaves it as it was
+    TEST_ASSERT_EQUAL(URC_OK, urc_deserialize_with_profile(urc_batch_type_crypto_seed, raw, len, &seed,
+                                                           urc_validation_profile_trusted));
+    urc_set_thread_validation_profile(urc_validation_profile_trusted);
+    TEST_ASSERT_EQUAL(URC_ECBORINTERNALERROR, urc_deserialize_with_profile(urc_batch_type_crypto_seed, raw, len, &seed,
+                                                                           urc_validation_profile_strict));
+    TEST_ASSERT_EQUAL(urc_validation_profile_trusted, urc_get_thread_validation_profile());
+    TEST_ASSERT_EQUAL(URC_EINVALIDARG, urc_deserialize_with_profile(urc_batch_type_crypto_seed, raw, len, NULL,
+                                                                    urc_validation_profile_strict));
+}
+
+TEST(parser, schema_errors)
+{
+    uint8_t raw[BUFLEN];
+    crypto_seed seed;
+
+    // crypto-seed test vector 1, keys in the wrong order: the required seed (1) is found missing at key 2
+    size_t len = h2b("a202d8641947da0150c7098580125e2ab0981253468b2dbc52", BUFLEN, (uint8_t *)&raw);
+    TEST_ASSERT_GREATER_THAN_INT(0, len);
+    TEST_ASSERT_EQUAL(URC_EUNEXPECTEDMAPKEY, urc_crypto_seed_deserialize(raw, len, &seed));
+
+    // unknown key 3
+    len = h2b("a30150c7098580125e2ab0981253468b2dbc5202d8641947da0300", BUFLEN, (uint8_t *)&raw);
+    TEST_ASSERT_GREATER_THAN_INT(0, len);
+    TEST_ASSERT_EQUAL(URC_EUNKNOWNFORMAT, urc_crypto_seed_deserialize(raw, len, &seed));
+
+    // optional creation date absent
+    len = h2b("a10150c7098580125e2ab0981253468b2dbc52", BUFLEN, (uint8_t *)&raw);
+    TEST_ASSERT_GREATER_THAN_INT(0, len);
+    TEST_ASSERT_EQUAL(URC_OK, urc_crypto_seed_deserialize(raw, len, &seed));
+    TEST_ASSERT_EQUAL(0, seed.creation_date);
+
+    // creation date without its tag
+    len = h2b("a20150c7098580125e2ab0981253468b2dbc52021947da", BUFLEN, (uint8_t *)&raw);
+    TEST_ASSERT_GREATER_THAN_INT(0, len);
+    TEST_ASSERT_EQUAL(URC_EUNEXPECTEDTYPE, urc_crypto_seed_deserialize(raw, len, &seed));
+}
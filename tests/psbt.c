@@ -1,4 +1,6 @@
 
+#include <string.h>
+
 #include "unity_fixture.h"
 
 #include "urc/crypto_psbt.h"
@@ -39,12 +41,165 @@ TEST(psbt, test_vector_1)
     size_t buffer_len;
     int result = urc_crypto_psbt_serialize(&psbt, &buffer, &buffer_len);
     TEST_ASSERT_EQUAL(URC_OK, result);
+    TEST_ASSERT_EQUAL(cbor_len, buffer_len);
     TEST_ASSERT_EQUAL_UINT8_ARRAY(raw_cbor_psbt, buffer, buffer_len);
     urc_free(buffer);
 
+    uint8_t out[BUFLEN];
+    size_t out_len = 0;
+    TEST_ASSERT_EQUAL(URC_EBUFFERTOOSMALL, urc_crypto_psbt_serialize_to_buffer(&psbt, NULL, 0, &out_len));
+    TEST_ASSERT_EQUAL(cbor_len, out_len);
+    TEST_ASSERT_EQUAL(URC_EBUFFERTOOSMALL, urc_crypto_psbt_serialize_to_buffer(&psbt, out, cbor_len - 1, &out_len));
+    TEST_ASSERT_EQUAL(URC_OK, urc_crypto_psbt_serialize_to_buffer(&psbt, out, cbor_len, &out_len));
+    TEST_ASSERT_EQUAL(cbor_len, out_len);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(raw_cbor_psbt, out, out_len);
+
+    uint8_t header[URC_CRYPTO_PSBT_HEADER_MAX_LEN];
+    size_t header_len;
+    TEST_ASSERT_EQUAL(URC_OK, urc_crypto_psbt_serialize_header(raw_len, header, &header_len));
+    TEST_ASSERT_EQUAL(cbor_len - raw_len, header_len);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(raw_cbor_psbt, header, header_len);
+    TEST_ASSERT_EQUAL(URC_EINVALIDARG, urc_crypto_psbt_serialize_header(0, header, &header_len));
+    // every header width
+    const struct {
+        size_t psbt_len;
+        const char *header_hex;
+    } headers[] = {
+        {1, "41"},        {23, "57"},       {24, "5818"},           {255, "58ff"},
+        {256, "590100"},  {65535, "59ffff"}, {65536, "5a00010000"},
+    };
+    for (size_t idx = 0; idx < sizeof(headers) / sizeof(headers[0]); idx++) {
+        uint8_t expected[URC_CRYPTO_PSBT_HEADER_MAX_LEN];
+        const size_t expected_len = h2b(headers[idx].header_hex, sizeof(expected), expected);
+        TEST_ASSERT_EQUAL(URC_OK, urc_crypto_psbt_serialize_header(headers[idx].psbt_len, header, &header_len));
+        TEST_ASSERT_EQUAL(expected_len, header_len);
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, header, header_len);
+    }
+    if (sizeof(size_t) > 4) {
+        TEST_ASSERT_EQUAL(URC_OK, urc_crypto_psbt_serialize_header((size_t)UINT32_MAX + 1, header, &header_len));
+        TEST_ASSERT_EQUAL(9, header_len);
+        const uint8_t expected[] = {0x5b, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00};
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, header, header_len);
+    }
+
     result = urc_crypto_psbt_deserialize(raw_cbor_psbt, cbor_len, &psbt);
     TEST_ASSERT_EQUAL(URC_OK, result);
     TEST_ASSERT_EQUAL(raw_len, psbt.psbt_len);
     TEST_ASSERT_EQUAL_UINT8_ARRAY(raw_psbt, psbt.psbt, raw_len);
     urc_crypto_psbt_free(&psbt);
 }
+
+TEST(psbt, borrowed)
+{
+    const char *cbor_psbt_hex =
+        "58a770736274ff01009a020000000258e87a21b56daf0c23be8e7070456c336f7cbaa5c8757924f545887bb2abdd750000000000ffffffff838d0427"
+        "d0ec650a68aa46bb0b098aea4422c071b2ca78352a077959d07cea1d0100000000ffffffff0270aaf00800000000160014d85c2b71d0060b09c9886a"
+        "eb815e50991dda124d00e1f5050000000016001400aea9a2e5f0f876a588df5546e8742d1d87008f000000000000000000";
+
+    uint8_t raw_cbor_psbt[BUFLEN];
+    size_t cbor_len = h2b(cbor_psbt_hex, BUFLEN, (uint8_t *)&raw_cbor_psbt);
+    TEST_ASSERT_GREATER_THAN_INT(0, cbor_len);
+
+    crypto_psbt_view psbt;
+    int result = urc_crypto_psbt_deserialize_borrowed(raw_cbor_psbt, cbor_len, &psbt);
+    TEST_ASSERT_EQUAL(URC_OK, result);
+    // 0x58 0xa7: byte string header, the psbt follows
+    TEST_ASSERT_EQUAL_PTR(&raw_cbor_psbt[2], psbt.psbt);
+    TEST_ASSERT_EQUAL(cbor_len - 2, psbt.psbt_len);
+
+    // indefinite length byte string, made of two chunks
+    const uint8_t chunked[] = {0x5f, 0x42, 0x70, 0x73, 0x42, 0x62, 0x74, 0xff};
+    result = urc_crypto_psbt_deserialize_borrowed(chunked, sizeof(chunked), &psbt);
+    TEST_ASSERT_EQUAL(URC_EUNHANDLEDCASE, result);
+    TEST_ASSERT_NULL(psbt.psbt);
+}
+
+typedef struct {
+    uint8_t buffer[BUFLEN];
+    size_t len;
+    size_t calls;
+} psbt_sink_ctx;
+
+static int psbt_sink(void *ctx, const uint8_t *psbt, size_t psbt_len)
+{
+    psbt_sink_ctx *sink = ctx;
+    TEST_ASSERT_LESS_OR_EQUAL(BUFLEN, sink->len + psbt_len);
+    memcpy(&sink->buffer[sink->len], psbt, psbt_len);
+    sink->len += psbt_len;
+    sink->calls++;
+    return URC_OK;
+}
+
+TEST(psbt, decoder)
+{
+    const char *cbor_psbt_hex =
+        "58a770736274ff01009a020000000258e87a21b56daf0c23be8e7070456c336f7cbaa5c8757924f545887bb2abdd750000000000ffffffff838d0427"
+        "d0ec650a68aa46bb0b098aea4422c071b2ca78352a077959d07cea1d0100000000ffffffff0270aaf00800000000160014d85c2b71d0060b09c9886a"
+        "eb815e50991dda124d00e1f5050000000016001400aea9a2e5f0f876a588df5546e8742d1d87008f000000000000000000";
+
+    uint8_t raw_cbor_psbt[BUFLEN];
+    size_t cbor_len = h2b(cbor_psbt_hex, BUFLEN, (uint8_t *)&raw_cbor_psbt);
+    TEST_ASSERT_GREATER_THAN_INT(0, cbor_len);
+
+    // one byte at a time into a sink
+    psbt_sink_ctx sink = {.len = 0, .calls = 0};
+    urc_crypto_psbt_decoder decoder;
+    urc_crypto_psbt_decoder_init(&decoder, psbt_sink, &sink);
+    size_t psbt_len = 0;
+    TEST_ASSERT_EQUAL(URC_EUNHANDLEDCASE, urc_crypto_psbt_decoder_expected_len(&decoder, &psbt_len));
+    for (size_t idx = 0; idx < cbor_len; idx++) {
+        TEST_ASSERT_EQUAL(URC_OK, urc_crypto_psbt_decoder_push(&decoder, &raw_cbor_psbt[idx], 1));
+        if (idx == 1) {
+            TEST_ASSERT_EQUAL(URC_OK, urc_crypto_psbt_decoder_expected_len(&decoder, &psbt_len));
+            TEST_ASSERT_EQUAL(cbor_len - 2, psbt_len);
+        }
+    }
+    TEST_ASSERT_EQUAL(URC_OK, urc_crypto_psbt_decoder_finish(&decoder, &psbt_len));
+    TEST_ASSERT_EQUAL(cbor_len - 2, psbt_len);
+    TEST_ASSERT_EQUAL(cbor_len - 2, sink.len);
+    TEST_ASSERT_EQUAL(cbor_len - 2, sink.calls);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(&raw_cbor_psbt[2], sink.buffer, sink.len);
+
+    // trailing bytes
+    TEST_ASSERT_EQUAL(URC_EINVALIDARG, urc_crypto_psbt_decoder_push(&decoder, raw_cbor_psbt, 1));
+
+    // two pieces into a buffer, then a buffer too small
+    uint8_t psbt[BUFLEN];
+    urc_crypto_psbt_decoder_init_buffer(&decoder, psbt, BUFLEN);
+    TEST_ASSERT_EQUAL(URC_OK, urc_crypto_psbt_decoder_push(&decoder, raw_cbor_psbt, 100));
+    TEST_ASSERT_EQUAL(URC_EUNEXPECTEDSTRINGLENGTH, urc_crypto_psbt_decoder_finish(&decoder, &psbt_len));
+    TEST_ASSERT_EQUAL(URC_OK, urc_crypto_psbt_decoder_push(&decoder, &raw_cbor_psbt[100], cbor_len - 100));
+    TEST_ASSERT_EQUAL(URC_OK, urc_crypto_psbt_decoder_finish(&decoder, &psbt_len));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(&raw_cbor_psbt[2], psbt, psbt_len);
+
+    urc_crypto_psbt_decoder_init_buffer(&decoder, psbt, cbor_len - 3);
+    TEST_ASSERT_EQUAL(URC_EBUFFERTOOSMALL, urc_crypto_psbt_decoder_push(&decoder, raw_cbor_psbt, cbor_len));
+    TEST_ASSERT_EQUAL(URC_EBUFFERTOOSMALL, urc_crypto_psbt_decoder_finish(&decoder, &psbt_len));
+}
+
+TEST(psbt, decoder_chunked)
+{
+    // indefinite length byte string, made of two chunks and an empty one
+    const uint8_t chunked[] = {0x5f, 0x42, 0x70, 0x73, 0x40, 0x42, 0x62, 0x74, 0xff};
+    const uint8_t expected[] = {0x70, 0x73, 0x62, 0x74};
+
+    // every split point
+    for (size_t split = 0; split <= sizeof(chunked); split++) {
+        uint8_t psbt[sizeof(expected)];
+        urc_crypto_psbt_decoder decoder;
+        urc_crypto_psbt_decoder_init_buffer(&decoder, psbt, sizeof(psbt));
+        TEST_ASSERT_EQUAL(URC_OK, urc_crypto_psbt_decoder_push(&decoder, chunked, split));
+        TEST_ASSERT_EQUAL(URC_OK, urc_crypto_psbt_decoder_push(&decoder, &chunked[split], sizeof(chunked) - split));
+        size_t psbt_len = 0;
+        TEST_ASSERT_EQUAL(URC_EUNHANDLEDCASE, urc_crypto_psbt_decoder_expected_len(&decoder, &psbt_len));
+        TEST_ASSERT_EQUAL(URC_OK, urc_crypto_psbt_decoder_finish(&decoder, &psbt_len));
+        TEST_ASSERT_EQUAL(sizeof(expected), psbt_len);
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, psbt, psbt_len);
+    }
+
+    // not a byte string
+    const uint8_t text[] = {0x62, 0x70, 0x73};
+    urc_crypto_psbt_decoder decoder;
+    urc_crypto_psbt_decoder_init_buffer(&decoder, (uint8_t *)text, 0);
+    TEST_ASSERT_EQUAL(URC_EUNEXPECTEDTYPE, urc_crypto_psbt_decoder_push(&decoder, text, sizeof(text)));
+}
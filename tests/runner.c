@@ -3,10 +3,14 @@
 
 TEST_GROUP_RUNNER(parser) {
     RUN_TEST_CASE(parser, crypto_seed_deserialize);
+    RUN_TEST_CASE(parser, jade_bip8539_response_deserialize);
+    RUN_TEST_CASE(parser, validation_profile);
+    RUN_TEST_CASE(parser, schema_errors);
 }
 
 TEST_GROUP_RUNNER(formatter) {
     RUN_TEST_CASE(formatter, jaderequest_format);
+    RUN_TEST_CASE(formatter, crypto_seed_serialize);
 }
 
 TEST_GROUP_RUNNER(jade_rpc) {
@@ -17,28 +21,68 @@ TEST_GROUP_RUNNER(jade_rpc) {
 
 TEST_GROUP_RUNNER(psbt) {
     RUN_TEST_CASE(psbt, test_vector_1);
+    RUN_TEST_CASE(psbt, borrowed);
+    RUN_TEST_CASE(psbt, decoder);
+    RUN_TEST_CASE(psbt, decoder_chunked);
 }
 
 TEST_GROUP_RUNNER(eckey) {
     RUN_TEST_CASE(eckey, test_vector_1);
     RUN_TEST_CASE(eckey, test_vector_2);
+    RUN_TEST_CASE(eckey, serialize);
 }
 
 TEST_GROUP_RUNNER(hdkey) {
     RUN_TEST_CASE(hdkey, test_vector_1);
     RUN_TEST_CASE(hdkey, test_vector_2);
+    RUN_TEST_CASE(hdkey, name_view);
+    RUN_TEST_CASE(hdkey, truncated_keyorigin);
+    RUN_TEST_CASE(hdkey, cache);
+    RUN_TEST_CASE(hdkey, serialize);
 }
 
 TEST_GROUP_RUNNER(output) {
     RUN_TEST_CASE(output, test_vector_1);
     RUN_TEST_CASE(output, test_vector_2);
     RUN_TEST_CASE(output, test_vector_4);
+    RUN_TEST_CASE(output, checksum);
+    RUN_TEST_CASE(output, serialize);
+    RUN_TEST_CASE(output, compact);
 }
 
 TEST_GROUP_RUNNER(account) {
     RUN_TEST_CASE(account, test_vector_1);
     RUN_TEST_CASE(account, jadetest);
     RUN_TEST_CASE(account, jade);
+    RUN_TEST_CASE(account, unbounded);
+    RUN_TEST_CASE(account, serialize);
+}
+
+TEST_GROUP_RUNNER(allocator) {
+    RUN_TEST_CASE(allocator, arena);
+    RUN_TEST_CASE(allocator, account_format);
+    RUN_TEST_CASE(allocator, stats);
+    RUN_TEST_CASE(allocator, trace);
+}
+
+TEST_GROUP_RUNNER(batch) {
+    RUN_TEST_CASE(batch, deserialize);
+}
+
+TEST_GROUP_RUNNER(derive) {
+    RUN_TEST_CASE(derive, pkh_wildcard);
+    RUN_TEST_CASE(derive, implicit_chains);
+    RUN_TEST_CASE(derive, unhandled);
+    RUN_TEST_CASE(derive, script_index);
+}
+
+TEST_GROUP_RUNNER(ur) {
+    RUN_TEST_CASE(ur, decode);
+    RUN_TEST_CASE(ur, deserialize);
+    RUN_TEST_CASE(ur, multipart);
+    RUN_TEST_CASE(ur, decoder_memory);
+    RUN_TEST_CASE(ur, encoder);
+    RUN_TEST_CASE(ur, crc32);
 }
 
 static void RunAllTests(void) {
@@ -50,6 +94,10 @@ static void RunAllTests(void) {
     RUN_TEST_GROUP(hdkey);
     RUN_TEST_GROUP(output);
     RUN_TEST_GROUP(account);
+    RUN_TEST_GROUP(allocator);
+    RUN_TEST_GROUP(batch);
+    RUN_TEST_GROUP(derive);
+    RUN_TEST_GROUP(ur);
 }
 
 int main(int argc, const char *argv[]) { return UnityMain(argc, argv, RunAllTests); }
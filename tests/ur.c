@@ -0,0 +1,269 @@
+#include <string.h>
+
+#include "unity.h"
+#include "unity_fixture.h"
+
+#include "urc/urc.h"
+
+#include "bytewords.h"
+#include "crc32.h"
+#include "helpers.h"
+
+#define BUFLEN 1024
+
+TEST_GROUP(ur);
+
+TEST_SETUP(ur) {}
+TEST_TEAR_DOWN(ur) {}
+
+TEST(ur, decode)
+{
+    // https://github.com/BlockchainCommons/bc-ur/blob/master/test/test.cpp
+    const char *ur = "ur:bytes/hdeymejtswhhylkepmykhhtsytsnoyoyaxaedsuttydmmhhpktpmsrjtgwdpfnsboxgwlbaawzuefywkdplrsrjynbvyg"
+                     "abwjldapfcsdwkbrkch";
+    const char *hex = "5832916ec65cf77cadf55cd7f9cda1a1030026ddd42e905b77adc36e4f2d3ccba44f7f04f2de44f42d84c374a0e149136f25b018";
+
+    uint8_t expected[BUFLEN];
+    size_t expected_len = h2b(hex, BUFLEN, expected);
+    uint8_t raw[BUFLEN];
+    size_t len;
+    urc_text_view type;
+    TEST_ASSERT_EQUAL(URC_OK, urc_ur_decode(ur, strlen(ur), &type, raw, BUFLEN, &len));
+    TEST_ASSERT_EQUAL(strlen("bytes"), type.len);
+    TEST_ASSERT_EQUAL(0, memcmp("bytes", type.text, type.len));
+    TEST_ASSERT_EQUAL(expected_len, len);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, raw, len);
+    TEST_ASSERT_LESS_OR_EQUAL(urc_ur_decoded_max_len(strlen(ur)), len);
+
+    // upper case, as found in alphanumeric QR codes
+    char upper[BUFLEN];
+    const size_t ur_len = strlen(ur);
+    for (size_t idx = 0; idx < ur_len; idx++) {
+        upper[idx] = ur[idx] >= 'a' && ur[idx] <= 'z' ? (char)(ur[idx] - 'a' + 'A') : ur[idx];
+    }
+    TEST_ASSERT_EQUAL(URC_OK, urc_ur_decode(upper, ur_len, &type, raw, BUFLEN, &len));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, raw, len);
+
+    TEST_ASSERT_EQUAL(URC_EBUFFERTOOSMALL, urc_ur_decode(ur, ur_len, &type, raw, expected_len - 1, &len));
+
+    char corrupted[BUFLEN];
+    memcpy(corrupted, ur, ur_len);
+    corrupted[ur_len - 1] = 'd';
+    TEST_ASSERT_EQUAL(URC_EINVALIDCHECKSUM, urc_ur_decode(corrupted, ur_len, &type, raw, BUFLEN, &len));
+    // "hx" is not a byteword
+    corrupted[ur_len - 1] = 'x';
+    TEST_ASSERT_EQUAL(URC_EUNKNOWNFORMAT, urc_ur_decode(corrupted, ur_len, &type, raw, BUFLEN, &len));
+    TEST_ASSERT_EQUAL(URC_EUNKNOWNFORMAT, urc_ur_decode(ur, ur_len - 1, &type, raw, BUFLEN, &len));
+    TEST_ASSERT_EQUAL(URC_EUNKNOWNFORMAT, urc_ur_decode(&ur[1], ur_len - 1, &type, raw, BUFLEN, &len));
+
+    const char *multipart = "ur:bytes/1-9/lpadascfadaxcywenbpljkhdcahkadaemejtswhhylkepmykhhtsytsnoyoyaxaedsuttydmmhhpkt"
+                            "pmsrjtdkgslpgh";
+    TEST_ASSERT_EQUAL(URC_EUNHANDLEDCASE, urc_ur_decode(multipart, strlen(multipart), &type, raw, BUFLEN, &len));
+}
+
+TEST(ur, deserialize)
+{
+    // pkh([d34db33f/44'/0'/0']xpub6ERApfZwUNrhLCkDtcHTcxd75RbzS1ed54G1LkBUHQVHQKqhMkhgbmJbZRkrgZw4koxb5JaHWkY4ALHY2grBGRjaDMzQLcgJvLJuZZvRcEL/1/*)
+    const char *output_ur =
+        "ur:crypto-output/taadmutaaddlonaxhdclaotdqdinaeesjzmolfzsbbidlpiyhddlcximhltirfsptlvsmohscsamsgzoaxadwtaahdcxiaksat"
+        "axbtgotictnybnqdoslsmdbztsmtryatjoialnolweuramsfdtolhtbadtamtaaddyotadlncsdwykaeykaeykaocytegtqdfhaxaaattaaddyoyadl"
+        "radwklawkaycyksfpdmftkiiozsfd";
+    const char *output_hex =
+        "d90193d9012fa503582102d2b36900396c9282fa14628566582f206a5dd0bcc8d5e892611806cafb0301f0045820637807030d55d01f9a0cb3a78395"
+        "15d796bd07706386a6eddf06cc29a65a0e2906d90130a30186182cf500f500f5021ad34db33f030407d90130a1018401f480f4081a78412e3a";
+
+    uint8_t raw[BUFLEN];
+    size_t len = h2b(output_hex, BUFLEN, raw);
+    crypto_output expected;
+    TEST_ASSERT_EQUAL(URC_OK, urc_crypto_output_deserialize(raw, len, &expected));
+
+    uint8_t buffer[BUFLEN];
+    urc_ur_object object;
+    TEST_ASSERT_EQUAL(URC_OK, urc_ur_deserialize(output_ur, strlen(output_ur), buffer, BUFLEN, &object));
+    TEST_ASSERT_EQUAL(urc_batch_type_crypto_output, object.type);
+    TEST_ASSERT_EQUAL(expected.type, object.value.output.type);
+    TEST_ASSERT_EQUAL(keyexp_type_pkh, object.value.output.output.key.type);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected.output.key.key.hdkey.key.derived.keydata,
+                                  object.value.output.output.key.key.hdkey.key.derived.keydata, CRYPTO_HDKEY_KEYDATA_SIZE);
+
+    // standard bytewords
+    const char *seed_ur = "ur:crypto-seed/oboe acid good slot axis limp lava brag holy door puff monk brag guru frog luau "
+                          "drop roof grim also trip idle chef fuel twin limp quad even owls";
+    const uint8_t seed[CRYPTO_SEED_SIZE] = {0xc7, 0x09, 0x85, 0x80, 0x12, 0x5e, 0x2a, 0xb0,
+                                            0x98, 0x12, 0x53, 0x46, 0x8b, 0x2d, 0xbc, 0x52};
+    TEST_ASSERT_EQUAL(URC_OK, urc_ur_deserialize(seed_ur, strlen(seed_ur), buffer, BUFLEN, &object));
+    TEST_ASSERT_EQUAL(urc_batch_type_crypto_seed, object.type);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(seed, object.value.seed.seed, CRYPTO_SEED_SIZE);
+    TEST_ASSERT_EQUAL(18394, object.value.seed.creation_date);
+
+    const char *bytes_ur = "ur:bytes/hdeymejtswhhylkepmykhhtsytsnoyoyaxaedsuttydmmhhpktpmsrjtgwdpfnsboxgwlbaawzuefywkdplrsrjy"
+                           "nbvygabwjldapfcsdwkbrkch";
+    TEST_ASSERT_EQUAL(URC_EUNIMPLEMENTEDURTYPE, urc_ur_deserialize(bytes_ur, strlen(bytes_ur), buffer, BUFLEN, &object));
+}
+
+// https://github.com/BlockchainCommons/bc-ur/blob/master/test/test.cpp
+// a 256 bytes message (259 with its cbor header) in 9 fragments of 29 bytes, then the first mixed parts
+static const char *wolf_parts[] = {
+    "ur:bytes/1-9/lpadascfadaxcywenbpljkhdcahkadaemejtswhhylkepmykhhtsytsnoyoyaxaedsuttydmmhhpktpmsrjtdkgslpgh",
+    "ur:bytes/2-9/lpaoascfadaxcywenbpljkhdcagwdpfnsboxgwlbaawzuefywkdplrsrjynbvygabwjldapfcsgmghhkhstlrdcxaefz",
+    "ur:bytes/3-9/lpaxascfadaxcywenbpljkhdcahelbknlkuejnbadmssfhfrdpsbiegecpasvssovlgeykssjykklronvsjksopdzmol",
+    "ur:bytes/4-9/lpaaascfadaxcywenbpljkhdcasotkhemthydawydtaxneurlkosgwcekonertkbrlwmplssjtammdplolsbrdzcrtas",
+    "ur:bytes/5-9/lpahascfadaxcywenbpljkhdcatbbdfmssrkzmcwnezelennjpfzbgmuktrhtejscktelgfpdlrkfyfwdajldejokbwf",
+    "ur:bytes/6-9/lpamascfadaxcywenbpljkhdcackjlhkhybssklbwefectpfnbbectrljectpavyrolkzczcpkmwidmwoxkilghdsowp",
+    "ur:bytes/7-9/lpatascfadaxcywenbpljkhdcavszmwnjkwtclrtvaynhpahrtoxmwvwatmedibkaegdosftvandiodagdhthtrlnnhy",
+    "ur:bytes/8-9/lpayascfadaxcywenbpljkhdcadmsponkkbbhgsoltjntegepmttmoonftnbuoiyrehfrtsabzsttorodklubbuyaetk",
+    "ur:bytes/9-9/lpasascfadaxcywenbpljkhdcajskecpmdckihdyhphfotjojtfmlnwmadspaxrkytbztpbauotbgtgtaeaevtgavtny",
+    "ur:bytes/10-9/lpbkascfadaxcywenbpljkhdcahkadaemejtswhhylkepmykhhtsytsnoyoyaxaedsuttydmmhhpktpmsrjtwdkiplzs",
+    "ur:bytes/11-9/lpbdascfadaxcywenbpljkhdcahelbknlkuejnbadmssfhfrdpsbiegecpasvssovlgeykssjykklronvsjkvetiiapk",
+    "ur:bytes/12-9/lpbnascfadaxcywenbpljkhdcarllaluzmdmgstospeyiefmwejlwtpedamktksrvlcygmzemovovllarodtmtbnptrs",
+};
+#define WOLF_PARTS_COUNT (sizeof(wolf_parts) / sizeof(wolf_parts[0]))
+#define WOLF_MESSAGE_LEN 259
+
+TEST(ur, multipart)
+{
+    // fragments 3 and 7 missing, then the xor of both and fragment 3, which reveals 7 as well
+    const size_t received[] = {0, 1, 3, 4, 5, 7, 8, 11, 10};
+    const size_t received_count = sizeof(received) / sizeof(received[0]);
+    const uint8_t message_begin[] = {0x59, 0x01, 0x00, 0x91, 0x6e, 0xc6, 0x5c, 0xf7};
+
+    urc_ur_decoder decoder;
+    urc_ur_decoder_init(&decoder, 0);
+    urc_text_view type;
+    const uint8_t *message;
+    size_t message_len;
+    for (size_t idx = 0; idx < received_count - 1; idx++) {
+        const char *part = wolf_parts[received[idx]];
+        TEST_ASSERT_EQUAL(URC_OK, urc_ur_decoder_receive(&decoder, part, strlen(part)));
+        TEST_ASSERT_FALSE(urc_ur_decoder_is_complete(&decoder));
+    }
+    TEST_ASSERT_EQUAL(URC_OK, urc_ur_decoder_receive(&decoder, wolf_parts[0], strlen(wolf_parts[0])));
+    TEST_ASSERT_EQUAL(URC_EUNHANDLEDCASE, urc_ur_decoder_result(&decoder, &type, &message, &message_len));
+    TEST_ASSERT_TRUE(urc_ur_decoder_progress(&decoder) > 0.77 && urc_ur_decoder_progress(&decoder) < 0.78);
+
+    // another message
+    const char *other = "ur:crypto-psbt/9-9/lpasascfadaxcywenbpljkhdcajskecpmdckihdyhphfotjojtfmlnwmadspaxrkytbztpbauotbgtgt"
+                        "aeaevtgavtny";
+    TEST_ASSERT_EQUAL(URC_EINVALIDARG, urc_ur_decoder_receive(&decoder, other, strlen(other)));
+
+    const char *last = wolf_parts[received[received_count - 1]];
+    TEST_ASSERT_EQUAL(URC_OK, urc_ur_decoder_receive(&decoder, last, strlen(last)));
+    TEST_ASSERT_TRUE(urc_ur_decoder_is_complete(&decoder));
+    TEST_ASSERT_EQUAL(URC_OK, urc_ur_decoder_result(&decoder, &type, &message, &message_len));
+    TEST_ASSERT_EQUAL(strlen("bytes"), type.len);
+    TEST_ASSERT_EQUAL(0, memcmp("bytes", type.text, type.len));
+    TEST_ASSERT_EQUAL(WOLF_MESSAGE_LEN, message_len);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(message_begin, message, sizeof(message_begin));
+    urc_ur_object object;
+    TEST_ASSERT_EQUAL(URC_EUNIMPLEMENTEDURTYPE, urc_ur_decoder_deserialize(&decoder, &object));
+    urc_ur_decoder_free(&decoder);
+
+    // the message doesn't fit
+    urc_ur_decoder_init(&decoder, WOLF_MESSAGE_LEN - 1);
+    TEST_ASSERT_EQUAL(URC_EBUFFERTOOSMALL, urc_ur_decoder_receive(&decoder, wolf_parts[0], strlen(wolf_parts[0])));
+    urc_ur_decoder_free(&decoder);
+}
+
+// a first part announcing a 64 KiB message in fragments of 1 byte, rejected before anything is allocated for it, then
+// in the shortest fragments accepted: the decoder fits in 14 times the message, where a bitset per mixed part took 21 MB
+TEST(ur, decoder_memory)
+{
+    static uint8_t buffer[14 * 65536];
+    const char *prefixes[] = {"ur:bytes/1-65536/", "ur:bytes/1-13108/"};
+    const char *cbors[] = {"85011a000100001a00010000004100", "85011933341a0001000000450000000000"};
+    const int expected[] = {URC_EUNKNOWNFORMAT, URC_OK};
+    for (size_t idx = 0; idx < 2; idx++) {
+        uint8_t cbor[32];
+        const size_t cbor_len = h2b(cbors[idx], sizeof(cbor), cbor);
+        char part[128];
+        const size_t prefix_len = strlen(prefixes[idx]);
+        memcpy(part, prefixes[idx], prefix_len);
+        const size_t part_len = prefix_len + bytewords_encode_minimal(cbor, cbor_len, &part[prefix_len]);
+
+        urc_arena arena;
+        urc_arena_init(&arena, buffer, sizeof(buffer));
+        urc_allocator allocator = urc_arena_allocator(&arena);
+        const urc_allocator *previous = urc_set_thread_allocator(&allocator);
+        urc_ur_decoder decoder;
+        urc_ur_decoder_init(&decoder, 0);
+        const int result = urc_ur_decoder_receive(&decoder, part, part_len);
+        const size_t used = arena.used;
+        urc_ur_decoder_free(&decoder);
+        urc_set_thread_allocator(previous);
+        TEST_ASSERT_EQUAL(expected[idx], result);
+        if (result != URC_OK) {
+            // the decoded part only
+            TEST_ASSERT_LESS_THAN(64, used);
+        }
+    }
+}
+
+TEST(ur, encoder)
+{
+    urc_ur_decoder decoder;
+    urc_ur_decoder_init(&decoder, 0);
+    for (size_t idx = 0; idx < 9; idx++) {
+        TEST_ASSERT_EQUAL(URC_OK, urc_ur_decoder_receive(&decoder, wolf_parts[idx], strlen(wolf_parts[idx])));
+    }
+    urc_text_view type;
+    const uint8_t *message;
+    size_t message_len;
+    TEST_ASSERT_EQUAL(URC_OK, urc_ur_decoder_result(&decoder, &type, &message, &message_len));
+
+    urc_ur_encoder encoder;
+    const char *part;
+    size_t part_len;
+    TEST_ASSERT_EQUAL(URC_EINVALIDARG, urc_ur_encoder_init(&encoder, "bytes", message, message_len, 9));
+    TEST_ASSERT_EQUAL(URC_EINVALIDARG, urc_ur_encoder_init(&encoder, "By tes", message, message_len, 30));
+    TEST_ASSERT_EQUAL(URC_OK, urc_ur_encoder_init(&encoder, "bytes", message, message_len, 30));
+    TEST_ASSERT_EQUAL(9, urc_ur_encoder_seq_len(&encoder));
+    for (size_t idx = 0; idx < WOLF_PARTS_COUNT; idx++) {
+        TEST_ASSERT_EQUAL(URC_OK, urc_ur_encoder_next_part(&encoder, &part, &part_len));
+        TEST_ASSERT_EQUAL(strlen(wolf_parts[idx]), part_len);
+        TEST_ASSERT_EQUAL_STRING(wolf_parts[idx], part);
+    }
+    urc_ur_encoder_free(&encoder);
+    urc_ur_decoder_free(&decoder);
+
+    // single part: the same UR over and over
+    uint8_t raw[] = {0x70, 0x73, 0x62, 0x74, 0xff, 0x01, 0x00, 0x00};
+    crypto_psbt psbt = {.psbt = raw, .psbt_len = sizeof(raw)};
+    TEST_ASSERT_EQUAL(URC_OK, urc_ur_encoder_init_psbt(&encoder, &psbt, 100));
+    TEST_ASSERT_EQUAL(1, urc_ur_encoder_seq_len(&encoder));
+    for (size_t idx = 0; idx < 2; idx++) {
+        TEST_ASSERT_EQUAL(URC_OK, urc_ur_encoder_next_part(&encoder, &part, &part_len));
+        TEST_ASSERT_EQUAL(0, strncmp("ur:crypto-psbt/", part, strlen("ur:crypto-psbt/")));
+        uint8_t buffer[BUFLEN];
+        urc_ur_object object;
+        TEST_ASSERT_EQUAL(URC_OK, urc_ur_deserialize(part, part_len, buffer, BUFLEN, &object));
+        TEST_ASSERT_EQUAL(urc_batch_type_crypto_psbt, object.type);
+        TEST_ASSERT_EQUAL(sizeof(raw), object.value.psbt.psbt_len);
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(raw, object.value.psbt.psbt, sizeof(raw));
+    }
+    urc_ur_encoder_free(&encoder);
+}
+
+TEST(ur, crc32)
+{
+    const char *check = "123456789";
+    TEST_ASSERT_EQUAL_HEX32(0xcbf43926, urc_crc32_update(0, (const uint8_t *)check, strlen(check)));
+    TEST_ASSERT_EQUAL_HEX32(0xcbf43926, urc_crc32_update(urc_crc32_update(0, (const uint8_t *)check, 4),
+                                                         (const uint8_t *)&check[4], strlen(check) - 4));
+
+    // every kernel the cpu supports, over unaligned starts and the lengths around their block sizes
+    crc32_kernel kernels[] = {crc32_update_slice8, urc_crc32_update, crc32_hardware_kernel()};
+    const size_t kernels_count = kernels[2] ? 3 : 2;
+    uint8_t data[BUFLEN];
+    for (size_t idx = 0; idx < BUFLEN; idx++) {
+        data[idx] = (uint8_t)(idx * 167 + 13);
+    }
+    for (size_t offset = 0; offset < 16; offset++) {
+        for (size_t len = 0; len + offset <= 300; len++) {
+            const uint32_t expected = crc32_update_bytewise((uint32_t)len, &data[offset], len);
+            for (size_t kernel = 0; kernel < kernels_count; kernel++) {
+                TEST_ASSERT_EQUAL_HEX32(expected, kernels[kernel]((uint32_t)len, &data[offset], len));
+            }
+        }
+    }
+    TEST_ASSERT_EQUAL_HEX32(crc32_update_bytewise(0, data, BUFLEN), urc_crc32_update(0, data, BUFLEN));
+}